@@ -4,7 +4,7 @@
 //  Created:
 //    30 Aug 2022, 11:55:49
 //  Last edited:
-//    06 Feb 2024, 11:38:29
+//    14 Oct 2026, 20:08:31
 //  Auto updated?
 //    Yes
 //
@@ -57,7 +57,7 @@ lazy_static!(
 /// # Returns
 /// A string of the form `workflow-XXXXXXXX`, where `XXXXXXXX` are eight random alphanumeric characters.
 #[inline]
-fn generate_random_workflow_id() -> String {
+pub fn generate_random_workflow_id() -> String {
     format!("workflow-{}", rand::thread_rng().sample_iter(Alphanumeric).take(8).map(char::from).collect::<String>())
 }
 
@@ -122,6 +122,29 @@ impl Workflow {
         }
     }
 
+    /// Constructor for the Workflow that generates a random ID, but shares the given table and function bodies instead of taking ownership of them.
+    ///
+    /// This is used by the compiler to emit the table and functions accumulated by previous snippets without copying them.
+    ///
+    /// # Arguments
+    /// - `table`: The (shared) DefTable that contains the definitions in this workflow.
+    /// - `graph`: The main edges that compose this Workflow.
+    /// - `funcs`: The (shared) auxillary edges that provide a kind of function-like paradigm to the edges.
+    ///
+    /// # Returns
+    /// A new Workflow instance with a random ID.
+    #[inline]
+    pub fn with_shared_table(table: Arc<SymTable>, graph: Vec<Edge>, funcs: Arc<HashMap<usize, Vec<Edge>>>) -> Self {
+        Self {
+            id: generate_random_workflow_id(),
+            table,
+            metadata: Arc::new(HashSet::new()),
+            user: Arc::new(None),
+            graph: Arc::new(graph),
+            funcs,
+        }
+    }
+
     // /// Returns the edge pointed to by the given PC.
     // ///
     // /// # Arguments
@@ -4,7 +4,7 @@
 //  Created:
 //    10 Aug 2022, 13:52:37
 //  Last edited:
-//    31 Jan 2024, 11:35:11
+//    14 Oct 2026, 21:33:34
 //  Auto updated?
 //    Yes
 //
@@ -12,6 +12,7 @@
 //!   Defines the errors for the `brane-ast` crate.
 //
 
+use std::borrow::Cow;
 use std::error::Error;
 use std::fmt::{Display, Formatter, Result as FResult};
 use std::io::Write;
@@ -100,7 +101,7 @@ fn prettyprint_list<T: Display, S: AsRef<str>>(list: &[T], word: S) -> String {
 ///
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled stream to write to.
-/// - `source`: The source text (as a string) to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `range`: The TextRange to extract.
 /// - `colour`: The colour to print in.
 ///
@@ -109,39 +110,20 @@ fn prettyprint_list<T: Display, S: AsRef<str>>(list: &[T], word: S) -> String {
 ///
 /// # Panics
 /// This function errors if the range is out-of-bounds for the source text.
-pub(crate) fn ewrite_range(mut writer: impl Write, source: impl AsRef<str>, range: &TextRange, colour: Style) -> Result<(), std::io::Error> {
+pub(crate) fn ewrite_range(mut writer: impl Write, source: &SourceLines, range: &TextRange, colour: Style) -> Result<(), std::io::Error> {
     // Do nothing if the range is none
     if range.is_none() {
         return Ok(());
     }
 
-    // Convert the &str-like into a &str
-    let source: &str = source.as_ref();
-
     // Find the start of the range in the source text
-    let mut line_i: usize = 1;
-    let mut line_start: usize = 0;
-    let mut line: Option<&str> = None;
-    for (i, c) in source.char_indices() {
-        // Search until the end of the line
-        if c == '\n' {
-            if line_i == range.start.line {
-                // It's the correct line; take it
-                line = Some(&source[line_start..i]);
-                break;
-            }
-            line_start = i + 1;
-            line_i += 1;
-        }
-    }
-    if line.is_none() && line_start < source.len() && line_i == range.start.line {
-        line = Some(&source[line_start..]);
-    }
-    let line: &str = line.unwrap_or_else(|| panic!("A position of {}:{} is out-of-bounds for given source text.", range.start, range.end));
+    let line: &str = source
+        .line(range.start.line)
+        .unwrap_or_else(|| panic!("A position of {}:{} is out-of-bounds for given source text.", range.start, range.end));
 
-    // Now print the line up until the correct position
-    let red_start: usize = range.start.col - 1;
-    let red_end: usize = if range.start.line == range.end.line { range.end.col - 1 } else { line.len() };
+    // Now print the line up until the correct position (a range may end on the line ending we stripped)
+    let red_start: usize = (range.start.col - 1).min(line.len());
+    let red_end: usize = if range.start.line == range.end.line { (range.end.col - 1).clamp(red_start, line.len()) } else { line.len() };
     write!(
         &mut writer,
         "{} {}",
@@ -187,7 +169,7 @@ pub(crate) fn ewrite_range(mut writer: impl Write, source: impl AsRef<str>, rang
 ///
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled stream to write to.
-/// - `source`: The source text to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `err`: The Error to print.
 /// - `range`: The range of the error.
 ///
@@ -196,7 +178,7 @@ pub(crate) fn ewrite_range(mut writer: impl Write, source: impl AsRef<str>, rang
 fn prettywrite_err(
     mut writer: impl Write,
     file: impl AsRef<str>,
-    source: impl AsRef<str>,
+    source: &SourceLines,
     err: &dyn Error,
     range: &TextRange,
 ) -> Result<(), std::io::Error> {
@@ -222,7 +204,7 @@ fn prettywrite_err(
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled stream to write to.
 /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
-/// - `source`: The source text to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `err`: The Error to print.
 /// - `range`: The range that indicates the actual reference.
 /// - `defined`: The range that indicates the location of the defition.
@@ -232,7 +214,7 @@ fn prettywrite_err(
 fn prettywrite_err_defined(
     mut writer: impl Write,
     file: impl AsRef<str>,
-    source: impl AsRef<str>,
+    source: &SourceLines,
     err: &dyn Error,
     range: &TextRange,
     defined: &TextRange,
@@ -247,7 +229,7 @@ fn prettywrite_err_defined(
     )?;
 
     // Print the normal range
-    ewrite_range(&mut writer, &source, range, Style::new().red().bold())?;
+    ewrite_range(&mut writer, source, range, Style::new().red().bold())?;
 
     // Print the expected range
     writeln!(&mut writer, "{}: Defined here:", style("note").cyan().bold())?;
@@ -263,7 +245,7 @@ fn prettywrite_err_defined(
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled stream to write to.
 /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
-/// - `source`: The source text to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `err`: The Error to print.
 /// - `expected`: The range that indicates the expected value or type.
 /// - `got`: The range that indicates the got value or type.
@@ -273,7 +255,7 @@ fn prettywrite_err_defined(
 fn prettywrite_err_exp_got(
     mut writer: impl Write,
     file: impl AsRef<str>,
-    source: impl AsRef<str>,
+    source: &SourceLines,
     err: &dyn Error,
     expected: &TextRange,
     got: &TextRange,
@@ -288,7 +270,7 @@ fn prettywrite_err_exp_got(
     )?;
 
     // Print the normal range
-    ewrite_range(&mut writer, &source, got, Style::new().red().bold())?;
+    ewrite_range(&mut writer, source, got, Style::new().red().bold())?;
 
     // Print the expected range
     writeln!(&mut writer, "{}: Expected because of:", style("note").cyan().bold())?;
@@ -304,7 +286,7 @@ fn prettywrite_err_exp_got(
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled stream to write to.
 /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
-/// - `source`: The source text to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `err`: The Error to print.
 /// - `existing`: The range that indicates the existing value or type.
 /// - `new`: The range that indicates the new value or type.
@@ -314,7 +296,7 @@ fn prettywrite_err_exp_got(
 fn prettywrite_err_exist_new(
     mut writer: impl Write,
     file: impl AsRef<str>,
-    source: impl AsRef<str>,
+    source: &SourceLines,
     err: &dyn Error,
     existing: &TextRange,
     new: &TextRange,
@@ -329,7 +311,7 @@ fn prettywrite_err_exist_new(
     )?;
 
     // Print the normal range
-    ewrite_range(&mut writer, &source, new, Style::new().red().bold())?;
+    ewrite_range(&mut writer, source, new, Style::new().red().bold())?;
 
     // Print the expected range
     writeln!(&mut writer, "{}: Previous occurrence:", style("note").cyan().bold())?;
@@ -345,7 +327,7 @@ fn prettywrite_err_exist_new(
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled stream to write to.
 /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
-/// - `source`: The source text to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `err`: The Error to print.
 /// - `range`: The range that indicates the error itself.
 /// - `reasons`: Zero or more ranges that indicates the sources.
@@ -355,7 +337,7 @@ fn prettywrite_err_exist_new(
 fn prettywrite_err_reasons(
     mut writer: impl Write,
     file: impl AsRef<str>,
-    source: impl AsRef<str>,
+    source: &SourceLines,
     err: &dyn Error,
     range: &TextRange,
     reasons: &[TextRange],
@@ -370,12 +352,12 @@ fn prettywrite_err_reasons(
     )?;
 
     // Print the normal range
-    ewrite_range(&mut writer, &source, range, Style::new().red().bold())?;
+    ewrite_range(&mut writer, source, range, Style::new().red().bold())?;
 
     // Print the expected ranges
     for r in reasons {
         writeln!(&mut writer, "{}: Error occurred because of:", style("note").cyan().bold())?;
-        ewrite_range(&mut writer, &source, r, Style::new().cyan().bold())?;
+        ewrite_range(&mut writer, source, r, Style::new().cyan().bold())?;
         writeln!(&mut writer)?;
     }
 
@@ -387,6 +369,66 @@ fn prettywrite_err_reasons(
 
 
 
+/***** AUXILLARY *****/
+/// Source text together with where each of its lines starts, such that many warnings and errors can be rendered against it without searching it for their lines every time.
+#[derive(Clone, Debug)]
+pub struct SourceLines<'s> {
+    /// The source text itself.
+    source: &'s str,
+    /// The byte offset in `source` at which every line starts.
+    starts: Cow<'s, [usize]>,
+}
+
+impl<'s> SourceLines<'s> {
+    /// Constructor for the SourceLines that indexes the given source text.
+    ///
+    /// # Arguments
+    /// - `source`: The source text to index.
+    ///
+    /// # Returns
+    /// A new SourceLines instance.
+    #[inline]
+    pub fn new(source: &'s str) -> Self { Self { source, starts: Cow::Owned(Self::index(source)) } }
+
+    /// Constructor for the SourceLines that re-uses an index computed earlier by [`Self::index()`].
+    ///
+    /// # Arguments
+    /// - `source`: The source text that was indexed.
+    /// - `starts`: The index of `source`, as returned by [`Self::index()`].
+    ///
+    /// # Returns
+    /// A new SourceLines instance.
+    #[inline]
+    pub fn with_index(source: &'s str, starts: &'s [usize]) -> Self { Self { source, starts: Cow::Borrowed(starts) } }
+
+    /// Computes the byte offsets at which the lines of the given source text start.
+    ///
+    /// # Arguments
+    /// - `source`: The source text to index.
+    ///
+    /// # Returns
+    /// The offset of every line, in order. The first line always starts at `0`.
+    pub fn index(source: &str) -> Vec<usize> { std::iter::once(0).chain(source.match_indices('\n').map(|(i, _)| i + 1)).collect() }
+
+    /// Returns the given line of the source text.
+    ///
+    /// # Arguments
+    /// - `line`: The one-indexed number of the line to return.
+    ///
+    /// # Returns
+    /// The line without its line ending (either `\n` or `\r\n`), or [`None`] if the source text has no such line.
+    pub fn line(&self, line: usize) -> Option<&'s str> {
+        let start: usize = *self.starts.get(line.checked_sub(1)?)?;
+        let end: usize = self.starts.get(line).map(|next| next - 1).unwrap_or(self.source.len());
+        let line: &'s str = &self.source[start..end];
+        Some(line.strip_suffix('\r').unwrap_or(line))
+    }
+}
+
+
+
+
+
 /***** ERRORS *****/
 /// Defines toplevel errors that occur in this crate.
 #[derive(Debug)]
@@ -435,7 +477,20 @@ impl AstError {
     /// # Errors
     /// This function may error if we failed to write to the given writer.
     #[inline]
-    pub fn prettywrite(&self, mut writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+    pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, mut writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use AstError::*;
         match self {
             ReaderReadError { .. } => {
@@ -448,13 +503,33 @@ impl AstError {
                 writeln!(writer, "{self}")
             },
 
-            SanityError(err) => err.prettywrite(writer, file, source),
-            ResolveError(err) => err.prettywrite(writer, file, source),
-            TypeError(err) => err.prettywrite(writer, file, source),
-            NullError(err) => err.prettywrite(writer, file, source),
-            LocationError(err) => err.prettywrite(writer, file, source),
-            PruneError(err) => err.prettywrite(writer, file, source),
-            FlattenError(err) => err.prettywrite(writer, file, source),
+            SanityError(err) => err.prettywrite_lines(writer, file, source),
+            ResolveError(err) => err.prettywrite_lines(writer, file, source),
+            TypeError(err) => err.prettywrite_lines(writer, file, source),
+            NullError(err) => err.prettywrite_lines(writer, file, source),
+            LocationError(err) => err.prettywrite_lines(writer, file, source),
+            PruneError(err) => err.prettywrite_lines(writer, file, source),
+            FlattenError(err) => err.prettywrite_lines(writer, file, source),
+        }
+    }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use AstError::*;
+        match self {
+            ReaderReadError { .. } => None,
+            ParseError { .. } => None,
+            WriteError { .. } => None,
+            SanityError(err) => err.range(),
+            ResolveError(err) => err.range(),
+            TypeError(err) => err.range(),
+            NullError(err) => err.range(),
+            LocationError(err) => err.range(),
+            PruneError(err) => err.range(),
+            FlattenError(err) => err.range(),
         }
     }
 }
@@ -539,11 +614,35 @@ impl SanityError {
     /// This function may error if we failed to write to the given writer.
     #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use SanityError::*;
         match self {
             ProjError { range, .. } => prettywrite_err(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use SanityError::*;
+        match self {
+            ProjError { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for SanityError {
@@ -630,7 +729,21 @@ impl ResolveError {
     ///
     /// # Errors
     /// This function may error if we failed to write to the given writer.
+    #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use ResolveError::*;
         match self {
             VersionParseError { range, .. } => prettywrite_err(writer, file, source, self, range),
@@ -664,6 +777,36 @@ impl ResolveError {
             UndefinedVariable { range, .. } => prettywrite_err(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use ResolveError::*;
+        match self {
+            VersionParseError { range, .. } => Some(range),
+            UnknownPackageError { range, .. } => Some(range),
+            FunctionImportError { range, .. } => Some(range),
+            ClassImportError { range, .. } => Some(range),
+            FunctionDefineError { range, .. } => Some(range),
+            ParameterDefineError { range, .. } => Some(range),
+            ClassDefineError { range, .. } => Some(range),
+            UndefinedClass { range, .. } => Some(range),
+            DuplicateMethodAndProperty { new_range, .. } => Some(new_range),
+            IllegalSelf { range, .. } => Some(range),
+            MissingSelf { range, .. } => Some(range),
+            UnknownMergeStrategy { range, .. } => Some(range),
+            VariableDefineError { range, .. } => Some(range),
+            UndefinedFunction { range, .. } => Some(range),
+            CommitResultIncorrectExpr { range, .. } => Some(range),
+            NonClassProjection { range, .. } => Some(range),
+            UnknownField { range, .. } => Some(range),
+            DataIncorrectExpr { range, .. } => Some(range),
+            UnknownDataError { range, .. } => Some(range),
+            UndefinedVariable { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for ResolveError {
@@ -782,7 +925,21 @@ impl TypeError {
     ///
     /// # Errors
     /// This function may error if we failed to write to the given writer.
+    #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use TypeError::*;
         match self {
             ProjOnNonClassError { range, .. } => prettywrite_err(writer, file, source, self, range),
@@ -815,6 +972,34 @@ impl TypeError {
             DataNoNamePropertyError { range, .. } => prettywrite_err(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use TypeError::*;
+        match self {
+            ProjOnNonClassError { range, .. } => Some(range),
+            UnexpectedMethod { range, .. } => Some(range),
+            UnknownField { range, .. } => Some(range),
+            IncorrectType { range, .. } => Some(range),
+            IllegalDataReturnError { range, .. } => Some(range),
+            IncompatibleReturns { got_range, .. } => Some(got_range),
+            ParallelNoReturn { range, .. } => Some(range),
+            ParallelUnexpectedReturn { range, .. } => Some(range),
+            ParallelIncompleteReturn { range, .. } => Some(range),
+            ParallelIllegalType { range, .. } => Some(range),
+            ParallelNoStrategy { range, .. } => Some(range),
+            NonFunctionCall { range, .. } => Some(range),
+            UndefinedFunctionCall { range, .. } => Some(range),
+            FunctionArityError { got_range, .. } => Some(got_range),
+            InconsistentArrayError { got_range, .. } => Some(got_range),
+            NonArrayIndexError { range, .. } => Some(range),
+            DataNameNotAStringError { range, .. } => Some(range),
+            DataNoNamePropertyError { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for TypeError {
@@ -903,12 +1088,37 @@ impl NullError {
     ///
     /// # Errors
     /// This function may error if we failed to write to the given writer.
+    #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use NullError::*;
         match self {
             IllegalNull { range } => prettywrite_err(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use NullError::*;
+        match self {
+            IllegalNull { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for NullError {
@@ -954,7 +1164,21 @@ impl LocationError {
     ///
     /// # Errors
     /// This function may error if we failed to write to the given writer.
+    #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use LocationError::*;
         match self {
             IllegalLocation { range, .. } => prettywrite_err(writer, file, source, self, range),
@@ -963,6 +1187,19 @@ impl LocationError {
             NoLocation { range, reasons, .. } => prettywrite_err_reasons(writer, file, source, self, range, reasons),
         }
     }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use LocationError::*;
+        match self {
+            IllegalLocation { range, .. } => Some(range),
+            OnNoLocation { range, .. } => Some(range),
+            NoLocation { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for LocationError {
@@ -1007,12 +1244,37 @@ impl PruneError {
     ///
     /// # Errors
     /// This function may error if we failed to write to the given writer.
+    #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use PruneError::*;
         match self {
             MissingReturn { range, .. } => prettywrite_err(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use PruneError::*;
+        match self {
+            MissingReturn { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for PruneError {
@@ -1054,12 +1316,37 @@ impl FlattenError {
     ///
     /// # Errors
     /// This function may error if we failed to write to the given writer.
+    #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the error in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use FlattenError::*;
         match self {
             IntermediateResultConflict { .. } => prettywrite_err(writer, file, source, self, &TextRange::none()),
         }
     }
+
+    /// Returns the range in the source text that this error is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this error is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use FlattenError::*;
+        match self {
+            IntermediateResultConflict { .. } => None,
+        }
+    }
 }
 
 impl Display for FlattenError {
@@ -4,7 +4,7 @@
 //  Created:
 //    16 Sep 2022, 08:22:47
 //  Last edited:
-//    13 Dec 2023, 08:20:26
+//    14 Oct 2026, 21:01:13
 //  Auto updated?
 //    Yes
 //
@@ -16,6 +16,7 @@
 use std::cell::{RefCell, RefMut};
 use std::collections::{HashMap, HashSet};
 use std::rc::Rc;
+use std::sync::Arc;
 
 use brane_dsl::ast::Data;
 use brane_dsl::data_type::{ClassSignature, FunctionSignature};
@@ -658,6 +659,21 @@ impl Default for DataState {
 
 
 
+/// Defines the parts of previous snippets that have already been linked into a Workflow.
+///
+/// Because the TableState only ever grows, keeping this around means that every new snippet only has to convert and link the entries it adds itself.
+///
+/// Note that the emitted Workflow shares the table and function bodies with this state. If it (or a clone of it) is still alive when the next snippet is linked, the next snippet has to copy them first, which is as expensive as converting everything from scratch. Only when the previous workflow has been dropped are the parts of previous snippets re-used as-is.
+#[derive(Clone, Debug, Default)]
+pub struct LinkState {
+    /// The workflow table as emitted for the previous snippet.
+    pub table: Arc<SymTable>,
+    /// The function bodies as emitted for the previous snippet, mapped by function index.
+    pub funcs: Arc<HashMap<usize, Vec<Edge>>>,
+}
+
+
+
 /// Defines whatever we need to remember w.r.t. compile-time in between two submissions of part of a workflow (i.e., repl-runs).
 #[derive(Clone, Debug)]
 pub struct CompileState {
@@ -671,6 +687,9 @@ pub struct CompileState {
 
     /// Contains functions and variables and the possible datasets they may evaluate to.
     pub data: DataState,
+
+    /// Contains the table and function bodies already linked for previous snippets.
+    pub linked: LinkState,
 }
 
 impl CompileState {
@@ -687,6 +706,8 @@ impl CompileState {
             bodies: HashMap::new(),
 
             data: DataState::new(),
+
+            linked: LinkState::default(),
         }
     }
 }
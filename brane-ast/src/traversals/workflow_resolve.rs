@@ -4,7 +4,7 @@
 //  Created:
 //    05 Sep 2022, 17:36:21
 //  Last edited:
-//    06 Feb 2024, 11:36:49
+//    14 Oct 2026, 21:37:20
 //  Auto updated?
 //    Yes
 //
@@ -15,10 +15,11 @@
 
 use std::cell::Ref;
 use std::collections::HashMap;
+use std::sync::Arc;
 
 use log::debug;
 
-use crate::ast::{Edge, SymTable, Workflow};
+use crate::ast::{ClassDef, Edge, FunctionDef, SymTable, TaskDef, VarDef, Workflow};
 use crate::ast_unresolved::UnresolvedWorkflow;
 use crate::edgebuffer::{EdgeBuffer, EdgeBufferNode, EdgeBufferNodeLink, EdgeBufferNodePtr};
 use crate::errors::AstError;
@@ -35,7 +36,7 @@ mod tests {
 
     use super::super::print::ast;
     use super::*;
-    use crate::{compile_program_to, CompileResult, CompileStage};
+    use crate::{compile_program_to, compile_snippet, CompileResult, CompileStage};
 
 
     /// Tests the traversal by generating symbol tables for every file.
@@ -83,6 +84,88 @@ mod tests {
             println!("{}\n\n", (0..80).map(|_| '-').collect::<String>());
         });
     }
+
+
+
+    /// Compiles the given snippet on top of the given state.
+    ///
+    /// # Returns
+    /// The compiled Workflow, or [`None`] if the snippet did not compile.
+    fn compile(state: &mut CompileState, pindex: &PackageIndex, dindex: &DataIndex, code: &str) -> Option<Workflow> {
+        match compile_snippet(state, code.as_bytes(), pindex, dindex, &ParserOptions::bscript()) {
+            CompileResult::Workflow(wf, _) => Some(wf),
+            CompileResult::Eof(_) | CompileResult::Err(_) => None,
+            _ => unreachable!(),
+        }
+    }
+
+    /// Asserts that the table and function bodies linked into the given workflow are the same as converting the whole state from scratch.
+    fn assert_linked(state: &CompileState, workflow: &Workflow) {
+        // The definitions do not implement PartialEq, so compare them by their debug representation
+        let table: SymTable = SymTable::from(&state.table);
+        assert_eq!(format!("{:?}", workflow.table.funcs), format!("{:?}", table.funcs));
+        assert_eq!(format!("{:?}", workflow.table.tasks), format!("{:?}", table.tasks));
+        assert_eq!(format!("{:?}", workflow.table.classes), format!("{:?}", table.classes));
+        assert_eq!(format!("{:?}", workflow.table.vars), format!("{:?}", table.vars));
+        assert_eq!(workflow.table.results, table.results);
+
+        // Every function with a compiled body is linked, under its index in the table
+        let funcs: HashMap<usize, &Vec<Edge>> =
+            table.funcs.iter().enumerate().filter_map(|(i, def)| state.bodies.get(&def.name).map(|body| (i, body))).collect();
+        assert_eq!(workflow.funcs.len(), funcs.len());
+        for (i, body) in funcs {
+            assert_eq!(format!("{:?}", workflow.funcs.get(&i)), format!("{:?}", Some(body)));
+        }
+
+        // What was emitted is also what the next snippet builds on
+        assert!(Arc::ptr_eq(&workflow.table, &state.linked.table));
+        assert!(Arc::ptr_eq(&workflow.funcs, &state.linked.funcs));
+    }
+
+    /// Tests that linking snippets one-by-one gives the same workflow as linking everything at once.
+    #[test]
+    fn test_workflow_resolve_incremental() {
+        let pindex: PackageIndex = create_package_index();
+        let dindex: DataIndex = create_data_index();
+        let mut state: CompileState = CompileState::new();
+
+        // Functions and variables
+        let first: Workflow = compile(&mut state, &pindex, &dindex, "func add(a, b) {\n    return a + b;\n}\nlet x := add(1, 2);").unwrap();
+        assert_linked(&state, &first);
+
+        // Classes, while the previous workflow is still alive (so its table and bodies must be copied, not changed)
+        let (n_funcs, n_vars): (usize, usize) = (first.table.funcs.len(), first.table.vars.len());
+        let second: Workflow = compile(
+            &mut state,
+            &pindex,
+            &dindex,
+            "class Point {\n    x: int;\n    y: int;\n    func sum(self) { return self.x + self.y; }\n}\nlet p := new Point { x := 1, y := 2 };",
+        )
+        .unwrap();
+        assert_linked(&state, &second);
+        assert_eq!((first.table.funcs.len(), first.table.vars.len()), (n_funcs, n_vars));
+        drop(first);
+        drop(second);
+
+        // A snippet that fails leaves what was linked as it was
+        let (table, funcs): (Arc<SymTable>, Arc<HashMap<usize, Vec<Edge>>>) = (state.linked.table.clone(), state.linked.funcs.clone());
+        assert!(compile(&mut state, &pindex, &dindex, "func broken() {\n    return 1;\n}\nlet bad := undefined_variable;").is_none());
+        assert!(Arc::ptr_eq(&table, &state.linked.table));
+        assert!(Arc::ptr_eq(&funcs, &state.linked.funcs));
+        drop(table);
+        drop(funcs);
+
+        // Changed results are picked up, and functions may call ones from previous snippets
+        state.table.results.insert("result_p".into(), "p".into());
+        let third: Workflow = compile(&mut state, &pindex, &dindex, "func twice(a) {\n    return add(a, a);\n}\nlet y := twice(p.sum());").unwrap();
+        assert_linked(&state, &third);
+        assert_eq!(third.table.results.get("result_p").map(String::as_str), Some("p"));
+        drop(third);
+
+        // And snippets that only add variables
+        let fourth: Workflow = compile(&mut state, &pindex, &dindex, "let z := x + y;").unwrap();
+        assert_linked(&state, &fourth);
+    }
 }
 
 
@@ -525,7 +608,7 @@ fn pass_edges(edges: EdgeBuffer, target: &mut Vec<Edge>, map: &mut HashMap<EdgeB
 /// Note that the unresolved workflow already has to be compiled, obviously.
 ///
 /// # Arguments
-/// - `state`: The CompileState that contains function bodies of previously defined functions (definitions are already implicitly transferred from the symbol table).
+/// - `state`: The CompileState that contains function bodies of previously defined functions (definitions are already implicitly transferred from the symbol table). Its [`LinkState`](crate::state::LinkState) is extended with this snippet's additions.
 /// - `root`: The root node of the tree on which this compiler pass will be done.
 ///
 /// # Returns
@@ -537,16 +620,26 @@ fn pass_edges(edges: EdgeBuffer, target: &mut Vec<Edge>, map: &mut HashMap<EdgeB
 /// # Panics
 /// This function may panic if any of the previous passes did not do its job, and the given UnresolvedWorkflow is ill-formed.
 pub fn do_traversal(state: &mut CompileState, mut root: UnresolvedWorkflow) -> Result<Workflow, Vec<AstError>> {
-    // Convert the CompileState into a symbol table
-    let table: SymTable = (&state.table).into();
+    // Convert only the part of the CompileState that is new since the previous snippet into the symbol table
+    // NOTE: This copies the whole table first if the previously emitted workflow still refers to it
+    let table: &mut SymTable = Arc::make_mut(&mut state.linked.table);
+    let (n_funcs, n_tasks, n_classes, n_vars): (usize, usize, usize, usize) =
+        (table.funcs.len(), table.tasks.len(), table.classes.len(), table.vars.len());
+    table.funcs.extend(state.table.funcs[n_funcs..].iter().cloned().map(FunctionDef::from));
+    table.tasks.extend(state.table.tasks[n_tasks..].iter().cloned().map(TaskDef::from));
+    table.classes.extend(state.table.classes[n_classes..].iter().cloned().map(ClassDef::from));
+    table.vars.extend(state.table.vars[n_vars..].iter().cloned().map(VarDef::from));
+    if table.results != state.table.results {
+        table.results = state.table.results.clone();
+    }
 
     // First we'll want to write the main edges
     let mut graph: Vec<Edge> = vec![];
     pass_edges(root.main_edges, &mut graph, &mut HashMap::new(), 0);
 
-    // Then, inject the bodies for all of the functions
-    let mut funcs: HashMap<usize, Vec<Edge>> = HashMap::new();
-    for (i, def) in table.funcs.iter().enumerate() {
+    // Then, inject the bodies for all of the new functions (the ones of previous snippets are already linked, but copied if still shared)
+    let funcs: &mut HashMap<usize, Vec<Edge>> = Arc::make_mut(&mut state.linked.funcs);
+    for (i, def) in table.funcs.iter().enumerate().skip(n_funcs) {
         // Find the definition in the f_edges or in the state (it should be mutually exclusive)
         if let Some(body) = state.bodies.get(&def.name) {
             debug!("Linking function '{}' from previous snippet", def.name);
@@ -569,7 +662,7 @@ pub fn do_traversal(state: &mut CompileState, mut root: UnresolvedWorkflow) -> R
 
     // Done; create the workflow and return it
     // Note: don't forget to transfer metadata before doing so
-    let mut wf: Workflow = Workflow::with_random_id(table, graph, funcs);
+    let mut wf: Workflow = Workflow::with_shared_table(state.linked.table.clone(), graph, state.linked.funcs.clone());
     wf.metadata = root.metadata;
     Ok(wf)
 }
@@ -4,7 +4,7 @@
 //  Created:
 //    05 Sep 2022, 16:08:42
 //  Last edited:
-//    12 Dec 2023, 14:56:22
+//    14 Oct 2026, 21:33:34
 //  Auto updated?
 //    Yes
 //
@@ -19,7 +19,7 @@ use brane_dsl::spec::MergeStrategy;
 use brane_dsl::TextRange;
 use console::{style, Style};
 
-use crate::errors::{ewrite_range, n};
+use crate::errors::{ewrite_range, n, SourceLines};
 use crate::spec::BuiltinClasses;
 
 
@@ -29,7 +29,7 @@ use crate::spec::BuiltinClasses;
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled object to write the serialized warning to.
 /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
-/// - `source`: The source text to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `warn`: The Warning to print.
 /// - `range`: The range of the warning.
 ///
@@ -38,7 +38,7 @@ use crate::spec::BuiltinClasses;
 pub(crate) fn prettywrite_warn(
     mut writer: impl Write,
     file: impl AsRef<str>,
-    source: impl AsRef<str>,
+    source: &SourceLines,
     warn: &dyn Display,
     range: &TextRange,
 ) -> Result<(), std::io::Error> {
@@ -64,7 +64,7 @@ pub(crate) fn prettywrite_warn(
 /// # Arguments
 /// - `writer`: The [`Write`]-enabled stream to write to.
 /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
-/// - `source`: The source text to extract the line from.
+/// - `source`: The indexed source text to extract the line from.
 /// - `warn`: The Warning to print.
 /// - `existing`: The range that indicates the existing value or type.
 /// - `new`: The range that indicates the new value or type.
@@ -74,7 +74,7 @@ pub(crate) fn prettywrite_warn(
 fn prettywrite_warn_exist_new(
     mut writer: impl Write,
     file: impl AsRef<str>,
-    source: impl AsRef<str>,
+    source: &SourceLines,
     err: &dyn Warning,
     existing: &TextRange,
     new: &TextRange,
@@ -89,7 +89,7 @@ fn prettywrite_warn_exist_new(
     )?;
 
     // Print the normal range
-    ewrite_range(&mut writer, &source, new, Style::new().yellow().bold())?;
+    ewrite_range(&mut writer, source, new, Style::new().yellow().bold())?;
 
     // Print the expected range
     writeln!(&mut writer, "{}: Previous occurrence:", style("note").cyan().bold())?;
@@ -146,12 +146,39 @@ impl AstWarning {
     /// This function may error if we failed to write to the given writer.
     #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the warning in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
+        use AstWarning::*;
+        match self {
+            AttributesWarning(warn) => warn.prettywrite_lines(writer, file, source),
+            TypeWarning(warn) => warn.prettywrite_lines(writer, file, source),
+            MetadataWarning(warn) => warn.prettywrite_lines(writer, file, source),
+            CompileWarning(warn) => warn.prettywrite_lines(writer, file, source),
+        }
+    }
+
+    /// Returns the range in the source text that this warning is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this warning is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
         use AstWarning::*;
         match self {
-            AttributesWarning(warn) => warn.prettywrite(writer, file, source),
-            TypeWarning(warn) => warn.prettywrite(writer, file, source),
-            MetadataWarning(warn) => warn.prettywrite(writer, file, source),
-            CompileWarning(warn) => warn.prettywrite(writer, file, source),
+            AttributesWarning(warn) => warn.range(),
+            TypeWarning(warn) => warn.range(),
+            MetadataWarning(warn) => warn.range(),
+            CompileWarning(warn) => warn.range(),
         }
     }
 }
@@ -222,11 +249,35 @@ impl AttributesWarning {
     /// This function may error if we failed to write to the given writer.
     #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the warning in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use AttributesWarning::*;
         match self {
             UnmatchedAttribute { range } => prettywrite_warn(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this warning is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this warning is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use AttributesWarning::*;
+        match self {
+            UnmatchedAttribute { range, .. } => Some(range),
+        }
+    }
 }
 impl Display for AttributesWarning {
     fn fmt(&self, f: &mut Formatter<'_>) -> FResult {
@@ -273,6 +324,19 @@ impl TypeWarning {
     /// This function may error if we failed to write to the given writer.
     #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the warning in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use TypeWarning::*;
         match self {
             UnusedMergeStrategy { range, .. } => prettywrite_warn(writer, file, source, self, range),
@@ -280,6 +344,18 @@ impl TypeWarning {
             ReturningIntermediateResult { range, .. } => prettywrite_warn(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this warning is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this warning is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use TypeWarning::*;
+        match self {
+            UnusedMergeStrategy { range, .. } => Some(range),
+            ReturningIntermediateResult { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for TypeWarning {
@@ -339,6 +415,19 @@ impl MetadataWarning {
     /// This function may error if we failed to write to the given writer.
     #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the warning in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use MetadataWarning::*;
         match self {
             DuplicateTag { prev, range } => prettywrite_warn_exist_new(writer, file, source, self, prev, range),
@@ -347,6 +436,20 @@ impl MetadataWarning {
             UselessTag { range } => prettywrite_warn(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this warning is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this warning is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use MetadataWarning::*;
+        match self {
+            DuplicateTag { range, .. } => Some(range),
+            NonStringTag { range, .. } => Some(range),
+            TagWithoutDot { range, .. } => Some(range),
+            UselessTag { range, .. } => Some(range),
+        }
+    }
 }
 impl Display for MetadataWarning {
     fn fmt(&self, f: &mut Formatter<'_>) -> FResult {
@@ -393,11 +496,35 @@ impl CompileWarning {
     /// This function may error if we failed to write to the given writer.
     #[inline]
     pub fn prettywrite(&self, writer: impl Write, file: impl AsRef<str>, source: impl AsRef<str>) -> Result<(), std::io::Error> {
+        self.prettywrite_lines(writer, file, &SourceLines::new(source.as_ref()))
+    }
+
+    /// Prints the warning in a pretty way to the given [`Write`]r, like [`Self::prettywrite()`], but reads from source text that has already been indexed.
+    ///
+    /// # Arguments:
+    /// - `writer`: The [`Write`]-enabled object to write to.
+    /// - `file`: The 'path' of the file (or some other identifier) where the source text originates from.
+    /// - `source`: The indexed source text to read the debug range from.
+    ///
+    /// # Errors
+    /// This function may error if we failed to write to the given writer.
+    pub fn prettywrite_lines(&self, writer: impl Write, file: impl AsRef<str>, source: &SourceLines) -> Result<(), std::io::Error> {
         use CompileWarning::*;
         match self {
             OnDeprecated { range, .. } => prettywrite_warn(writer, file, source, self, range),
         }
     }
+
+    /// Returns the range in the source text that this warning is about, which is the position also shown by [`Self::prettywrite()`].
+    ///
+    /// # Returns
+    /// A reference to the [`TextRange`], or [`None`] if this warning is not about a specific piece of source text.
+    pub fn range(&self) -> Option<&TextRange> {
+        use CompileWarning::*;
+        match self {
+            OnDeprecated { range, .. } => Some(range),
+        }
+    }
 }
 
 impl Display for CompileWarning {
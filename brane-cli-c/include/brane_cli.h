@@ -4,7 +4,7 @@
  * Created:
  *   14 Jun 2023, 11:49:07
  * Last edited:
- *   04 Mar 2024, 13:35:30
+ *   14 Oct 2026, 21:33:34
  * Auto updated?
  *   Yes
  *
@@ -15,16 +15,22 @@
 #ifndef BRANE_CLI_H
 #define BRANE_CLI_H
 
+#include <stddef.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <dlfcn.h>
 
 
 /***** MACROS *****/
-/* Defines a shortcut for loading a symbol from a handle with `dlsym()`. */
+/* Defines a shortcut for loading a symbol from a handle with `dlsym()`. Jumps to `failed` if the symbol could not be found. */
 #define LOAD_SYMBOL(TARGET, PROTOTYPE) \
     (state->TARGET) = (PROTOTYPE) dlsym(state->handle, (#TARGET)); \
-    if ((state->TARGET) == NULL) { fprintf(stderr, "Failed to load symbol '%s': %s\n", (#TARGET), dlerror()); return NULL; }
+    if ((state->TARGET) == NULL) { fprintf(stderr, "Failed to load symbol '%s': %s\n", (#TARGET), dlerror()); goto failed; }
+/* Defines a shortcut for loading a symbol that older libraries may not have with `dlsym()`. Leaves it NULL if the symbol could not be found. */
+#define LOAD_OPTIONAL_SYMBOL(TARGET, PROTOTYPE) \
+    (state->TARGET) = (PROTOTYPE) dlsym(state->handle, (#TARGET));
 
 
 
@@ -41,6 +47,28 @@ typedef struct _error Error;
  * WARNING: Do not access any internals yourself, since there are no guarantees on the internal layout of this struct.
  */
 typedef struct _source_error SourceError;
+/* Defines a single warning or error of a [`SourceError`] (see `serror_get()`).
+ * 
+ * All strings are owned by the [`SourceError`], and are only valid for as long as it is.
+ */
+typedef struct _diagnostic {
+    /* Whether this is an error (true) or a warning (false). */
+    bool is_error;
+    /* The (null-terminated) description of what was compiled, i.e., the `what` given to the compiler. */
+    const char* file;
+    /* The (one-indexed) line where the diagnostic starts, or `0` if it is not about a specific piece of source text. */
+    size_t line;
+    /* The (one-indexed) column where the diagnostic starts, or `0` if it is not about a specific piece of source text. */
+    size_t column;
+    /* The (one-indexed) line where the diagnostic ends, or `0` if it is not about a specific piece of source text. */
+    size_t end_line;
+    /* The (one-indexed) column where the diagnostic ends, or `0` if it is not about a specific piece of source text. */
+    size_t end_column;
+    /* The (null-terminated) message of the diagnostic, without any styling. */
+    const char* message;
+    /* The (null-terminated) source text of the line where the diagnostic starts, without its line ending. Empty if it is not about a specific piece of source text. */
+    const char* source_line;
+} Diagnostic;
 
 /* Defines an index of available packages.
  * 
@@ -76,17 +104,172 @@ typedef struct _compiler Compiler;
  * WARNING: Do not access any internals yourself, since there are no guarantees on the internal layout of this struct.
  */
 typedef struct _full_value FullValue;
-/* Defines a BRANE instance virtual machine.
+/* Defines the kinds of values a `FullValue` can be (see `fvalue_kind()`).
+ */
+typedef enum _full_value_kind {
+    /* The value is void. */
+    FULL_VALUE_VOID = 0,
+    /* The value is a boolean (see `fvalue_get_bool()`). */
+    FULL_VALUE_BOOLEAN = 1,
+    /* The value is an integer (see `fvalue_get_int()`). */
+    FULL_VALUE_INTEGER = 2,
+    /* The value is a real (see `fvalue_get_real()`). */
+    FULL_VALUE_REAL = 3,
+    /* The value is a string (see `fvalue_get_string()`). */
+    FULL_VALUE_STRING = 4,
+    /* The value is an array (see `fvalue_array_len()` and `fvalue_array_get()`). */
+    FULL_VALUE_ARRAY = 5,
+    /* The value is an instance of a class (see `fvalue_get_class()` and `fvalue_field()`). */
+    FULL_VALUE_INSTANCE = 6,
+    /* The value is a dataset (see `fvalue_get_string()`). */
+    FULL_VALUE_DATA = 7,
+    /* The value is an intermediate result (see `fvalue_get_string()`). */
+    FULL_VALUE_INTERMEDIATE_RESULT = 8,
+} FullValueKind;
+/* Defines the profile timings of a single workflow run, as reported by the driver.
+ * 
+ * WARNING: Do not access any internals yourself, since there are no guarantees on the internal layout of this struct.
+ */
+typedef struct _profile Profile;
+/* Defines a BRANE virtual machine.
  * 
- * This can run a compiled workflow on a running instance.
+ * This can run a compiled workflow on a running instance (see [`vm_new()`]), or on this machine (see [`vm_new_offline()`] and [`vm_new_dummy()`]).
+ * 
+ * A VirtualMachine may only be used by one thread at a time. To run workflows from many threads, use a [`VmPool`] instead.
  * 
  * WARNING: Do not access any internals yourself, since there are no guarantees on the internal layout of this struct.
  */
 typedef struct _virtual_machine VirtualMachine;
+/* Defines a handle to a workflow that is running in the background on a [`VirtualMachine`].
+ * 
+ * WARNING: Do not access any internals yourself, since there are no guarantees on the internal layout of this struct.
+ */
+typedef struct _run_handle RunHandle;
+/* Defines a pool of [`VirtualMachine`]s on the same instance that may be used from many threads at once.
+ * 
+ * A [`VirtualMachine`] may only be used by one thread at a time. A pool, on the other hand, can be shared between any number of threads without locking it yourself: every call checks out one of the pool's VMs for its duration, waiting for one to be returned if all of them are in use. The VMs share the package and data index and the connections to the driver, but each has its own session. Because consecutive calls may land on different VMs, the snippets run on a pool must be stateless: a snippet cannot use the variables, functions or classes defined by an earlier one. Use a single [`VirtualMachine`] per session for REPL-like use instead.
+ * 
+ * WARNING: Do not access any internals yourself, since there are no guarantees on the internal layout of this struct.
+ */
+typedef struct _vm_pool VmPool;
+
+/* Defines the callback that is called when a workflow started with `vm_run_async()` completes.
+ * 
+ * Note that this callback is called from one of the library's runtime threads, not the thread that started the run.
+ * 
+ * # Arguments
+ * - `user_data`: The opaque pointer given to `vm_run_async()`.
+ * - `err`: An [`Error`]-struct that describes why the run failed, or [`NULL`] if it succeeded. If non-[`NULL`], the callback owns it and has to free it using `error_free()`.
+ * - `prints`: A newly allocated string with any stdout- or stderr prints done during workflow execution, or [`NULL`] if the run failed. Can be freed using `free()`.
+ * - `result`: A [`FullValue`] which represents the return value of the workflow, or [`NULL`] if the run failed. Has to be freed using `fvalue_free()`.
+ */
+typedef void (*RunCallback)(void* user_data, Error* err, char* prints, FullValue* result);
+/* Defines the callback that is called whenever one of the workflows given to `vm_run_batch()` completes.
+ * 
+ * # Arguments
+ * - `user_data`: The opaque pointer given to `vm_run_batch()`.
+ * - `index`: The index of the workflow that completed in the array given to `vm_run_batch()`.
+ * - `err`: An [`Error`]-struct that describes why the run failed, or [`NULL`] if it succeeded. If non-[`NULL`], the callback owns it and has to free it using `error_free()`.
+ * - `prints`: A newly allocated string with any stdout- or stderr prints done during workflow execution, or [`NULL`] if the run failed. Can be freed using `free()`.
+ * - `result`: A [`FullValue`] which represents the return value of the workflow, or [`NULL`] if the run failed. Has to be freed using `fvalue_free()`.
+ */
+typedef void (*BatchCallback)(void* user_data, size_t index, Error* err, char* prints, FullValue* result);
+/* Defines the callback to which a [`VirtualMachine`] forwards workflow output as it arrives (see `vm_set_output_callback()`).
+ * 
+ * # Arguments
+ * - `user_data`: The opaque pointer given to `vm_set_output_callback()`.
+ * - `is_stderr`: Whether this chunk was written to stderr (true) or stdout (false).
+ * - `chunk`: The chunk of output. Note that it is _not_ null-terminated, and only valid for the duration of the call.
+ * - `len`: The length of `chunk`, in bytes.
+ */
+typedef void (*OutputCallback)(void* user_data, bool is_stderr, const char* chunk, size_t len);
+/* Defines the callback to which the library routes its log records (see `set_log_sink()`).
+ * 
+ * # Arguments
+ * - `user_data`: The opaque pointer given to `set_log_sink()`.
+ * - `level`: The level of the record: `1` for errors, `2` for warnings, `3` for info, `4` for debug and `5` for trace.
+ * - `target`: The (null-terminated) module path that emitted the record. Only valid for the duration of the call.
+ * - `message`: The (null-terminated) message of the record. Only valid for the duration of the call.
+ */
+typedef void (*LogCallback)(void* user_data, uint32_t level, const char* target, const char* message);
+
+/* Defines options that tune how `vm_process_ex()` downloads a dataset.
+ */
+typedef struct _process_options {
+    /* The maximum number of byte ranges to download concurrently. `0` or `1` download the dataset as a single stream. */
+    size_t concurrency;
+    /* The size (in bytes) of every byte range. `0` uses the default (8 MiB). */
+    uint64_t chunk_size;
+} ProcessOptions;
+
+/* The number of (power-of-two) latency buckets in an `OpMetrics`.
+ */
+#define BRANE_METRICS_BUCKETS 40
+
+/* Defines a snapshot of the metrics of a single kind of operation (see `metrics_snapshot()`).
+ */
+typedef struct _op_metrics {
+    /* The number of operations performed. */
+    uint64_t calls;
+    /* The number of operations that failed. */
+    uint64_t errors;
+    /* The summed latency of all operations, in microseconds. */
+    uint64_t total_us;
+    /* The highest latency of any operation, in microseconds. */
+    uint64_t max_us;
+    /* An upper bound of the median latency, in microseconds. */
+    uint64_t p50_us;
+    /* An upper bound of the 90th percentile latency, in microseconds. */
+    uint64_t p90_us;
+    /* An upper bound of the 99th percentile latency, in microseconds. */
+    uint64_t p99_us;
+    /* Bucket `i` counts the operations that took less than `2^i` microseconds (but not less than `2^(i - 1)`). The last bucket also counts anything slower. */
+    uint64_t buckets[BRANE_METRICS_BUCKETS];
+} OpMetrics;
+
+/* Defines a snapshot of all metrics collected by the library (see `metrics_snapshot()`).
+ */
+typedef struct _metrics {
+    /* Snippets compiled with `compiler_compile()` or `compiler_compile_batch()` (including ones answered from the cache). Compiles that only produced warnings count as successful. */
+    OpMetrics compile;
+    /* Workflows run with `vm_run()`, `vm_run_profiled()`, `vm_run_with_deadline()`, `vm_run_async()` or `vm_run_batch()` (once per workflow). */
+    OpMetrics run;
+    /* Datasets downloaded by `vm_process()`, `vm_process_ex()` or `vm_process_many()`. */
+    OpMetrics download;
+    /* Package indices downloaded from a remote (i.e., not ones read from a cache). */
+    OpMetrics pindex;
+    /* Data indices downloaded from a remote, including refreshes by `vm_process()` (but not ones read from a cache). */
+    OpMetrics dindex;
+    /* Workflows disassembled with `workflow_disassemble()` or `workflow_disassemble_into()`. */
+    OpMetrics disassemble;
+    /* Values serialized with `fvalue_serialize()` or `fvalue_serialize_into()`. */
+    OpMetrics serialize;
+} Metrics;
+
+
+
+/* The version of the layout of the `FunctionTable` that this header expects (see `brane_cli_get_vtable()`).
+ */
+#define BRANE_CLI_ABI_VERSION 1
+
+/* Defines a table with pointers to all functions of the library, as returned by `brane_cli_get_vtable()`.
+ * 
+ * The pointers are in the same order as the function members of the [`Functions`]-struct. Functions are only ever appended, so the table of a newer library may be longer than this header knows of.
+ */
+typedef struct _function_table {
+    /* The version of the layout of this table. */
+    uint32_t abi_version;
+    /* The number of pointers in `functions`. */
+    size_t len;
+    /* Pointers to the library functions. */
+    void* const* functions;
+} FunctionTable;
 
 
 
 /* Defines a struct that can be used to conveniently initialize the function pointers in this library.
+ * 
+ * The function members are in the same order as the library's `FunctionTable`, so new functions must only be added at the end.
  */
 struct _functions {
     /* The dlopen handle that we use to load stuff with. */
@@ -111,6 +294,81 @@ struct _functions {
      */
     void (*set_force_colour)(bool force);
 
+    /* Sets which log records the library emits.
+     * 
+     * Records below the given level are skipped before they are formatted, so silencing the library (e.g., in a service that compiles at a high rate) removes the logging overhead from every call.
+     * 
+     * # Arguments
+     * - `level`: The most verbose level to emit: `0` for nothing, `1` for errors, `2` for warnings, `3` for info, `4` for debug (the default) and `5` (or higher) for trace.
+     */
+    void (*set_log_level)(uint32_t level);
+
+    /* Routes the log records of the library to the given callback instead of writing them to the terminal.
+     * 
+     * Which records are emitted is still decided by [`set_log_level()`].
+     * 
+     * Replacing or removing the callback waits until any calls to the old one on other threads have returned, so once this function returns, the old callback and its `user_data` are no longer used and may be freed.
+     * 
+     * # Safety
+     * The `callback` is called from whichever thread emits a record, including the runtime's own threads. It must not call any library functions itself (and calling this function from it deadlocks).
+     * 
+     * # Arguments
+     * - `callback`: The [`LogCallback`] to call for every record. If [`NULL`], any installed callback is removed and records are written to the terminal again.
+     * - `user_data`: Some opaque pointer that is given back to the `callback`.
+     */
+    void (*set_log_sink)(LogCallback callback, void* user_data);
+
+    /* Configures the shared runtime that the library uses to do any networking on.
+     * 
+     * By default, the library uses a runtime with a single worker thread. Hosts that run many workflows concurrently (e.g., from multiple threads or using `vm_run_async()`) can use this function to give it more threads, such that runs actually overlap.
+     * 
+     * Note that this function must be called _before_ any index, compiler or virtual machine has been created (or after all of them have been freed again), since the runtime is shared among all of them.
+     * 
+     * # Arguments
+     * - `worker_threads`: The number of worker threads to run the runtime on. If `0`, then one is spawned per CPU core.
+     * - `max_blocking`: The maximum number of additional threads spawned for blocking operations (e.g., file I/O). If `0`, then tokio's default is used.
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     */
+    Error* (*runtime_configure)(size_t worker_threads, size_t max_blocking);
+
+    /* Configures the process-wide pool of driver connections that virtual machines run their workflows on.
+     * 
+     * Every [`vm_new()`] and every workflow run re-uses an existing connection to the same driver endpoint if one is available, instead of setting up a new one. Each connection multiplexes the requests of everything that shares it over a single HTTP/2 connection, where every running workflow keeps a stream open. A run takes the connection with the fewest running workflows; by default, at most 16 workflows run over one connection at the same time before a new one is opened. Connections that no virtual machine or run has used for a minute are closed.
+     * 
+     * Note that this only affects runs started after the call. Pooled connections live at most as long as the shared runtime does, i.e., until the last index, compiler and virtual machine has been freed.
+     * 
+     * # Arguments
+     * - `max_streams`: The maximum number of workflows that run over a single connection at the same time. If `0`, then there is no limit; if `1`, every concurrent run gets a connection of its own.
+     */
+    void (*driver_pool_configure)(size_t max_streams);
+
+    /* Takes a snapshot of the metrics that the library collected since it was loaded (or since [`metrics_reset()`]).
+     * 
+     * Collecting the metrics is cheap and lock-free, so they are always enabled.
+     * 
+     * # Arguments
+     * - `metrics`: The [`Metrics`]-struct to write the snapshot to.
+     * 
+     * # Panics
+     * This function can panic if the given `metrics` is a NULL-pointer.
+     */
+    void (*metrics_snapshot)(Metrics* metrics);
+
+    /* Serializes a snapshot of the metrics that the library collected (see [`metrics_snapshot()`]) as JSON.
+     * 
+     * This is meant for benchmarks and load tests that want to record the library's own view of its latencies in a machine-readable form. The result is a single object with a field per operation (e.g., `"compile"`), each of which is an object with the same fields as [`OpMetrics`].
+     * 
+     * # Returns
+     * The serialized metrics, as a string. Don't forget to free it!
+     */
+    char* (*metrics_serialize)();
+
+    /* Resets all metrics collected by the library back to zero.
+     */
+    void (*metrics_reset)();
+
 
 
     /***** ERROR *****/
@@ -134,6 +392,35 @@ struct _functions {
      */
     void (*error_serialize_err)(Error* err, char** buffer);
 
+    /* Serializes the error message in this error to a buffer given by the caller, `snprintf`-style.
+     * 
+     * # Arguments
+     * - `err`: the [`Error`] to serialize the error of.
+     * - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+     * - `len`: The size of the `buffer`, in bytes.
+     * 
+     * # Returns
+     * The length of the complete message (excluding the null-byte). If this is `len` or more, the message was truncated; call again with a buffer of at least the returned length + 1.
+     * 
+     * # Panics
+     * This function can panic if the given `err` is a NULL-pointer.
+     */
+    size_t (*error_serialize_err_into)(Error* err, char* buffer, size_t len);
+
+    /* Provides a borrowed view of the error message in this error, without copying it.
+     * 
+     * # Arguments
+     * - `err`: the [`Error`] to view the error of.
+     * - `len`: Will be set to the length of the message, in bytes.
+     * 
+     * # Returns
+     * A pointer to the message. Note that it is _not_ null-terminated, and only valid until `err` is freed.
+     * 
+     * # Panics
+     * This function can panic if the given `err` or `len` are NULL-pointers.
+     */
+    const char* (*error_view_err)(Error* err, size_t* len);
+
     /* Prints the error message in this error to stderr.
      * 
      * # Arguments
@@ -230,6 +517,99 @@ struct _functions {
      */
     void (*serror_serialize_err)(SourceError* serr, char** buffer);
 
+    /* Serializes the source warnings in this error to a buffer given by the caller, `snprintf`-style.
+     * 
+     * Note that there may be zero or more warnings at once. To discover if there are any, check [`serror_has_swarns()`].
+     * 
+     * # Arguments
+     * - `serr`: the [`SourceError`] to serialize the source warnings of.
+     * - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+     * - `len`: The size of the `buffer`, in bytes.
+     * 
+     * # Returns
+     * The length of the complete serialized warnings (excluding the null-byte). If this is `len` or more, they were truncated; call again with a buffer of at least the returned length + 1.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` is a NULL-pointer.
+     */
+    size_t (*serror_serialize_swarns_into)(SourceError* serr, char* buffer, size_t len);
+
+    /* Provides a borrowed view of the serialized source warnings in this error, without copying them.
+     * 
+     * # Arguments
+     * - `serr`: the [`SourceError`] to view the source warnings of.
+     * - `len`: Will be set to the length of the serialized warnings, in bytes.
+     * 
+     * # Returns
+     * A pointer to the serialized warnings. Note that it is _not_ null-terminated, and only valid until `serr` is freed.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` or `len` are NULL-pointers.
+     */
+    const char* (*serror_view_swarns)(SourceError* serr, size_t* len);
+
+    /* Serializes the source errors in this error to a buffer given by the caller, `snprintf`-style.
+     * 
+     * Note that there may be zero or more errors at once. To discover if there are any, check [`serror_has_serrs()`].
+     * 
+     * # Arguments
+     * - `serr`: the [`SourceError`] to serialize the source errors of.
+     * - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+     * - `len`: The size of the `buffer`, in bytes.
+     * 
+     * # Returns
+     * The length of the complete serialized errors (excluding the null-byte). If this is `len` or more, they were truncated; call again with a buffer of at least the returned length + 1.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` is a NULL-pointer.
+     */
+    size_t (*serror_serialize_serrs_into)(SourceError* serr, char* buffer, size_t len);
+
+    /* Provides a borrowed view of the serialized source errors in this error, without copying them.
+     * 
+     * # Arguments
+     * - `serr`: the [`SourceError`] to view the source errors of.
+     * - `len`: Will be set to the length of the serialized errors, in bytes.
+     * 
+     * # Returns
+     * A pointer to the serialized errors. Note that it is _not_ null-terminated, and only valid until `serr` is freed.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` or `len` are NULL-pointers.
+     */
+    const char* (*serror_view_serrs)(SourceError* serr, size_t* len);
+
+    /* Serializes the error message in this error to a buffer given by the caller, `snprintf`-style.
+     * 
+     * Note that there may be no error, but only source warnings- or errors. To discover if there is any, check [`serror_has_err()`].
+     * 
+     * # Arguments
+     * - `serr`: the [`SourceError`] to serialize the error message of.
+     * - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+     * - `len`: The size of the `buffer`, in bytes.
+     * 
+     * # Returns
+     * The length of the complete serialized message (excluding the null-byte). If this is `len` or more, they were truncated; call again with a buffer of at least the returned length + 1.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` is a NULL-pointer.
+     */
+    size_t (*serror_serialize_err_into)(SourceError* serr, char* buffer, size_t len);
+
+    /* Provides a borrowed view of the serialized error message in this error, without copying it.
+     * 
+     * # Arguments
+     * - `serr`: the [`SourceError`] to view the error message of.
+     * - `len`: Will be set to the length of the serialized message, in bytes.
+     * 
+     * # Returns
+     * A pointer to the serialized message. Note that it is _not_ null-terminated, and only valid until `serr` is freed.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` or `len` are NULL-pointers.
+     */
+    const char* (*serror_view_err)(SourceError* serr, size_t* len);
+
     /* Prints the source warnings in this error to stderr.
      * 
      * Note that there may be zero or more warnings at once. To discover if there are any, check [`serror_has_swarns()`].
@@ -280,6 +660,23 @@ struct _functions {
      * This function can panic if the given `endpoint` does not point to a valud UTF-8 string.
      */
     Error* (*pindex_new_remote)(const char* endpoint, PackageIndex** pindex);
+    /* Constructs a new [`PackageIndex`] that lists the available packages in a remote instance, re-using an on-disk copy if it is recent enough.
+     * 
+     * If the remote has to be contacted, then the downloaded index is written to the cache for subsequent calls (possibly from other processes).
+     * 
+     * # Arguments
+     * - `endpoint`: The remote API-endpoint to read the packages from. The path (`/graphql`) will be deduced and needn't be given, just the host and port.
+     * - `cache_dir`: The directory where cached indices are stored. Will be created if it does not exist.
+     * - `max_age`: The maximum age (in seconds) of the cached index before it is considered stale and re-downloaded.
+     * - `pindex`: Will point to the newly created [`PackageIndex`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `endpoint` or `cache_dir` do not point to a valud UTF-8 string.
+     */
+    Error* (*pindex_new_remote_cached)(const char* endpoint, const char* cache_dir, uint64_t max_age, PackageIndex** pindex);
 
     /* Destructor for the PackageIndex.
      * 
@@ -306,6 +703,23 @@ struct _functions {
      * This function can panic if the given `endpoint` does not point to a valud UTF-8 string.
      */
     Error* (*dindex_new_remote)(const char* endpoint, DataIndex** dindex);
+    /* Constructs a new [`DataIndex`] that lists the available datasets in a remote instance, re-using an on-disk copy if it is recent enough.
+     * 
+     * If the remote has to be contacted, then the downloaded index is written to the cache for subsequent calls (possibly from other processes).
+     * 
+     * # Arguments
+     * - `endpoint`: The remote API-endpoint to read the datasets from. The path (`/data/info`) will be deduced and needn't be given, just the host and port.
+     * - `cache_dir`: The directory where cached indices are stored. Will be created if it does not exist.
+     * - `max_age`: The maximum age (in seconds) of the cached index before it is considered stale and re-downloaded.
+     * - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `endpoint` or `cache_dir` do not point to a valud UTF-8 string.
+     */
+    Error* (*dindex_new_remote_cached)(const char* endpoint, const char* cache_dir, uint64_t max_age, DataIndex** dindex);
 
     /* Destructor for the DataIndex.
      * 
@@ -353,6 +767,22 @@ struct _functions {
      */
     Error* (*workflow_disassemble)(Workflow* workflow, char** assembly);
 
+    /* Serializes the workflow by essentially disassembling it, writing it to a buffer given by the caller `snprintf`-style.
+     * 
+     * # Arguments
+     * - `workflow`: The [`Workflow`] to disassemble.
+     * - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+     * - `len`: The size of the `buffer`, in bytes.
+     * - `written`: Will be set to the length of the complete assembly (excluding the null-byte). If this is `len` or more, it was truncated; call again with a buffer of at least this length + 1.
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `workflow` or `written` are NULL-pointers.
+     */
+    Error* (*workflow_disassemble_into)(Workflow* workflow, char* buffer, size_t len, size_t* written);
+
 
 
     /***** COMPILER *****/
@@ -383,6 +813,8 @@ struct _functions {
      * 
      * Note that this function changes the `compiler`'s state.
      * 
+     * If this is the first snippet given to the `compiler`, the result may be served from a process-wide cache (see [`compiler_cache_stats()`]).
+     * 
      * # Arguments
      * - `compiler`: The [`Compiler`] to compile with. Essentially this determines which previous compile state to use.
      * - `what`: Some string describing what we are compiling (e.g., a file, `<intern>`, a cell, etc.)
@@ -401,6 +833,40 @@ struct _functions {
      * This function can panic if the given `compiler` points to NULL, or `what`/`raw` does not point to a valid UTF-8 string.
      */
     SourceError* (*compiler_compile)(Compiler* compiler, const char* what, const char* raw, Workflow** workflow);
+    /* Compiles many independent BraneScript snippets to the BRANE Workflow Representation in parallel.
+     * 
+     * Unlike [`compiler_compile()`], every snippet is compiled as if it were the first snippet given to a fresh [`Compiler`]; i.e., they cannot refer to each other, and the `compiler`'s own state is not used nor changed. Only its indices are used, of which a single snapshot is taken for the entire batch.
+     * 
+     * # Safety
+     * Be aware that the returned [`SourceError`]s refer to the given `whats`. Freeing any of those and then using the matching [`SourceError`] _will_ lead to undefined behaviour.
+     * 
+     * You _must_ free every returned [`SourceError`] using [`serror_free()`], and every returned [`Workflow`] using [`workflow_free()`].
+     * 
+     * # Arguments
+     * - `compiler`: The [`Compiler`] of which to use the indices.
+     * - `whats`: An array of `n` strings describing what we are compiling (e.g., a file, `<intern>`, a cell, etc.)
+     * - `raws`: An array of `n` raw BraneScript snippets to parse.
+     * - `n`: The number of snippets in the batch.
+     * - `workflows`: A caller-allocated array of `n` elements. Element `i` will point to the compiled AST of snippet `i`, or [`NULL`] if it failed to compile.
+     * - `serrs`: A caller-allocated array of `n` elements. Element `i` will point to a [`SourceError`]-struct describing the error, if any, and source warnings/errors of snippet `i`.
+     * 
+     * # Panics
+     * This function can panic if the given `compiler`, `whats`, `raws`, `workflows` or `serrs` point to NULL, or any `what`/`raw` does not point to a valid UTF-8 string.
+     */
+    void (*compiler_compile_batch)(const Compiler* compiler, const char* const* whats, const char* const* raws, size_t n, Workflow** workflows, SourceError** serrs);
+    /* Reports how well the process-wide cache of compiled workflows performs.
+     * 
+     * The cache is consulted by [`compiler_compile()`] for the first snippet given to a [`Compiler`] and by [`compiler_compile_batch()`] for every snippet. It is keyed on the snippet text and on the exact package and data index snapshots compiled against; so replacing an index (e.g., by [`vm_process()`] refreshing it) naturally invalidates the entries.
+     * 
+     * # Arguments
+     * - `hits`: Will be set to the number of compilations answered from the cache. May be [`NULL`] if not interesting.
+     * - `misses`: Will be set to the number of cacheable compilations that had to be compiled. May be [`NULL`] if not interesting.
+     * - `entries`: Will be set to the number of workflows currently in the cache. May be [`NULL`] if not interesting.
+     */
+    void (*compiler_cache_stats)(uint64_t* hits, uint64_t* misses, size_t* entries);
+    /* Empties the process-wide cache of compiled workflows and resets its counters.
+     */
+    void (*compiler_cache_clear)();
 
 
 
@@ -441,78 +907,871 @@ struct _functions {
      */
     void (*fvalue_serialize)(FullValue* fvalue, const char* data_dir, char** result);
 
-
-
-    /***** VIRTUAL MACHINE *****/
-    /* Constructor for the VirtualMachine.
+    /* Serializes a FullValue to show as result of the workflow, writing it to a buffer given by the caller `snprintf`-style.
      * 
      * # Arguments
-     * - `api_endpoint`: The Brane API endpoint to connect to to download available registries and all that.
-     * - `drv_endpoint`: The BRANE driver endpoint to connect to to execute stuff.
-     * - `certs_dir`: The directory where certificates for downloading datasets are stored.
-     * - `pindex`: The [`PackageIndex`] to resolve package references in the snippets with.
-     * - `dindex`: The [`DataIndex`] to resolve dataset references in the snippets with.
-     * - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+     * - `fvalue`: the [`FullValue`] to serialize.
+     * - `data_dir`: The data directory to which we downloaded the `fvalue`, if we did so.
+     * - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+     * - `len`: The size of the `buffer`, in bytes.
      * 
      * # Returns
-     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * The length of the complete serialized value (excluding the null-byte). If this is `len` or more, it was truncated; call again with a buffer of at least the returned length + 1.
      * 
      * # Panics
-     * This function can panic if the given `pindex` or `dindex` are NULL, or if the given `api_endpoint`, `drv_endpoint` or `certs_dir` do not point to a valid UTF-8 string.
+     * This function can panic if the given `fvalue` is a NULL-pointer or if `data_dir` did not point to a valid UTF-8 string.
      */
-    Error* (*vm_new)(const char* api_endpoint, const char* drv_endpoint, const char* certs_dir, PackageIndex* pindex, DataIndex* dindex, VirtualMachine** vm);
-    /* Destructor for the VirtualMachine.
+    size_t (*fvalue_serialize_into)(FullValue* fvalue, const char* data_dir, char* buffer, size_t len);
+
+    /* Destructor for the Profile.
      * 
-     * SAFETY: You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+     * # Safety
+     * You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
      * 
      * # Arguments
-     * - `vm`: The [`VirtualMachine`] to free.
+     * - `profile`: The [`Profile`] to free.
      */
-    void (*vm_free)(VirtualMachine* vm);
+    void (*profile_free)(Profile* profile);
 
-    /* Runs the given code snippet on the backend instance.
+    /* Returns the number of entries in the given profile.
      * 
      * # Arguments
-     * - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
-     * - `workflow`: The compiled workflow to execute.
-     * - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below).
-     * - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+     * - `profile`: The [`Profile`] to inspect.
      * 
      * # Returns
-     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * The number of timings and scopes reported by the driver. Is `0` if the driver did not report any.
      * 
      * # Panics
-     * This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+     * This function can panic if the given `profile` is a NULL-pointer.
      */
-    Error* (*vm_run)(VirtualMachine* vm, Workflow* workflow, char** prints, FullValue** result);
-    /* Processes the result referred to by the [`FullValue`].
-     * 
-     * Processing currently consists of:
-     * - Downloading the dataset if it's a [`FullValue::Data`]
-     * - Throwing a warning if it's a [`FullValue::IntermediateResult`]
-     * - Doing nothing otherwise
+    size_t (*profile_len)(Profile* profile);
+
+    /* Returns the name of an entry in the given profile.
      * 
      * # Arguments
-     * - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
-     * - `result`: The [`FullValue`] which we will attempt to download if needed.
-     * - `data_dir`: The directory to download the result to. This should be the generic data directory, as a new directory for this dataset will be created within.
+     * - `profile`: The [`Profile`] to inspect.
+     * - `i`: The index of the entry.
      * 
      * # Returns
-     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * The name of the timing or scope. It is valid for as long as `profile` is; don't free it.
      * 
      * # Panics
-     * This function may panic if the input `vm` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+     * This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
      */
-    Error* (*vm_process)(VirtualMachine* vm, FullValue* result, const char* data_dir);
-};
-typedef struct _functions Functions;
-
-
-
+    const char* (*profile_entry_name)(Profile* profile, size_t i);
+
+    /* Returns the depth of an entry in the given profile.
+     * 
+     * # Arguments
+     * - `profile`: The [`Profile`] to inspect.
+     * - `i`: The index of the entry.
+     * 
+     * # Returns
+     * The number of scopes that the entry is nested in. Toplevel entries have a depth of `0`.
+     * 
+     * # Panics
+     * This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
+     */
+    size_t (*profile_entry_depth)(Profile* profile, size_t i);
+
+    /* Returns whether an entry in the given profile is a nested scope.
+     * 
+     * # Arguments
+     * - `profile`: The [`Profile`] to inspect.
+     * - `i`: The index of the entry.
+     * 
+     * # Returns
+     * True if the entry is a scope (and the next entries with a higher depth are in it), or false if it is a timing.
+     * 
+     * # Panics
+     * This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
+     */
+    bool (*profile_entry_is_scope)(Profile* profile, size_t i);
+
+    /* Returns the time taken by an entry in the given profile.
+     * 
+     * # Arguments
+     * - `profile`: The [`Profile`] to inspect.
+     * - `i`: The index of the entry.
+     * 
+     * # Returns
+     * The time taken, in nanoseconds. Is `0` if the entry is a scope; its time is typically found in a nested `total`-timing instead.
+     * 
+     * # Panics
+     * This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
+     */
+    uint64_t (*profile_entry_nanos)(Profile* profile, size_t i);
+
+    /* Returns the total time of the run described by the given profile, as seen by the client.
+     * 
+     * This includes the time spent sending the workflow and receiving the result, so comparing it with the driver's own timings shows the overhead of the connection.
+     * 
+     * # Arguments
+     * - `profile`: The [`Profile`] to inspect.
+     * 
+     * # Returns
+     * The time taken, in nanoseconds.
+     * 
+     * # Panics
+     * This function can panic if the given `profile` is a NULL-pointer.
+     */
+    uint64_t (*profile_total_nanos)(Profile* profile);
+
+    /* Serializes the given profile as a human-readable report.
+     * 
+     * # Arguments
+     * - `profile`: The [`Profile`] to serialize.
+     * - `buffer`: The buffer to serialize to. Will be freshly allocated using `malloc` for the correct size; can be freed using `free()`.
+     * 
+     * # Panics
+     * This function can panic if the given `profile` or `buffer` are NULL-pointers.
+     */
+    void (*profile_serialize)(Profile* profile, char** buffer);
+
+
+
+    /***** VIRTUAL MACHINE *****/
+    /* Constructor for the VirtualMachine.
+     * 
+     * # Arguments
+     * - `api_endpoint`: The Brane API endpoint to connect to to download available registries and all that.
+     * - `drv_endpoint`: The BRANE driver endpoint to connect to to execute stuff.
+     * - `certs_dir`: The directory where certificates for downloading datasets are stored.
+     * - `pindex`: The [`PackageIndex`] to resolve package references in the snippets with.
+     * - `dindex`: The [`DataIndex`] to resolve dataset references in the snippets with.
+     * - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function can panic if the given `pindex` or `dindex` are NULL, or if the given `api_endpoint`, `drv_endpoint` or `certs_dir` do not point to a valid UTF-8 string.
+     */
+    Error* (*vm_new)(const char* api_endpoint, const char* drv_endpoint, const char* certs_dir, PackageIndex* pindex, DataIndex* dindex, VirtualMachine** vm);
+
+    /* Constructor for a VirtualMachine that runs workflows on this machine, using the local Docker daemon.
+     * 
+     * This executes workflows in the same way as `brane run` without `--remote`: packages are taken from the local package directory, and datasets from (and committed results to) the local data directory. No instance is contacted.
+     * 
+     * Note that the workflows run on it should be compiled against indices of the local packages and datasets.
+     * 
+     * # Arguments
+     * - `docker_socket`: The path of the socket with which to connect to the Docker daemon. If [`NULL`], uses the platform's default socket.
+     * - `keep_containers`: Whether to keep the containers of tasks after they completed (useful for debugging).
+     * - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function can panic if the given `docker_socket` does not point to a valid UTF-8 string.
+     */
+    Error* (*vm_new_offline)(const char* docker_socket, bool keep_containers, VirtualMachine** vm);
+
+    /* Constructor for a VirtualMachine that does not run any tasks, but returns default values for them instead.
+     * 
+     * This is useful for testing whether workflows run as expected without needing an instance or Docker. Any prints done by the workflow itself are still collected.
+     * 
+     * # Arguments
+     * - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     */
+    Error* (*vm_new_dummy)(VirtualMachine** vm);
+    /* Destructor for the VirtualMachine.
+     * 
+     * SAFETY: You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] to free.
+     */
+    void (*vm_free)(VirtualMachine* vm);
+    /* Installs a callback that receives any stdout- or stderr output of workflows run on this VM as soon as the remote sends it.
+     * 
+     * While a callback is installed, output is no longer buffered; the `prints` returned by [`vm_run()`] (and friends) will be empty.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] to install the callback on.
+     * - `callback`: The [`OutputCallback`] to call for every chunk. If [`NULL`], any installed callback is removed and output is buffered again.
+     * - `user_data`: Some opaque pointer that is given back to the `callback`.
+     * 
+     * ## SAFETY
+     * The `callback` may be called from any thread that is running a workflow for this VM, including the runtime's own threads for [`vm_run_async()`]. It must not call this function itself.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` pointed to a NULL-pointer.
+     */
+    void (*vm_set_output_callback)(VirtualMachine* vm, OutputCallback callback, void* user_data);
+    /* Sets how long [`vm_process()`] may re-use the data index it downloaded before downloading it again.
+     * 
+     * By default, the index is downloaded for every dataset that is processed. If a TTL is set, then the index is only downloaded again if it is older than the TTL _or_ if it does not know the dataset to process.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] to set the TTL of.
+     * - `ttl`: The time (in seconds) that a downloaded data index stays valid. `0` means that it is downloaded every time.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` pointed to a NULL-pointer.
+     */
+    void (*vm_set_index_ttl)(VirtualMachine* vm, uint64_t ttl);
+
+    /* Runs the given code snippet on the backend instance.
+     * 
+     * The workflow is submitted in a compact binary encoding (MessagePack) if the driver advertised support for it when the session was created, and as JSON otherwise.
+     * 
+     * This is equivalent to calling [`vm_run_profiled()`] without asking for a profile.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+     * - `workflow`: The compiled workflow to execute.
+     * - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below). Is empty if an output callback is installed (see [`vm_set_output_callback()`]).
+     * - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+     */
+    Error* (*vm_run)(VirtualMachine* vm, Workflow* workflow, char** prints, FullValue** result);
+
+    /* Runs the given code snippet on the backend instance, and optionally collects where it spent its time.
+     * 
+     * If a `profile` is asked for, the driver reports its timings along with the result. These include planning, and every task's preprocessing, execution and committing on the worker it was scheduled on.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+     * - `workflow`: The compiled workflow to execute.
+     * - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below). Is empty if an output callback is installed (see [`vm_set_output_callback()`]).
+     * - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+     * - `profile`: If not [`NULL`], will point to a new [`Profile`] with the timings of this run. Will be [`NULL`] if there is an error (see below). Has to be freed using [`profile_free()`].
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+     */
+    Error* (*vm_run_profiled)(VirtualMachine* vm, Workflow* workflow, char** prints, FullValue** result, Profile** profile);
+
+    /* Runs the given code snippet on the backend instance, but stops it if it does not complete in time.
+     * 
+     * Stopping a run on an instance closes the stream to its driver, which then aborts the workflow and closes its streams to the workers; they stop the containers of tasks that are still running. A local VM stops the container of a task that is still running, and gets back the variables it had before the run. Anything the run already did outside of the VM is not undone, though, e.g., the results and datasets it already produced are kept.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+     * - `workflow`: The compiled workflow to execute.
+     * - `timeout_ms`: The number of milliseconds after which the run is stopped. Zero means no deadline, although the run can still be cancelled with [`vm_cancel()`].
+     * - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below). Is empty if an output callback is installed (see [`vm_set_output_callback()`]).
+     * - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise. This includes the run being stopped because of the deadline or because it was cancelled.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+     */
+    Error* (*vm_run_with_deadline)(VirtualMachine* vm, Workflow* workflow, uint64_t timeout_ms, char** prints, FullValue** result);
+
+    /* Cancels all workflows that are running on the given [`VirtualMachine`].
+     * 
+     * This affects runs started with [`vm_run()`], [`vm_run_profiled()`], [`vm_run_with_deadline()`] and [`vm_run_async()`] that are in progress; they return (or report) an error saying they were cancelled. Runs started after this call are not affected.
+     * 
+     * This function may be called from another thread than the one running the workflow. It only touches the cancellation state of the VM, so it is safe to call while [`vm_run()`] (or one of its variants) runs, but not concurrently with [`vm_free()`] or with functions that configure the VM (e.g., [`vm_set_output_callback()`]).
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] to cancel the runs of.
+     * 
+     * # Panics
+     * This function can panic if the given `vm` is a NULL-pointer.
+     */
+    void (*vm_cancel)(VirtualMachine* vm);
+    /* Processes the result referred to by the [`FullValue`].
+     * 
+     * Processing currently consists of:
+     * - Downloading the dataset if it's a [`FullValue::Data`]
+     * - Throwing a warning if it's a [`FullValue::IntermediateResult`]
+     * - Doing nothing otherwise
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
+     * - `result`: The [`FullValue`] which we will attempt to download if needed.
+     * - `data_dir`: The directory to download the result to. This should be the generic data directory: the dataset is extracted to `<data_dir>/<name>/data` (next to a `data.yml` describing it), which is also where [`fvalue_serialize()`] says it is.
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+     */
+    Error* (*vm_process)(VirtualMachine* vm, FullValue* result, const char* data_dir);
+    /* Processes the result referred to by the [`FullValue`], using the given options.
+     * 
+     * Processing currently consists of:
+     * - Downloading the dataset if it's a [`FullValue::Data`]
+     * - Throwing a warning if it's a [`FullValue::IntermediateResult`]
+     * - Doing nothing otherwise
+     * 
+     * Datasets are downloaded from one of the locations advertising it, trying the others if that fails. If the registry supports it and `opts` allows it, the dataset is downloaded as multiple byte ranges in parallel; every range is checked to be cut from the same archive (by its strong `ETag`), and the download starts over as a single stream if the archive changes halfway.
+     * 
+     * If the same version of the dataset was already downloaded to `data_dir`, nothing is transferred. Otherwise, the archive is extracted while it is being downloaded, so it is never stored on disk as a whole; an interrupted transfer is resumed where it left off if the remote supports it.
+     * 
+     * Virtual machines created with [`vm_new_offline()`] or [`vm_new_dummy()`] do not download anything, since any datasets they produce already live in the local data directory.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
+     * - `result`: The [`FullValue`] which we will attempt to download if needed.
+     * - `data_dir`: The directory to download the result to. This should be the generic data directory: the dataset is extracted to `<data_dir>/<name>/data` (next to a `data.yml` describing it), which is also where [`fvalue_serialize()`] says it is.
+     * - `opts`: The [`ProcessOptions`] that determine how to download. May be [`NULL`] to use the defaults, which download as a single stream.
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+     */
+    Error* (*vm_process_ex)(VirtualMachine* vm, FullValue* result, const char* data_dir, const ProcessOptions* opts);
+
+    /* Processes multiple results at once, downloading all datasets referred to by them concurrently.
+     * 
+     * This is equivalent to calling [`vm_process()`] on every result, except that the data index is downloaded at most once, that every dataset is downloaded only once (even if referred to by multiple results), and that datasets nested in arrays or instances are downloaded too.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
+     * - `results`: An array of `n` [`FullValue`]s which we will attempt to download if needed.
+     * - `n`: The number of results in `results`.
+     * - `data_dir`: The directory to download the results to. This should be the generic data directory: like with [`vm_process()`], every dataset is extracted to `<data_dir>/<name>/data`.
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error(s) occurred, or [`NULL`] otherwise. If some datasets failed to download, the others are still downloaded.
+     * 
+     * # Panics
+     * This function may panic if the input `vm`, `results` or any of its elements pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+     */
+    Error* (*vm_process_many)(VirtualMachine* vm, const FullValue* const* results, size_t n, const char* data_dir);
+
+    /* Runs the given code snippet on the backend instance in the background.
+     * 
+     * This function returns immediately; the workflow is executed on the library's runtime. Once it completes, the given `callback` is called (on one of the runtime's threads) with the result. If no callback is given, the result can be retrieved with [`vm_run_wait()`] instead.
+     * 
+     * The run can be stopped with [`vm_cancel()`], in which case it completes with an error.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use. It may be used (or freed) again immediately after this call returns.
+     * - `workflow`: The compiled workflow to execute. It is copied, so it may be freed immediately after this call returns.
+     * - `callback`: An optional [`RunCallback`] to call when the workflow completes. If [`NULL`], the result is kept until [`vm_run_wait()`] is called.
+     * - `user_data`: Some opaque pointer that is given back to the `callback`.
+     * - `handle`: Will point to a new [`RunHandle`] that represents the background run. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * ## SAFETY
+     * The `callback` is called from a thread that is not the caller's. It must not free the last object keeping the runtime alive (i.e., it must not call [`runhandle_free()`] on its own handle).
+     * 
+     * # Panics
+     * This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+     */
+    Error* (*vm_run_async)(VirtualMachine* vm, Workflow* workflow, RunCallback callback, void* user_data, RunHandle** handle);
+    /* Checks if the workflow represented by the given [`RunHandle`] has completed.
+     * 
+     * # Arguments
+     * - `handle`: The [`RunHandle`] to poll.
+     * 
+     * # Returns
+     * True if the run has completed (and [`vm_run_wait()`] will not block), or false otherwise.
+     * 
+     * # Panics
+     * This function can panic if the given `handle` is a NULL-pointer.
+     */
+    bool (*vm_run_poll)(RunHandle* handle);
+    /* Waits until the workflow represented by the given [`RunHandle`] has completed.
+     * 
+     * If the run was started with a callback, then the results have already been given to it and `prints` and `result` will be [`NULL`].
+     * 
+     * This function cannot be called from one of the library's runtime threads, such as from within a callback; it returns an error instead of waiting there.
+     * 
+     * # Arguments
+     * - `handle`: The [`RunHandle`] to wait for.
+     * - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below) or if a callback was given.
+     * - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below) or if a callback was given.
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function can panic if the given `handle` is a NULL-pointer.
+     */
+    Error* (*vm_run_wait)(RunHandle* handle, char** prints, FullValue** result);
+    /* Destructor for the RunHandle.
+     * 
+     * Note that freeing the handle does _not_ stop the run; if it was started with a callback, it will still be called when the workflow completes, even if the [`VirtualMachine`] has been freed as well.
+     * 
+     * SAFETY: You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+     * 
+     * # Arguments
+     * - `handle`: The [`RunHandle`] to free.
+     */
+    void (*runhandle_free)(RunHandle* handle);
+
+
+
+    /***** APPENDED FUNCTIONS *****/
+    /* Functions added after the `FunctionTable` was introduced are kept here, in the order they were added, so that its layout stays compatible.
+     * 
+     * When loaded from a library that is older than this header, the functions it does not have are NULL. Check these members before calling them.
+     */
+
+    /* Creates a copy of the given workflow.
+     * 
+     * This is cheap, since the compiled parts of the workflow are shared between the copies. Changing one copy (e.g., with [`workflow_set_user()`] or [`workflow_bind()`]) does not affect the others.
+     * 
+     * The copy gets a new ID, since the driver and the checkers identify submissions by it and copies are typically submitted alongside each other.
+     * 
+     * # Arguments
+     * - `workflow`: The [`Workflow`] to copy.
+     * 
+     * # Returns
+     * A new [`Workflow`] that is the same as `workflow` except for its ID. Has to be freed using [`workflow_free()`].
+     * 
+     * # Panics
+     * This function can panic if the given `workflow` is a NULL-pointer.
+     */
+    Workflow* (*workflow_clone)(Workflow* workflow);
+
+    /* Binds a value to a top-level variable of the given workflow, without compiling it again.
+     * 
+     * The variable must be assigned a literal exactly once in the main body of the workflow (e.g., `let n := 42;`), which is then replaced by the given value. Use [`workflow_bind_dataset()`] to change the datasets that a workflow uses instead.
+     * 
+     * Combined with [`workflow_clone()`], this allows one compiled workflow to be submitted many times with different inputs.
+     * 
+     * # Arguments
+     * - `workflow`: The [`Workflow`] to bind in. Other copies of it are not affected.
+     * - `name`: The name of the variable to bind.
+     * - `value`: The [`FullValue`] to bind it to. Must be a boolean, integer, real or string of the same type as the variable (although integers may be bound to reals).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function can panic if the given `workflow` or `value` is a NULL-pointer, or if the given `name` is not valid UTF-8/a NULL-pointer.
+     */
+    Error* (*workflow_bind)(Workflow* workflow, const char* name, FullValue* value);
+
+    /* Replaces a dataset used by the given workflow with another, without compiling it again.
+     * 
+     * This changes every `new Data { name := "<from>" }` in the workflow, as well as the inputs of the tasks that use it. The new dataset does not have to be known at compile time; the remote resolves where it is when planning.
+     * 
+     * # Arguments
+     * - `workflow`: The [`Workflow`] to bind in. Other copies of it are not affected.
+     * - `from`: The name of the dataset to replace.
+     * - `to`: The name of the dataset to replace it with.
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred (i.e., the workflow does not use `from`), or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function can panic if the given `workflow` is a NULL-pointer, or if the given `from` or `to` is not valid UTF-8/a NULL-pointer.
+     */
+    Error* (*workflow_bind_dataset)(Workflow* workflow, const char* from, const char* to);
+
+    /* Runs many workflows on the backend concurrently, giving their results to a callback as they complete.
+     * 
+     * For instances, all workflows are submitted in the VM's session over its (shared) connection to the driver. Up to `concurrency` of them are in flight at the same time, so a sweep of many small workflows is not limited by a round-trip per workflow. Local VMs still run one workflow at a time.
+     * 
+     * The workflows must be independent of each other. They run concurrently in the same session, and the driver does not order them: they cannot use each other's variables, and which of their definitions the session keeps for later runs is undefined. Like any other run, the batch can be stopped with [`vm_cancel()`], in which case the remaining workflows fail.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+     * - `workflows`: An array of the compiled workflows to execute. They are copied, so they may be freed as soon as this call returns.
+     * - `n`: The number of workflows in the `workflows` array.
+     * - `concurrency`: The maximum number of workflows that run at the same time. `0` means all of them.
+     * - `callback`: The [`BatchCallback`] that is called for every workflow that completes. It is called on the thread that called this function, in the order in which the workflows complete.
+     * - `user_data`: Some opaque pointer that is given back to the `callback`.
+     * 
+     * # Returns
+     * An [`Error`]-struct that says how many workflows failed, or [`NULL`] if all of them succeeded. Why they failed is given to the `callback`.
+     * 
+     * # Panics
+     * This function may panic if the input `vm`, `workflows` (with `n > 0`), any of the workflows or the `callback` pointed to a NULL-pointer.
+     */
+    Error* (*vm_run_batch)(VirtualMachine* vm, Workflow* const* workflows, size_t n, size_t concurrency, BatchCallback callback, void* user_data);
+
+    /* Constructs a new [`PackageIndex`] that lists the packages in a local directory (i.e., without contacting any instance).
+     * 
+     * # Arguments
+     * - `packages_dir`: The directory to read the packages from. It is expected to be laid out as `<name>/<version>/package.yml`.
+     * - `pindex`: Will point to the newly created [`PackageIndex`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `packages_dir` does not point to a valud UTF-8 string.
+     */
+    Error* (*pindex_new_local)(const char* packages_dir, PackageIndex** pindex);
+
+    /* Constructs a new [`PackageIndex`] from a local cache file written by [`pindex_write_cache()`] or by [`pindex_new_remote_cached()`] (which use the same format).
+     * 
+     * The file simply holds the index as JSON. It saves contacting the instance, but every process that loads it still reads and parses it in full.
+     * 
+     * # Arguments
+     * - `path`: The path to the cache file.
+     * - `pindex`: Will point to the newly created [`PackageIndex`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `path` does not point to a valud UTF-8 string.
+     */
+    Error* (*pindex_read_cache)(const char* path, PackageIndex** pindex);
+
+    /* Writes the given [`PackageIndex`] to a local cache file (as JSON), such that it can be loaded later using [`pindex_read_cache()`] without contacting the instance.
+     * 
+     * The file is written to a temporary file first and then moved into place, so that processes loading it concurrently never see a partial file.
+     * 
+     * # Arguments
+     * - `pindex`: The [`PackageIndex`] to write.
+     * - `path`: The path to write the cache file to. Its parent directory will be created if it does not exist.
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `pindex` points to NULL, or `path` does not point to a valud UTF-8 string.
+     */
+    Error* (*pindex_write_cache)(PackageIndex* pindex, const char* path);
+
+    /* Constructs a new [`DataIndex`] that lists the datasets in a local directory (i.e., without contacting any instance).
+     * 
+     * # Arguments
+     * - `datasets_dir`: The directory to read the datasets from. It is expected to be laid out as `<name>/data.yml`.
+     * - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `datasets_dir` does not point to a valud UTF-8 string.
+     */
+    Error* (*dindex_new_local)(const char* datasets_dir, DataIndex** dindex);
+
+    /* Constructs a new [`DataIndex`] from a local cache file written by [`dindex_write_cache()`] or by [`dindex_new_remote_cached()`] (which use the same format).
+     * 
+     * The file simply holds the index as JSON. It saves contacting the instance, but every process that loads it still reads and parses it in full.
+     * 
+     * # Arguments
+     * - `path`: The path to the cache file.
+     * - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `path` does not point to a valud UTF-8 string.
+     */
+    Error* (*dindex_read_cache)(const char* path, DataIndex** dindex);
+
+    /* Writes the given [`DataIndex`] to a local cache file (as JSON), such that it can be loaded later using [`dindex_read_cache()`] without contacting the instance.
+     * 
+     * The file is written to a temporary file first and then moved into place, so that processes loading it concurrently never see a partial file.
+     * 
+     * # Arguments
+     * - `dindex`: The [`DataIndex`] to write.
+     * - `path`: The path to write the cache file to. Its parent directory will be created if it does not exist.
+     * 
+     * # Returns
+     * [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+     * 
+     * # Panics
+     * This function can panic if the given `dindex` points to NULL, or `path` does not point to a valud UTF-8 string.
+     */
+    Error* (*dindex_write_cache)(DataIndex* dindex, const char* path);
+
+    /* Returns the kind of the given [`FullValue`], so that it can be read with the matching accessor without serializing it.
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to inspect.
+     * 
+     * # Returns
+     * The [`FullValueKind`] of `fvalue`.
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    FullValueKind (*fvalue_kind)(const FullValue* fvalue);
+
+    /* Reads the given [`FullValue`] as a boolean.
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `value`: Will be set to the boolean value if `fvalue` is a [`FullValue::Boolean`]. Left untouched otherwise.
+     * 
+     * # Returns
+     * Whether `fvalue` was a [`FullValue::Boolean`].
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    bool (*fvalue_get_bool)(const FullValue* fvalue, bool* value);
+
+    /* Reads the given [`FullValue`] as an integer.
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `value`: Will be set to the integer value if `fvalue` is a [`FullValue::Integer`]. Left untouched otherwise.
+     * 
+     * # Returns
+     * Whether `fvalue` was a [`FullValue::Integer`].
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    bool (*fvalue_get_int)(const FullValue* fvalue, int64_t* value);
+
+    /* Reads the given [`FullValue`] as a real.
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `value`: Will be set to the real value if `fvalue` is a [`FullValue::Real`]. Left untouched otherwise.
+     * 
+     * # Returns
+     * Whether `fvalue` was a [`FullValue::Real`].
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    bool (*fvalue_get_real)(const FullValue* fvalue, double* value);
+
+    /* Reads the given [`FullValue`] as a string, without copying it.
+     * 
+     * Next to [`FullValue::String`]s, this also reads the identifier of [`FullValue::Data`]s and [`FullValue::IntermediateResult`]s.
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `value`: Will point to the string if `fvalue` has one. Note that it is _not_ null-terminated, and only valid for as long as `fvalue` is. Left untouched otherwise.
+     * - `len`: Will be set to the length of `value`, in bytes. Left untouched if `fvalue` has no string.
+     * 
+     * # Returns
+     * Whether `fvalue` was a [`FullValue::String`], [`FullValue::Data`] or [`FullValue::IntermediateResult`].
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    bool (*fvalue_get_string)(const FullValue* fvalue, const char** value, size_t* len);
+
+    /* Reads the name of the class of the given [`FullValue`] if it is an instance, without copying it.
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `name`: Will point to the name of the class if `fvalue` is a [`FullValue::Instance`]. Note that it is _not_ null-terminated, and only valid for as long as `fvalue` is. Left untouched otherwise.
+     * - `len`: Will be set to the length of `name`, in bytes. Left untouched if `fvalue` is not an instance.
+     * 
+     * # Returns
+     * Whether `fvalue` was a [`FullValue::Instance`].
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    bool (*fvalue_get_class)(const FullValue* fvalue, const char** name, size_t* len);
+
+    /* Reads the number of elements in the given [`FullValue`] if it is an array.
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `len`: Will be set to the number of elements if `fvalue` is a [`FullValue::Array`]. Left untouched otherwise.
+     * 
+     * # Returns
+     * Whether `fvalue` was a [`FullValue::Array`].
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    bool (*fvalue_array_len)(const FullValue* fvalue, size_t* len);
+
+    /* Returns a view of an element of the given [`FullValue`] if it is an array, without copying it.
+     * 
+     * # Safety
+     * The returned [`FullValue`] is borrowed from `fvalue`. It is only valid for as long as `fvalue` is, and must _not_ be freed using [`fvalue_free()`].
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `index`: The index of the element to return.
+     * 
+     * # Returns
+     * The element at `index`, or [`NULL`] if `fvalue` is not a [`FullValue::Array`] or `index` is out-of-bounds.
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer.
+     */
+    const FullValue* (*fvalue_array_get)(const FullValue* fvalue, size_t index);
+
+    /* Returns a view of a field of the given [`FullValue`] if it is an instance, without copying it.
+     * 
+     * # Safety
+     * The returned [`FullValue`] is borrowed from `fvalue`. It is only valid for as long as `fvalue` is, and must _not_ be freed using [`fvalue_free()`].
+     * 
+     * # Arguments
+     * - `fvalue`: The [`FullValue`] to read.
+     * - `name`: The name of the field to return.
+     * 
+     * # Returns
+     * The value of the field called `name`, or [`NULL`] if `fvalue` is not a [`FullValue::Instance`] or has no such field.
+     * 
+     * # Panics
+     * This function can panic if the given `fvalue` is a NULL-pointer, or if `name` did not point to a valid UTF-8 string.
+     */
+    const FullValue* (*fvalue_field)(const FullValue* fvalue, const char* name);
+
+    /* Returns the number of warnings and errors in a source error, which can be read one-by-one using [`serror_get()`].
+     * 
+     * # Arguments
+     * - `serr`: The [`SourceError`] struct to inspect.
+     * 
+     * # Returns
+     * The number of warnings plus the number of errors.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` is a NULL-pointer.
+     */
+    size_t (*serror_count)(SourceError* serr);
+
+    /* Reads a single warning or error of a source error as a structured [`Diagnostic`], such that the host can render it itself.
+     * 
+     * The warnings come first, followed by the errors. Any custom message (see [`serror_has_err()`]) is not included.
+     * 
+     * The first call for a given `serr` collects all of its diagnostics at once; any subsequent ones are cheap.
+     * 
+     * # Arguments
+     * - `serr`: The [`SourceError`] struct to read.
+     * - `index`: The index of the diagnostic to read. Must be lower than [`serror_count()`].
+     * - `diag`: The [`Diagnostic`] to fill in. Its strings are owned by `serr`. Left untouched if `index` is out-of-bounds.
+     * 
+     * # Returns
+     * Whether `index` was in bounds.
+     * 
+     * # Panics
+     * This function can panic if the given `serr` or `diag` is a NULL-pointer.
+     */
+    bool (*serror_get)(SourceError* serr, size_t index, Diagnostic* diag);
+
+    /* Sets whether the driver may re-use an earlier plan of the same workflow instead of planning it again.
+     * 
+     * Plans are only re-used within this VM's session, and only while the instance's infrastructure does not change and the plan is not too old. The checkers are still asked about every run, since planning is where they normally see a workflow. Use [`vm_plan_cached()`] to find out if the last run used a cached plan.
+     * 
+     * Has no effect for VMs that run locally, since these do not plan.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] to configure.
+     * - `enabled`: Whether to ask for cached plans. Disabled by default.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` pointed to a NULL-pointer.
+     */
+    void (*vm_set_plan_cache)(VirtualMachine* vm, bool enabled);
+
+    /* Returns whether the last workflow run with [`vm_run()`] (or [`vm_run_profiled()`] and [`vm_run_with_deadline()`]) re-used a cached plan.
+     * 
+     * Runs in the background (e.g., [`vm_run_async()`]) do not update this.
+     * 
+     * # Arguments
+     * - `vm`: The [`VirtualMachine`] to query.
+     * 
+     * # Returns
+     * True if the driver re-used an earlier plan (see [`vm_set_plan_cache()`]), or false if the workflow was planned again, has not run yet or ran locally.
+     * 
+     * # Panics
+     * This function may panic if the input `vm` pointed to a NULL-pointer.
+     */
+    bool (*vm_plan_cached)(VirtualMachine* vm);
+
+    /* Constructor for the VmPool.
+     * 
+     * Creates `size` virtual machines in the same way as [`vm_new()`], which share the given indices and all connections to the driver.
+     * 
+     * # Arguments
+     * - `api_endpoint`: The Brane API endpoint to connect to to download available registries and all that.
+     * - `drv_endpoint`: The BRANE driver endpoint to connect to to execute stuff.
+     * - `certs_dir`: The directory where certificates for downloading datasets are stored.
+     * - `pindex`: The [`PackageIndex`] to resolve package references in the snippets with.
+     * - `dindex`: The [`DataIndex`] to resolve dataset references in the snippets with.
+     * - `size`: The number of virtual machines in the pool, i.e., how many calls can run at the same time. Must be at least 1.
+     * - `pool`: Will point to the newly created [`VmPool`] when done. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function can panic if the given `pindex` or `dindex` are NULL, or if the given `api_endpoint`, `drv_endpoint` or `certs_dir` do not point to a valid UTF-8 string.
+     */
+    Error* (*vmpool_new)(const char* api_endpoint, const char* drv_endpoint, const char* certs_dir, PackageIndex* pindex, DataIndex* dindex, size_t size, VmPool** pool);
+
+    /* Destructor for the VmPool.
+     * 
+     * # Safety
+     * You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+     * 
+     * Unlike the other `vmpool_*()` functions, this function must not be called while any other thread is still using the pool.
+     * 
+     * # Arguments
+     * - `pool`: The [`VmPool`] to free.
+     */
+    void (*vmpool_free)(VmPool* pool);
+
+    /* Runs the given code snippet on one of the pool's virtual machines.
+     * 
+     * This is the same as [`vm_run()`], except that it may be called from many threads at the same time. If all of the pool's virtual machines are in use, it blocks until one of them is returned.
+     * 
+     * The snippet runs in the session of whichever virtual machine is free, so it must not depend on the definitions of earlier snippets (see [`VmPool`]).
+     * 
+     * # Arguments
+     * - `pool`: The [`VmPool`] to take a virtual machine from.
+     * - `workflow`: The compiled workflow to execute.
+     * - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below).
+     * - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function may panic if the input `pool` or `workflow` pointed to a NULL-pointer.
+     */
+    Error* (*vmpool_run)(VmPool* pool, Workflow* workflow, char** prints, FullValue** result);
+
+    /* Processes the result referred to by the [`FullValue`] using one of the pool's virtual machines.
+     * 
+     * This is the same as [`vm_process()`], except that it may be called from many threads at the same time. If all of the pool's virtual machines are in use, it blocks until one of them is returned.
+     * 
+     * # Arguments
+     * - `pool`: The [`VmPool`] to take a virtual machine from.
+     * - `result`: The [`FullValue`] which we will attempt to download if needed.
+     * - `data_dir`: The directory to download the result to. This should be the generic data directory: the dataset is extracted to `<data_dir>/<name>/data` (next to a `data.yml` describing it), which is also where [`fvalue_serialize()`] says it is.
+     * 
+     * # Returns
+     * An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+     * 
+     * # Panics
+     * This function may panic if the input `pool` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+     */
+    Error* (*vmpool_process)(VmPool* pool, FullValue* result, const char* data_dir);
+};
+typedef struct _functions Functions;
+
+/* The number of function pointers in the [`Functions`]-struct. */
+#define BRANE_CLI_FUNCTIONS ((sizeof(Functions) - offsetof(Functions, version)) / sizeof(void*))
+
+
+
 
 
 /***** FUNCTIONS *****/
 /* Loads the [`Functions`]-struct dynamically from the given .so file.
+ * 
+ * If the library exports `brane_cli_get_vtable()`, all functions are copied from its function table in one go. Otherwise (i.e., for older libraries), every function is looked up separately.
+ * 
+ * Either way, a library may be older than this header. Any function that it does not have is set to NULL instead of failing the load, so callers have to check the functions added since 3.0.0 before using them. Only a library that lacks one of the functions that 3.0.0 already exported fails to load.
  * 
  * # Arguments
  * - `path`: The path to the .so file to load.
@@ -526,15 +1785,37 @@ Functions* functions_load(const char* path) {
 
     // Attempt to load the dlopen handle
     state->handle = dlopen(path, RTLD_LAZY);
-    if (state->handle == NULL) { fprintf(stderr, "Failed to load dynamic library '%s': %s\n", path, dlerror()); return NULL; }
-
-    // Load the separate-function symbols
+    if (state->handle == NULL) { fprintf(stderr, "Failed to load dynamic library '%s': %s\n", path, dlerror()); free(state); return NULL; }
+
+    // Prefer taking everything from the library's function table, if it has one that is recent enough
+    const FunctionTable* (*get_vtable)(uint32_t) = (const FunctionTable* (*)(uint32_t)) dlsym(state->handle, "brane_cli_get_vtable");
+    if (get_vtable != NULL) {
+        const FunctionTable* table = get_vtable(BRANE_CLI_ABI_VERSION);
+        if (table != NULL) {
+            // Take what the library has; anything it is too old for stays NULL
+            size_t len = table->len < BRANE_CLI_FUNCTIONS ? table->len : BRANE_CLI_FUNCTIONS;
+            memset(&state->version, 0, BRANE_CLI_FUNCTIONS * sizeof(void*));
+            memcpy(&state->version, table->functions, len * sizeof(void*));
+            return state;
+        }
+    }
+
+    // Otherwise, load the separate-function symbols. Only the ones that libraries without a function table (i.e., 3.0.0) export are required; anything added since stays NULL if the library does not have it
     LOAD_SYMBOL(version, const char* (*)());
     LOAD_SYMBOL(set_force_colour, void (*)(bool));
+    LOAD_OPTIONAL_SYMBOL(set_log_level, void (*)(uint32_t));
+    LOAD_OPTIONAL_SYMBOL(set_log_sink, void (*)(LogCallback, void*));
+    LOAD_OPTIONAL_SYMBOL(runtime_configure, Error* (*)(size_t, size_t));
+    LOAD_OPTIONAL_SYMBOL(driver_pool_configure, void (*)(size_t));
+    LOAD_OPTIONAL_SYMBOL(metrics_snapshot, void (*)(Metrics*));
+    LOAD_OPTIONAL_SYMBOL(metrics_serialize, char* (*)());
+    LOAD_OPTIONAL_SYMBOL(metrics_reset, void (*)());
 
     // Load the error symbols
     LOAD_SYMBOL(error_free, void (*)(Error*));
     LOAD_SYMBOL(error_serialize_err, void (*)(Error*, char**));
+    LOAD_OPTIONAL_SYMBOL(error_serialize_err_into, size_t (*)(Error*, char*, size_t));
+    LOAD_OPTIONAL_SYMBOL(error_view_err, const char* (*)(Error*, size_t*));
     LOAD_SYMBOL(error_print_err, void (*)(Error*));
 
     // Load the source error symbols
@@ -545,39 +1826,108 @@ Functions* functions_load(const char* path) {
     LOAD_SYMBOL(serror_serialize_swarns, void (*)(SourceError*, char**));
     LOAD_SYMBOL(serror_serialize_serrs, void (*)(SourceError*, char**));
     LOAD_SYMBOL(serror_serialize_err, void (*)(SourceError*, char**));
+    LOAD_OPTIONAL_SYMBOL(serror_serialize_swarns_into, size_t (*)(SourceError*, char*, size_t));
+    LOAD_OPTIONAL_SYMBOL(serror_view_swarns, const char* (*)(SourceError*, size_t*));
+    LOAD_OPTIONAL_SYMBOL(serror_serialize_serrs_into, size_t (*)(SourceError*, char*, size_t));
+    LOAD_OPTIONAL_SYMBOL(serror_view_serrs, const char* (*)(SourceError*, size_t*));
+    LOAD_OPTIONAL_SYMBOL(serror_serialize_err_into, size_t (*)(SourceError*, char*, size_t));
+    LOAD_OPTIONAL_SYMBOL(serror_view_err, const char* (*)(SourceError*, size_t*));
     LOAD_SYMBOL(serror_print_swarns, void (*)(SourceError*));
     LOAD_SYMBOL(serror_print_serrs, void (*)(SourceError*));
     LOAD_SYMBOL(serror_print_err, void (*)(SourceError*));
 
     // Load the index symbols
     LOAD_SYMBOL(pindex_new_remote, Error* (*)(const char*, PackageIndex**));
+    LOAD_OPTIONAL_SYMBOL(pindex_new_remote_cached, Error* (*)(const char*, const char*, uint64_t, PackageIndex**));
     LOAD_SYMBOL(pindex_free, void (*)(PackageIndex*));
     LOAD_SYMBOL(dindex_new_remote, Error* (*)(const char*, DataIndex**));
+    LOAD_OPTIONAL_SYMBOL(dindex_new_remote_cached, Error* (*)(const char*, const char*, uint64_t, DataIndex**));
     LOAD_SYMBOL(dindex_free, void (*)(DataIndex*));
 
     // Load the workflow symbols
     LOAD_SYMBOL(workflow_free, void (*)(Workflow*));
     LOAD_SYMBOL(workflow_set_user, void (*)(Workflow*, const char*));
     LOAD_SYMBOL(workflow_disassemble, Error* (*)(Workflow*, char**));
+    LOAD_OPTIONAL_SYMBOL(workflow_disassemble_into, Error* (*)(Workflow*, char*, size_t, size_t*));
+    LOAD_OPTIONAL_SYMBOL(workflow_clone, Workflow* (*)(Workflow*));
+    LOAD_OPTIONAL_SYMBOL(workflow_bind, Error* (*)(Workflow*, const char*, FullValue*));
+    LOAD_OPTIONAL_SYMBOL(workflow_bind_dataset, Error* (*)(Workflow*, const char*, const char*));
 
     // Load the compiler symbols
     LOAD_SYMBOL(compiler_new, Error* (*)(PackageIndex*, DataIndex*, Compiler**));
     LOAD_SYMBOL(compiler_free, void (*)(Compiler*));
     LOAD_SYMBOL(compiler_compile, SourceError* (*)(Compiler*, const char*, const char*, Workflow**));
+    LOAD_OPTIONAL_SYMBOL(compiler_compile_batch, void (*)(const Compiler*, const char* const*, const char* const*, size_t, Workflow**, SourceError**));
+    LOAD_OPTIONAL_SYMBOL(compiler_cache_stats, void (*)(uint64_t*, uint64_t*, size_t*));
+    LOAD_OPTIONAL_SYMBOL(compiler_cache_clear, void (*)());
 
     // Load the FullValue symbols
     LOAD_SYMBOL(fvalue_free, void (*)(FullValue*));
     LOAD_SYMBOL(fvalue_needs_processing, bool (*)(FullValue*));
     LOAD_SYMBOL(fvalue_serialize, void (*)(FullValue*, const char*, char**));
+    LOAD_OPTIONAL_SYMBOL(fvalue_serialize_into, size_t (*)(FullValue*, const char*, char*, size_t));
+
+    // Load the Profile symbols
+    LOAD_OPTIONAL_SYMBOL(profile_free, void (*)(Profile*));
+    LOAD_OPTIONAL_SYMBOL(profile_len, size_t (*)(Profile*));
+    LOAD_OPTIONAL_SYMBOL(profile_entry_name, const char* (*)(Profile*, size_t));
+    LOAD_OPTIONAL_SYMBOL(profile_entry_depth, size_t (*)(Profile*, size_t));
+    LOAD_OPTIONAL_SYMBOL(profile_entry_is_scope, bool (*)(Profile*, size_t));
+    LOAD_OPTIONAL_SYMBOL(profile_entry_nanos, uint64_t (*)(Profile*, size_t));
+    LOAD_OPTIONAL_SYMBOL(profile_total_nanos, uint64_t (*)(Profile*));
+    LOAD_OPTIONAL_SYMBOL(profile_serialize, void (*)(Profile*, char**));
 
     // Load the VM symbols
     LOAD_SYMBOL(vm_new, Error* (*)(const char*, const char*, const char*, PackageIndex*, DataIndex*, VirtualMachine**));
+    LOAD_OPTIONAL_SYMBOL(vm_new_offline, Error* (*)(const char*, bool, VirtualMachine**));
+    LOAD_OPTIONAL_SYMBOL(vm_new_dummy, Error* (*)(VirtualMachine**));
     LOAD_SYMBOL(vm_free, void (*)(VirtualMachine*));
+    LOAD_OPTIONAL_SYMBOL(vm_set_output_callback, void (*)(VirtualMachine*, OutputCallback, void*));
+    LOAD_OPTIONAL_SYMBOL(vm_set_index_ttl, void (*)(VirtualMachine*, uint64_t));
     LOAD_SYMBOL(vm_run, Error* (*)(VirtualMachine*, Workflow*, char**, FullValue**));
+    LOAD_OPTIONAL_SYMBOL(vm_run_profiled, Error* (*)(VirtualMachine*, Workflow*, char**, FullValue**, Profile**));
+    LOAD_OPTIONAL_SYMBOL(vm_run_with_deadline, Error* (*)(VirtualMachine*, Workflow*, uint64_t, char**, FullValue**));
+    LOAD_OPTIONAL_SYMBOL(vm_cancel, void (*)(VirtualMachine*));
     LOAD_SYMBOL(vm_process, Error* (*)(VirtualMachine*, FullValue*, const char*));
+    LOAD_OPTIONAL_SYMBOL(vm_process_ex, Error* (*)(VirtualMachine*, FullValue*, const char*, const ProcessOptions*));
+    LOAD_OPTIONAL_SYMBOL(vm_process_many, Error* (*)(VirtualMachine*, const FullValue* const*, size_t, const char*));
+    LOAD_OPTIONAL_SYMBOL(vm_run_async, Error* (*)(VirtualMachine*, Workflow*, RunCallback, void*, RunHandle**));
+    LOAD_OPTIONAL_SYMBOL(vm_run_poll, bool (*)(RunHandle*));
+    LOAD_OPTIONAL_SYMBOL(vm_run_wait, Error* (*)(RunHandle*, char**, FullValue**));
+    LOAD_OPTIONAL_SYMBOL(runhandle_free, void (*)(RunHandle*));
+    LOAD_OPTIONAL_SYMBOL(vm_run_batch, Error* (*)(VirtualMachine*, Workflow* const*, size_t, size_t, BatchCallback, void*));
+    LOAD_OPTIONAL_SYMBOL(pindex_new_local, Error* (*)(const char*, PackageIndex**));
+    LOAD_OPTIONAL_SYMBOL(pindex_read_cache, Error* (*)(const char*, PackageIndex**));
+    LOAD_OPTIONAL_SYMBOL(pindex_write_cache, Error* (*)(PackageIndex*, const char*));
+    LOAD_OPTIONAL_SYMBOL(dindex_new_local, Error* (*)(const char*, DataIndex**));
+    LOAD_OPTIONAL_SYMBOL(dindex_read_cache, Error* (*)(const char*, DataIndex**));
+    LOAD_OPTIONAL_SYMBOL(dindex_write_cache, Error* (*)(DataIndex*, const char*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_kind, FullValueKind (*)(const FullValue*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_get_bool, bool (*)(const FullValue*, bool*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_get_int, bool (*)(const FullValue*, int64_t*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_get_real, bool (*)(const FullValue*, double*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_get_string, bool (*)(const FullValue*, const char**, size_t*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_get_class, bool (*)(const FullValue*, const char**, size_t*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_array_len, bool (*)(const FullValue*, size_t*));
+    LOAD_OPTIONAL_SYMBOL(fvalue_array_get, const FullValue* (*)(const FullValue*, size_t));
+    LOAD_OPTIONAL_SYMBOL(fvalue_field, const FullValue* (*)(const FullValue*, const char*));
+    LOAD_OPTIONAL_SYMBOL(serror_count, size_t (*)(SourceError*));
+    LOAD_OPTIONAL_SYMBOL(serror_get, bool (*)(SourceError*, size_t, Diagnostic*));
+    LOAD_OPTIONAL_SYMBOL(vm_set_plan_cache, void (*)(VirtualMachine*, bool));
+    LOAD_OPTIONAL_SYMBOL(vm_plan_cached, bool (*)(VirtualMachine*));
+    LOAD_OPTIONAL_SYMBOL(vmpool_new, Error* (*)(const char*, const char*, const char*, PackageIndex*, DataIndex*, size_t, VmPool**));
+    LOAD_OPTIONAL_SYMBOL(vmpool_free, void (*)(VmPool*));
+    LOAD_OPTIONAL_SYMBOL(vmpool_run, Error* (*)(VmPool*, Workflow*, char**, FullValue**));
+    LOAD_OPTIONAL_SYMBOL(vmpool_process, Error* (*)(VmPool*, FullValue*, const char*));
 
     // Done
     return state;
+
+failed:
+    // Don't leak the handle or the struct if any symbol was missing
+    dlclose(state->handle);
+    free(state);
+    return NULL;
 }
 /* Destroys the [`Functions`]-struct, unloading all the symbols within.
  * 
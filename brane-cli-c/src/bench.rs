@@ -0,0 +1,189 @@
+//  BENCH.rs
+//    by Lut99
+//
+//  Created:
+//    14 Oct 2026, 21:28:15
+//  Last edited:
+//    14 Oct 2026, 21:28:15
+//  Auto updated?
+//    Yes
+//
+//  Description:
+//!   Benchmarks for the hot paths of the library: compiling snippets,
+//!   disassembling them, running them on a dummy VM and serializing their
+//!   results, for snippets from tiny to very large.
+//!
+//!   These are not run by default. Run them with:
+//!   ```bash
+//!   cargo test --release -p brane-cli-c bench:: -- --ignored --nocapture
+//!   ```
+//!   Every (operation, size) pair is reported as a JSON object on a line of
+//!   its own, followed by the library's own metrics (see
+//!   `metrics_serialize()`). The `BENCH_SIZES` (comma-separated, default
+//!   `1,10,100,1000`) and `BENCH_ITERATIONS` (default `20`) environment
+//!   variables tune what is measured.
+//
+
+use std::fmt::Write as _;
+
+use super::*;
+
+
+/***** CONSTANTS *****/
+/// The snippet sizes measured if `BENCH_SIZES` is not given.
+const DEFAULT_SIZES: [usize; 4] = [1, 10, 100, 1000];
+/// The number of times every operation is measured per size if `BENCH_ITERATIONS` is not given.
+const DEFAULT_ITERATIONS: usize = 20;
+
+
+
+
+
+/***** HELPER FUNCTIONS *****/
+/// Generates a snippet of the given size.
+///
+/// Every unit of size adds a class with a method, a function, and two variables using them, such that both the definition table and the function bodies grow with it. The snippet returns an array with one value per unit.
+///
+/// # Arguments
+/// - `size`: The number of units in the snippet.
+///
+/// # Returns
+/// The BraneScript source of the snippet.
+fn snippet(size: usize) -> String {
+    let mut raw: String = String::new();
+    for i in 0..size {
+        writeln!(raw, "class C{i} {{\n    value: int;\n\n    func get(self) {{\n        return self.value;\n    }}\n}}").unwrap();
+        writeln!(raw, "func f{i}(x) {{\n    return x + {i};\n}}").unwrap();
+        writeln!(raw, "let c{i} := new C{i} {{ value := {i} }};\nlet v{i} := f{i}(c{i}.get());").unwrap();
+    }
+    writeln!(raw, "return [{}];", (0..size).map(|i| format!("v{i}")).collect::<Vec<String>>().join(", ")).unwrap();
+    raw
+}
+
+/// Reads a setting from the environment.
+///
+/// # Arguments
+/// - `name`: The name of the environment variable.
+/// - `default`: The value to use if it is not given.
+/// - `parse`: Parses the value of the environment variable.
+///
+/// # Returns
+/// The parsed value, or `default` if it was not given.
+///
+/// # Panics
+/// This function panics if the variable is given but cannot be parsed.
+fn setting<T>(name: &str, default: T, parse: impl FnOnce(&str) -> Option<T>) -> T {
+    match std::env::var(name) {
+        Ok(raw) => parse(&raw).unwrap_or_else(|| panic!("Illegal value '{raw}' for {name}")),
+        Err(_) => default,
+    }
+}
+
+/// Reports the latencies measured for one operation on one snippet size as a line of JSON.
+///
+/// # Arguments
+/// - `op`: The name of the operation.
+/// - `size`: The size of the snippet (see [`snippet()`]).
+/// - `bytes`: The length of the snippet's source, in bytes.
+/// - `samples`: The measured latencies. Must not be empty.
+fn report(op: &str, size: usize, bytes: usize, mut samples: Vec<Duration>) {
+    samples.sort();
+    let us = |d: Duration| d.as_secs_f64() * 1e6;
+    let total: Duration = samples.iter().sum();
+    let mean: f64 = us(total) / samples.len() as f64;
+    println!(
+        "{}",
+        serde_json::json!({
+            "op": op,
+            "size": size,
+            "bytes": bytes,
+            "iterations": samples.len(),
+            "mean_us": mean,
+            "min_us": us(samples[0]),
+            "p50_us": us(samples[samples.len() / 2]),
+            "p90_us": us(samples[(samples.len() * 9 / 10).min(samples.len() - 1)]),
+            "max_us": us(samples[samples.len() - 1]),
+            "bytes_per_sec": if mean > 0.0 { bytes as f64 / mean * 1e6 } else { 0.0 },
+        })
+    );
+}
+
+
+
+
+
+/***** BENCHMARKS *****/
+/// Measures [`compiler_compile()`], [`workflow_disassemble()`], [`vm_run()`] (on a dummy VM) and [`fvalue_serialize()`] for every snippet size.
+///
+/// Every snippet is compiled on a fresh [`Compiler`] with an empty compile cache, so what is measured is the size of the snippet, not what earlier snippets left behind.
+#[test]
+#[ignore]
+fn bench_snippet_sizes() {
+    let sizes: Vec<usize> =
+        setting("BENCH_SIZES", DEFAULT_SIZES.to_vec(), |raw| raw.split(',').map(|size| size.trim().parse().ok()).collect::<Option<Vec<usize>>>());
+    let iters: usize = setting("BENCH_ITERATIONS", DEFAULT_ITERATIONS, |raw| raw.parse().ok().filter(|iters| *iters > 0));
+    let pindex: Arc<ArcSwap<PackageIndex>> = Arc::new(ArcSwap::from_pointee(PackageIndex::empty()));
+    let dindex: Arc<ArcSwap<DataIndex>> = Arc::new(ArcSwap::from_pointee(DataIndex::from_infos(vec![]).unwrap()));
+    let dir: TempDir = TempDir::new().unwrap();
+    let data_dir: CString = CString::new(dir.path().to_string_lossy().as_bytes()).unwrap();
+    let what: CString = CString::new("bench").unwrap();
+
+    metrics_reset();
+    for size in sizes {
+        let raw: CString = CString::new(snippet(size)).unwrap();
+        let bytes: usize = raw.as_bytes().len();
+        let (mut compile, mut disassemble, mut run, mut serialize): (Vec<Duration>, Vec<Duration>, Vec<Duration>, Vec<Duration>) =
+            (vec![], vec![], vec![], vec![]);
+        for _ in 0..iters {
+            unsafe {
+                let mut compiler: *mut Compiler = std::ptr::null_mut();
+                assert!(compiler_new(&pindex, &dindex, &mut compiler).is_null());
+                let mut vm: *mut VirtualMachine = std::ptr::null_mut();
+                assert!(vm_new_dummy(&mut vm).is_null());
+                compiler_cache_clear();
+
+                let start: Instant = Instant::now();
+                let mut workflow: *mut Workflow = std::ptr::null_mut();
+                let serr: *const SourceError = compiler_compile(compiler, what.as_ptr(), raw.as_ptr(), &mut workflow);
+                compile.push(start.elapsed());
+                assert!(!serror_has_err(serr), "Failed to compile snippet of size {size}");
+                serror_free(serr as *mut SourceError);
+
+                let start: Instant = Instant::now();
+                let mut assembly: *mut c_char = std::ptr::null_mut();
+                assert!(workflow_disassemble(workflow, &mut assembly).is_null());
+                disassemble.push(start.elapsed());
+                libc::free(assembly as *mut c_void);
+
+                let start: Instant = Instant::now();
+                let mut prints: *mut c_char = std::ptr::null_mut();
+                let mut result: *mut FullValue = std::ptr::null_mut();
+                assert!(vm_run(vm, workflow, &mut prints, &mut result).is_null());
+                run.push(start.elapsed());
+                libc::free(prints as *mut c_void);
+
+                let start: Instant = Instant::now();
+                let mut value: *mut c_char = std::ptr::null_mut();
+                fvalue_serialize(result, data_dir.as_ptr(), &mut value);
+                serialize.push(start.elapsed());
+                libc::free(value as *mut c_void);
+
+                fvalue_free(result);
+                workflow_free(workflow);
+                vm_free(vm);
+                compiler_free(compiler);
+            }
+        }
+        report("compile", size, bytes, compile);
+        report("disassemble", size, bytes, disassemble);
+        report("run", size, bytes, run);
+        report("serialize", size, bytes, serialize);
+    }
+
+    // Finally, the library's own view of things
+    unsafe {
+        let metrics: *mut c_char = metrics_serialize();
+        println!("{{\"op\":\"metrics\",\"metrics\":{}}}", CStr::from_ptr(metrics).to_string_lossy());
+        libc::free(metrics as *mut c_void);
+    }
+}
@@ -4,7 +4,7 @@
 //  Created:
 //    14 Jun 2023, 17:38:09
 //  Last edited:
-//    04 Mar 2024, 13:33:55
+//    14 Oct 2026, 21:47:23
 //  Auto updated?
 //    Yes
 //
@@ -16,39 +16,382 @@
 //!   http://blog.asleson.org/2021/02/23/how-to-writing-a-c-shared-library-in-rust/
 //
 
-use std::cell::{RefCell, RefMut};
-use std::collections::HashMap;
-use std::ffi::{CStr, CString};
+use std::collections::{HashMap, HashSet, VecDeque};
+use std::ffi::{c_void, CStr, CString};
+use std::future::Future;
 use std::fmt::Write as _;
 use std::io::Write;
 use std::mem;
 use std::os::raw::c_char;
-use std::path::PathBuf;
-use std::rc::Rc;
-use std::sync::{Arc, Once};
-use std::time::Instant;
-
-use brane_ast::ast::Workflow;
+use std::path::{Path, PathBuf};
+use std::ptr::{addr_of, addr_of_mut};
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, Once, OnceLock, Weak};
+use std::time::{Duration, Instant, SystemTime};
+
+use arc_swap::ArcSwap;
+use brane_ast::ast::{generate_random_workflow_id, Edge, EdgeInstr, Workflow};
+use brane_ast::errors::SourceLines;
 use brane_ast::state::CompileState;
 use brane_ast::traversals::print::ast;
-use brane_ast::{CompileResult, Error as AstError, ParserOptions, Warning as AstWarning};
-use brane_cli::data::download_data;
-use brane_cli::run::{initialize_instance, run_instance, InstanceVmState};
+use brane_ast::{CompileResult, DataType, Error as AstError, ParserOptions, Warning as AstWarning};
+use brane_cli::data::{download_data_cached, DownloadOptions};
+use brane_cli::run::{initialize_instance_with_client, initialize_offline_vm, run_instance, run_instance_profiled, InstanceVmState, OfflineVmState};
+use brane_cli::vm::OfflineVm;
+use brane_exe::dummy::DummyVm;
 use brane_exe::FullValue;
 use brane_tsk::api::{get_data_index, get_package_index};
+use brane_tsk::docker::{ClientVersion, DockerOptions, API_DEFAULT_VERSION};
+use brane_tsk::local::{get_data_index as get_local_data_index, get_package_index as get_local_package_index};
 use console::style;
 use humanlog::{DebugMode, HumanLogger};
-use log::{debug, error, info, trace, warn};
-use parking_lot::{Mutex, MutexGuard};
-use specifications::data::{AccessKind, DataIndex};
-use specifications::package::PackageIndex;
+use log::{debug, error, info, trace, warn, LevelFilter, Log, Metadata, Record};
+use parking_lot::{Condvar, Mutex, MutexGuard, RwLock, RwLockReadGuard};
+use specifications::data::{AccessKind, DataIndex, DataInfo, DataName};
+use specifications::driving::DriverServiceClient;
+use specifications::package::{PackageIndex, PackageInfo};
+use specifications::profiling::{ProfileEntry, ProfileScope};
+use tempfile::{NamedTempFile, TempDir};
 use tokio::runtime::{Builder, Runtime};
+use tokio::sync::{watch, Mutex as AsyncMutex};
+use tokio::task::{JoinHandle, JoinSet};
+
+
+/***** TESTS *****/
+#[cfg(test)]
+mod tests {
+    use specifications::package::PackageKind;
+    use specifications::version::Version;
+
+    use super::*;
+
+
+    /// Returns fresh, empty index snapshots to compile against.
+    fn indices() -> (Arc<PackageIndex>, Arc<DataIndex>) { (Arc::new(PackageIndex::empty()), Arc::new(DataIndex::from_infos(vec![]).unwrap())) }
+
+    #[test]
+    fn test_compile_cache_hit() {
+        let (pindex, dindex): (Arc<PackageIndex>, Arc<DataIndex>) = indices();
+        let raw: &str = "println(\"test_compile_cache_hit\");";
+
+        let (first, _) = compile_unit_cached(&mut CompileState::new(), &SourceStore::default(), "test", raw, &pindex, &dindex);
+        let (second, _) = compile_unit_cached(&mut CompileState::new(), &SourceStore::default(), "test", raw, &pindex, &dindex);
+        let (first, second): (Workflow, Workflow) = (first.unwrap(), second.unwrap());
+        let key: CompileKey = CompileKey { raw: raw.into(), pindex: Arc::as_ptr(&pindex) as usize, dindex: Arc::as_ptr(&dindex) as usize };
+        assert!(COMPILE_CACHE.lock().as_ref().unwrap().entries.contains_key(&key));
+
+        // A hit is the same workflow, but a different submission
+        assert_ne!(first.id, second.id);
+        assert!(Arc::ptr_eq(&first.graph, &second.graph));
+    }
+
+    #[test]
+    fn test_compile_cache_key() {
+        let (pindex, dindex): (Arc<PackageIndex>, Arc<DataIndex>) = indices();
+        let raw: &str = "println(\"test_compile_cache_key\");";
+        let (first, _) = compile_unit_cached(&mut CompileState::new(), &SourceStore::default(), "test", raw, &pindex, &dindex);
+
+        // A new index snapshot is a miss, even if it has the same contents
+        let (pindex2, _): (Arc<PackageIndex>, Arc<DataIndex>) = indices();
+        let (second, _) = compile_unit_cached(&mut CompileState::new(), &SourceStore::default(), "test", raw, &pindex2, &dindex);
+        assert!(!Arc::ptr_eq(&first.unwrap().graph, &second.unwrap().graph));
+
+        // So is compiling on top of earlier snippets
+        let mut state: CompileState = CompileState::new();
+        let source: SourceStore = SourceStore::default();
+        compile_unit_cached(&mut state, &source, "test", "let test_compile_cache_key := 42;", &pindex, &dindex).0.unwrap();
+        let key: CompileKey = CompileKey { raw: raw.into(), pindex: Arc::as_ptr(&pindex) as usize, dindex: Arc::as_ptr(&dindex) as usize };
+        let cached: Arc<Vec<Edge>> = COMPILE_CACHE.lock().as_ref().unwrap().entries[&key].workflow.graph.clone();
+        let (third, _) = compile_unit_cached(&mut state, &source, "test", raw, &pindex, &dindex);
+        assert!(!Arc::ptr_eq(&cached, &third.unwrap().graph));
+    }
+
+    #[test]
+    fn test_compile_cache_eviction() {
+        let mut cache: CompileCache = CompileCache::default();
+        let (pindex, dindex): (Arc<PackageIndex>, Arc<DataIndex>) = indices();
+        let (workflow, _) = compile_unit(&mut CompileState::new(), &SourceStore::default(), "test", "println(\"test\");", &pindex, &dindex);
+        let workflow: Workflow = workflow.unwrap();
+        let entry = |pindex: &Arc<PackageIndex>| CompileEntry {
+            workflow: workflow.clone(),
+            state:    CompileState::new(),
+            pindex:   Arc::downgrade(pindex),
+            dindex:   Arc::downgrade(&dindex),
+        };
+
+        // Fill the cache with entries for a snapshot that is then dropped
+        let dropped: Arc<PackageIndex> = Arc::new(PackageIndex::empty());
+        for i in 0..COMPILE_CACHE_CAPACITY {
+            cache.insert(CompileKey { raw: i.to_string(), pindex: Arc::as_ptr(&dropped) as usize, dindex: 0 }, entry(&dropped));
+        }
+        assert_eq!(cache.entries.len(), COMPILE_CACHE_CAPACITY);
+        drop(dropped);
+
+        // The next insert removes all of them, since they can never be hit again
+        cache.insert(CompileKey { raw: "alive".into(), pindex: Arc::as_ptr(&pindex) as usize, dindex: 0 }, entry(&pindex));
+        assert_eq!(cache.entries.len(), 1);
+        assert_eq!(cache.order.len(), 1);
+
+        // Live entries are evicted oldest-first
+        for i in 0..COMPILE_CACHE_CAPACITY {
+            cache.insert(CompileKey { raw: i.to_string(), pindex: Arc::as_ptr(&pindex) as usize, dindex: 0 }, entry(&pindex));
+        }
+        assert_eq!(cache.entries.len(), COMPILE_CACHE_CAPACITY);
+        assert!(!cache.entries.contains_key(&CompileKey { raw: "alive".into(), pindex: Arc::as_ptr(&pindex) as usize, dindex: 0 }));
+    }
+
+
+
+    /// A [`BatchCallback`] that records which workflows completed, and whether they succeeded, in the `Mutex<Vec<(usize, bool)>>` given as `user_data`.
+    unsafe extern "C" fn collect_batch(user_data: *mut c_void, index: usize, err: *mut Error, prints: *mut c_char, result: *mut FullValue) {
+        let seen: &Mutex<Vec<(usize, bool)>> = &*(user_data as *const Mutex<Vec<(usize, bool)>>);
+        seen.lock().push((index, err.is_null()));
+        if !err.is_null() {
+            error_free(err);
+        }
+        if !prints.is_null() {
+            libc::free(prints as *mut c_void);
+        }
+        if !result.is_null() {
+            fvalue_free(result);
+        }
+    }
+
+    #[test]
+    fn test_vm_run_batch_errors() {
+        let (pindex, dindex): (Arc<PackageIndex>, Arc<DataIndex>) = indices();
+        let compile = |raw: &str| compile_unit(&mut CompileState::new(), &SourceStore::default(), "test", raw, &pindex, &dindex).0.unwrap();
+        let workflows: Vec<Workflow> = vec![compile("println(\"ok\");"), compile("let a := [1]; println(a[5]);"), compile("println(\"ok\");")];
+        let ptrs: Vec<*const Workflow> = workflows.iter().map(|wf| wf as *const Workflow).collect();
+
+        unsafe {
+            let mut vm: *mut VirtualMachine = std::ptr::null_mut();
+            assert!(vm_new_dummy(&mut vm).is_null());
+
+            // Every workflow is reported exactly once, including the one that fails
+            let seen: Mutex<Vec<(usize, bool)>> = Mutex::new(vec![]);
+            let err: *const Error = vm_run_batch(vm, ptrs.as_ptr(), ptrs.len(), 2, Some(collect_batch), &seen as *const _ as *mut c_void);
+            assert!(!err.is_null());
+            assert_eq!((*err).msg, "1 out of 3 workflow(s) failed");
+            error_free(err as *mut Error);
+            let mut seen: Vec<(usize, bool)> = seen.into_inner();
+            seen.sort();
+            assert_eq!(seen, vec![(0, true), (1, false), (2, true)]);
+
+            vm_free(vm);
+        }
+    }
+
+    #[test]
+    fn test_index_cache_roundtrip() {
+        let dir: TempDir = TempDir::new().unwrap();
+        let pindex_path: CString = CString::new(dir.path().join("nested/packages.json").to_string_lossy().as_bytes()).unwrap();
+        let dindex_path: CString = CString::new(dir.path().join("data.json").to_string_lossy().as_bytes()).unwrap();
+        let package: PackageInfo = PackageInfo::new(
+            "test".into(),
+            Version::new(1, 0, 0),
+            PackageKind::Ecu,
+            vec![],
+            "A package".into(),
+            false,
+            HashMap::new(),
+            HashMap::new(),
+        );
+
+        unsafe {
+            // Write the cache files (twice, to overwrite an existing one) and leave no temporary files behind
+            let pindex: *mut Arc<ArcSwap<PackageIndex>> =
+                Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(PackageIndex::from_packages(vec![package.clone()]).unwrap()))));
+            let dindex: *mut Arc<ArcSwap<DataIndex>> =
+                Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(DataIndex::from_infos(vec![]).unwrap()))));
+            for _ in 0..2 {
+                assert!(pindex_write_cache(pindex, pindex_path.as_ptr()).is_null());
+                assert!(dindex_write_cache(dindex, dindex_path.as_ptr()).is_null());
+            }
+            pindex_free(pindex);
+            dindex_free(dindex);
+            assert_eq!(std::fs::read_dir(dir.path().join("nested")).unwrap().count(), 1);
+            assert_eq!(std::fs::read_dir(dir.path()).unwrap().count(), 2);
+
+            // Load them back
+            let mut pindex: *mut Arc<ArcSwap<PackageIndex>> = std::ptr::null_mut();
+            let mut dindex: *mut Arc<ArcSwap<DataIndex>> = std::ptr::null_mut();
+            assert!(pindex_read_cache(pindex_path.as_ptr(), &mut pindex).is_null());
+            assert!(dindex_read_cache(dindex_path.as_ptr(), &mut dindex).is_null());
+            let loaded: Arc<PackageIndex> = (*pindex).load_full();
+            let info: &PackageInfo = loaded.get("test", Some(&Version::new(1, 0, 0))).unwrap();
+            assert_eq!((info.id, &info.description), (package.id, &package.description));
+            assert_eq!((*dindex).load().iter().count(), 0);
+            pindex_free(pindex);
+            dindex_free(dindex);
+
+            // A missing cache file is an error, not an empty index
+            let missing: CString = CString::new(dir.path().join("missing.json").to_string_lossy().as_bytes()).unwrap();
+            let err: *const Error = pindex_read_cache(missing.as_ptr(), &mut pindex);
+            assert!(!err.is_null() && pindex.is_null());
+            error_free(err as *mut Error);
+        }
+    }
+
+    #[test]
+    fn test_serror_crlf() {
+        let pindex: Arc<ArcSwap<PackageIndex>> = Arc::new(ArcSwap::from_pointee(PackageIndex::empty()));
+        let dindex: Arc<ArcSwap<DataIndex>> = Arc::new(ArcSwap::from_pointee(DataIndex::from_infos(vec![]).unwrap()));
+        let what: CString = CString::new("test").unwrap();
+        let raw: CString = CString::new("let a := 1;\r\nprintln(b);\r\n").unwrap();
+
+        unsafe {
+            let mut compiler: *mut Compiler = std::ptr::null_mut();
+            assert!(compiler_new(&pindex, &dindex, &mut compiler).is_null());
+            let mut workflow: *mut Workflow = std::ptr::null_mut();
+            let serr: *const SourceError = compiler_compile(compiler, what.as_ptr(), raw.as_ptr(), &mut workflow);
+            assert!(serror_has_serrs(serr));
+
+            // The line of the error is given without its line ending, both to the host and when rendered
+            let mut diag: Diagnostic = std::mem::zeroed();
+            assert!(serror_get(serr, serror_count(serr) - 1, &mut diag));
+            assert_eq!((diag.line, CStr::from_ptr(diag.source_line).to_str().unwrap()), (2, "println(b);"));
+            let mut len: usize = 0;
+            let view: *const c_char = serror_view_serrs(serr, &mut len);
+            assert!(!std::slice::from_raw_parts(view as *const u8, len).contains(&b'\r'));
+
+            serror_free(serr as *mut SourceError);
+            compiler_free(compiler);
+        }
+    }
+
+
+
+    /// Returns the instruction right before the one that assigns the given top-level variable in the main body, i.e., its initializer.
+    fn initializer(workflow: &Workflow, name: &str) -> EdgeInstr {
+        for edge in workflow.graph.iter() {
+            if let Edge::Linear { instrs, .. } = edge {
+                for i in 1..instrs.len() {
+                    if matches!(instrs[i], EdgeInstr::VarSet { def } if workflow.table.vars[def].name == name) {
+                        return instrs[i - 1].clone();
+                    }
+                }
+            }
+        }
+        panic!("Workflow has no top-level variable '{name}'");
+    }
+
+    /// Returns all string literals in the given edges.
+    fn strings(edges: &[Edge]) -> Vec<String> {
+        let mut strings: Vec<String> = vec![];
+        for edge in edges {
+            if let Edge::Linear { instrs, .. } = edge {
+                strings.extend(instrs.iter().filter_map(|instr| if let EdgeInstr::String { value } = instr { Some(value.clone()) } else { None }));
+            }
+        }
+        strings
+    }
+
+    #[test]
+    fn test_bind_param() {
+        let (pindex, dindex): (Arc<PackageIndex>, Arc<DataIndex>) = indices();
+        let raw: &str = "let n := 1;\nlet r := 1.5;\nlet s := \"a\";\nlet b := false;\nlet sum := 1 + 2;\nlet twice := 1;\ntwice := 2;\nprintln(n);";
+        let mut workflow: Workflow = compile_unit(&mut CompileState::new(), &SourceStore::default(), "test", raw, &pindex, &dindex).0.unwrap();
+
+        // Literals of the same type are replaced, and integers may replace reals
+        bind_param(&mut workflow, "n", &FullValue::Integer(42)).unwrap();
+        bind_param(&mut workflow, "r", &FullValue::Integer(3)).unwrap();
+        bind_param(&mut workflow, "s", &FullValue::String("b".into())).unwrap();
+        bind_param(&mut workflow, "b", &FullValue::Boolean(true)).unwrap();
+        assert!(matches!(initializer(&workflow, "n"), EdgeInstr::Integer { value: 42 }));
+        assert!(matches!(initializer(&workflow, "r"), EdgeInstr::Real { value } if value == 3.0));
+        assert!(matches!(initializer(&workflow, "s"), EdgeInstr::String { value } if value == "b"));
+        assert!(matches!(initializer(&workflow, "b"), EdgeInstr::Boolean { value: true }));
+        bind_param(&mut workflow, "r", &FullValue::Real(2.5)).unwrap();
+        assert!(matches!(initializer(&workflow, "r"), EdgeInstr::Real { value } if value == 2.5));
+
+        // Anything else is refused and leaves the workflow as it was
+        assert!(bind_param(&mut workflow, "n", &FullValue::String("42".into())).unwrap_err().starts_with("Cannot bind"));
+        assert!(bind_param(&mut workflow, "n", &FullValue::Real(4.2)).unwrap_err().starts_with("Cannot bind"));
+        assert!(bind_param(&mut workflow, "sum", &FullValue::Integer(4)).unwrap_err().ends_with("is not assigned a literal"));
+        assert!(bind_param(&mut workflow, "twice", &FullValue::Integer(4)).unwrap_err().ends_with("is assigned 2 times"));
+        assert!(bind_param(&mut workflow, "missing", &FullValue::Integer(4)).unwrap_err().starts_with("Workflow has no top-level variable"));
+        assert!(matches!(initializer(&workflow, "n"), EdgeInstr::Integer { value: 42 }));
+
+        // Copies are not affected
+        unsafe {
+            let copy: *mut Workflow = workflow_clone(&workflow);
+            let name: CString = CString::new("n").unwrap();
+            let value: FullValue = FullValue::Integer(7);
+            assert!(workflow_bind(copy, name.as_ptr(), &value).is_null());
+            assert!(matches!(initializer(&*copy, "n"), EdgeInstr::Integer { value: 7 }));
+            assert!(matches!(initializer(&workflow, "n"), EdgeInstr::Integer { value: 42 }));
+            workflow_free(copy);
+        }
+    }
+
+    #[test]
+    fn test_rename_dataset() {
+        let (pindex, _): (Arc<PackageIndex>, Arc<DataIndex>) = indices();
+        let dindex: Arc<DataIndex> = Arc::new(
+            DataIndex::from_infos(vec![DataInfo {
+                name:        "in".into(),
+                owners:      None,
+                description: None,
+                created:     Default::default(),
+                access:      HashMap::from([("localhost".into(), AccessKind::File { path: "/data/in".into() })]),
+            }])
+            .unwrap(),
+        );
+        let raw: &str = "let d := new Data { name := \"in\" };\nfunc load() {\n    return new Data { name := \"in\" };\n}\nlet e := load();";
+        let workflow: Workflow = compile_unit(&mut CompileState::new(), &SourceStore::default(), "test", raw, &pindex, &dindex).0.unwrap();
+        let data_class: Option<usize> = workflow.table.classes.iter().position(|class| class.name == "Data" && class.package.is_none());
+        assert!(data_class.is_some());
+
+        // Edges that do not mention the dataset are not copied
+        assert!(rename_dataset(&workflow.graph, data_class, "other", "out").is_none());
+        assert!(rename_dataset(&workflow.graph, None, "in", "out").is_none());
+
+        unsafe {
+            // The dataset is renamed in the main body and in the function bodies of the copy
+            let copy: *mut Workflow = workflow_clone(&workflow);
+            let (from, to): (CString, CString) = (CString::new("in").unwrap(), CString::new("out").unwrap());
+            assert!(workflow_bind_dataset(copy, from.as_ptr(), to.as_ptr()).is_null());
+            assert_eq!(strings(&(*copy).graph), vec!["out"]);
+            let bodies: Vec<Vec<String>> = (*copy).funcs.values().map(|edges| strings(edges)).filter(|strings| !strings.is_empty()).collect();
+            assert_eq!(bodies, vec![vec!["out"]]);
+
+            // ...but not in the original
+            assert_eq!(strings(&workflow.graph), vec!["in"]);
+            let bodies: Vec<Vec<String>> = workflow.funcs.values().map(|edges| strings(edges)).filter(|strings| !strings.is_empty()).collect();
+            assert_eq!(bodies, vec![vec!["in"]]);
+
+            // A dataset that is not used is an error
+            let err: *const Error = workflow_bind_dataset(copy, from.as_ptr(), to.as_ptr());
+            assert!(!err.is_null());
+            assert_eq!((*err).msg, "Workflow does not use dataset 'in'");
+            error_free(err as *mut Error);
+            workflow_free(copy);
+        }
+    }
+}
+
+
+
+
+
+/***** BENCHMARKS *****/
+#[cfg(test)]
+mod bench;
+
+
+
 
 
 /***** CONSTANTS *****/
 /// The version string of this package, null-terminated for C-compatibility.
 static C_VERSION: &str = concat!(env!("CARGO_PKG_VERSION"), "\0");
 
+/// The version of the layout of the [`FunctionTable`] returned by [`brane_cli_get_vtable()`].
+///
+/// It is bumped whenever existing entries of the table move or change signature. Appending new functions does not bump it, since hosts can see those from the table's length.
+const ABI_VERSION: u32 = 1;
+
 
 
 
@@ -56,10 +399,47 @@ static C_VERSION: &str = concat!(env!("CARGO_PKG_VERSION"), "\0");
 /***** GLOBALS *****/
 /// Ensures that the initialization function is run only once.
 static LOG_INIT: Once = Once::new();
+/// The host callback that log records are routed to instead of the terminal, if any. Can be changed with [`set_log_sink()`].
+static LOG_SINK: RwLock<Option<LogSink>> = RwLock::new(None);
 
 /// Handle to the shared tokio runtime that is ref-counted among all compilers and virtual machines
 /// We do it this wacky way to ensure deallocation of the runtime when the last compiler/vm gets free'd, while still re-using the same one on every new().
 static RUNTIME: Mutex<Option<Arc<Runtime>>> = Mutex::new(None);
+/// The configuration with which the shared tokio runtime is built the next time it is initialized. Can be changed with [`runtime_configure()`].
+static RUNTIME_CONFIG: Mutex<RuntimeConfig> = Mutex::new(RuntimeConfig { worker_threads: 1, max_blocking: 0 });
+
+/// The maximum number of compiled workflows kept in the [`COMPILE_CACHE`].
+const COMPILE_CACHE_CAPACITY: usize = 256;
+/// Process-wide cache of workflows compiled from a fresh compile state, shared by all compilers. Initialized on first use.
+static COMPILE_CACHE: Mutex<Option<CompileCache>> = Mutex::new(None);
+/// The number of compilations answered from the [`COMPILE_CACHE`].
+static COMPILE_CACHE_HITS: AtomicU64 = AtomicU64::new(0);
+/// The number of cacheable compilations that had to go through the compiler.
+static COMPILE_CACHE_MISSES: AtomicU64 = AtomicU64::new(0);
+
+/// Process-wide pool of connections to drivers, keyed by endpoint and shared by all virtual machines. Initialized on first use, and emptied when the runtime that drives the connections is dropped.
+static DRIVER_POOL: Mutex<Option<HashMap<String, Vec<PooledDriver>>>> = Mutex::new(None);
+/// The maximum number of workflows that run over a single connection in the [`DRIVER_POOL`] at the same time. `0` means unlimited. Can be changed with [`driver_pool_configure()`].
+static DRIVER_POOL_MAX_STREAMS: AtomicUsize = AtomicUsize::new(16);
+/// How long a connection in the [`DRIVER_POOL`] that no virtual machine or run uses is kept around before it is closed.
+const DRIVER_POOL_IDLE_TIMEOUT: Duration = Duration::from_secs(60);
+
+/// The number of (power-of-two) latency buckets kept per operation in the metrics.
+const METRICS_BUCKETS: usize = 40;
+/// Metrics about compiling snippets (see [`compiler_compile()`] and [`compiler_compile_batch()`]).
+static METRICS_COMPILE: OpCounters = OpCounters::new();
+/// Metrics about running workflows (see [`vm_run()`] and [`vm_run_async()`]).
+static METRICS_RUN: OpCounters = OpCounters::new();
+/// Metrics about downloading datasets (see [`vm_process()`] and [`vm_process_many()`]).
+static METRICS_DOWNLOAD: OpCounters = OpCounters::new();
+/// Metrics about downloading package indices.
+static METRICS_PINDEX: OpCounters = OpCounters::new();
+/// Metrics about downloading data indices.
+static METRICS_DINDEX: OpCounters = OpCounters::new();
+/// Metrics about disassembling workflows (see [`workflow_disassemble()`]).
+static METRICS_DISASSEMBLE: OpCounters = OpCounters::new();
+/// Metrics about serializing values (see [`fvalue_serialize()`]).
+static METRICS_SERIALIZE: OpCounters = OpCounters::new();
 
 
 
@@ -67,12 +447,17 @@ static RUNTIME: Mutex<Option<Arc<Runtime>>> = Mutex::new(None);
 
 /***** HELPER FUNCTIONS *****/
 /// Initializes the logging system if it hadn't already.
+///
+/// Records are written to the terminal until the host installs a sink with [`set_log_sink()`]. Only debug records and up are enabled until the host changes it with [`set_log_level()`].
 #[inline]
 fn init_logger() {
     LOG_INIT.call_once(|| {
-        if let Err(err) = HumanLogger::terminal(DebugMode::Debug).init() {
+        let logger: LibLogger = LibLogger { terminal: HumanLogger::terminal(DebugMode::Debug) };
+        if let Err(err) = log::set_boxed_logger(Box::new(logger)) {
             eprintln!("WARNING: Failed to setup Rust logger: {err} (logging disabled for this session)");
+            return;
         }
+        log::set_max_level(LevelFilter::Debug);
     });
 }
 
@@ -93,8 +478,20 @@ fn init_runtime() -> Result<Arc<Runtime>, std::io::Error> {
         // Return the downgraded reference to it
         Ok(rt.clone())
     } else {
-        // Spawn a new runtime and set it globally
-        let runtime: Arc<Runtime> = Arc::new(Builder::new_current_thread().enable_io().enable_time().build()?);
+        // Spawn a new runtime and set it globally. We use a multi-threaded one so that workflows submitted with `vm_run_async()` make progress without the host driving the runtime.
+        let config: RuntimeConfig = *RUNTIME_CONFIG.lock();
+        let mut builder: Builder = Builder::new_multi_thread();
+        if config.worker_threads > 0 {
+            builder.worker_threads(config.worker_threads);
+        }
+        if config.max_blocking > 0 {
+            builder.max_blocking_threads(config.max_blocking);
+        }
+        debug!(
+            "Initializing Tokio runtime with {} worker thread(s)...",
+            if config.worker_threads > 0 { config.worker_threads.to_string() } else { "default".into() }
+        );
+        let runtime: Arc<Runtime> = Arc::new(builder.thread_name("brane-cli-c").enable_io().enable_time().build()?);
         *rt = Some(runtime.clone());
         Ok(runtime)
     }
@@ -110,9 +507,210 @@ fn cleanup_runtime() {
 
     // Delete it if necessary
     if sc == 1 {
+        // Any pooled driver connections are tied to the runtime, so they have to go too
+        *DRIVER_POOL.lock() = None;
         *rt = None;
     }
 }
+/// Gives up a share of the global runtime from within one of its tasks, cleaning up the runtime if nothing else uses it anymore.
+///
+/// The runtime cannot be dropped on one of its own threads, so if it has to go, that is done on a new thread instead.
+///
+/// # Arguments
+/// - `runtime`: The share of the global runtime to give up.
+fn release_runtime(runtime: Arc<Runtime>) {
+    // Drop it while holding the lock, such that either we see that ours was the last share, or whoever drops the last one after us does (see `cleanup_runtime()`)
+    let last: bool = {
+        let rt: MutexGuard<Option<Arc<Runtime>>> = RUNTIME.lock();
+        drop(runtime);
+        rt.as_ref().map(|rt| Arc::strong_count(rt) == 1).unwrap_or(false)
+    };
+    if last {
+        std::thread::spawn(cleanup_runtime);
+    }
+}
+
+/// Takes a connection to the given driver from the [`DRIVER_POOL`], if there is one with room for another stream.
+///
+/// Connections that have been idle for longer than [`DRIVER_POOL_IDLE_TIMEOUT`] are closed along the way.
+///
+/// # Arguments
+/// - `endpoint`: The address of the driver to find a connection to.
+/// - `stream`: Whether the connection is taken for a workflow run, which has to fit in the stream limit and counts against it until the returned [`DriverLease`] is dropped.
+///
+/// # Returns
+/// A [`DriverServiceClient`] sharing the least busy pooled connection that has room, and a [`DriverLease`] that marks the connection as in use for as long as it lives. [`None`] if no connection has room.
+fn checkout_driver(endpoint: &str, stream: bool) -> Option<(DriverServiceClient, DriverLease)> {
+    let max_streams: usize = DRIVER_POOL_MAX_STREAMS.load(Ordering::Relaxed);
+    let mut pool: MutexGuard<Option<HashMap<String, Vec<PooledDriver>>>> = DRIVER_POOL.lock();
+    let conns: &mut Vec<PooledDriver> = pool.as_mut()?.get_mut(endpoint)?;
+
+    // Close the connections nobody has used in a while (well, forget them; clients still referring to them keep them open)
+    let before: usize = conns.len();
+    conns.retain(|conn| conn.users() > 0 || conn.last_used.elapsed() < DRIVER_POOL_IDLE_TIMEOUT);
+    if conns.len() < before {
+        debug!("Closed {} idle pooled connection(s) to driver '{}'", before - conns.len(), endpoint);
+    }
+
+    // Find the least busy connection that still has room
+    let conn: &mut PooledDriver = conns
+        .iter_mut()
+        .filter(|conn| !stream || max_streams == 0 || conn.streams.load(Ordering::Relaxed) < max_streams)
+        .min_by_key(|conn| conn.streams.load(Ordering::Relaxed))?;
+    debug!("Re-using pooled connection to driver '{}' ({} running workflow(s))", endpoint, conn.streams.load(Ordering::Relaxed));
+    conn.last_used = Instant::now();
+    Some((conn.client.clone(), conn.lease(stream)))
+}
+
+/// Adds a new connection to the [`DRIVER_POOL`].
+///
+/// # Arguments
+/// - `endpoint`: The address of the driver that the connection is to.
+/// - `client`: The [`DriverServiceClient`] that owns the connection.
+/// - `stream`: Whether the connection is taken for a workflow run (see [`checkout_driver()`]).
+///
+/// # Returns
+/// A [`DriverLease`] that marks the connection as in use for as long as it lives.
+fn pool_driver(endpoint: &str, client: DriverServiceClient, stream: bool) -> DriverLease {
+    let conn: PooledDriver = PooledDriver { client, lease: Arc::new(()), streams: Arc::new(AtomicUsize::new(0)), last_used: Instant::now() };
+    let lease: DriverLease = conn.lease(stream);
+    DRIVER_POOL.lock().get_or_insert_with(HashMap::new).entry(endpoint.into()).or_default().push(conn);
+    lease
+}
+
+/// Gets a connection to the given driver from the [`DRIVER_POOL`] for a new virtual machine, connecting a new one if there is none.
+///
+/// # Arguments
+/// - `runtime`: The [`Runtime`] on which to connect if necessary.
+/// - `endpoint`: The address of the driver to connect to.
+///
+/// # Returns
+/// A [`DriverServiceClient`] sharing the pooled connection, and a [`DriverLease`] that marks the connection as in use for as long as it lives.
+///
+/// # Errors
+/// This function errors if we had to connect to the driver but failed to do so.
+fn acquire_driver(runtime: &Runtime, endpoint: &str) -> Result<(DriverServiceClient, DriverLease), specifications::driving::Error> {
+    if let Some(conn) = checkout_driver(endpoint, false) {
+        return Ok(conn);
+    }
+
+    // Otherwise, connect a new one (without holding the lock while we do)
+    debug!("Opening new pooled connection to driver '{}'...", endpoint);
+    let client: DriverServiceClient = runtime.block_on(DriverServiceClient::connect(endpoint))?;
+    Ok((client.clone(), pool_driver(endpoint, client, false)))
+}
+
+/// Gets a connection to the given driver from the [`DRIVER_POOL`] to run a workflow on, connecting a new one if all of them are running as many workflows as allowed.
+///
+/// # Arguments
+/// - `endpoint`: The address of the driver to connect to.
+///
+/// # Returns
+/// A [`DriverServiceClient`] sharing the pooled connection, and a [`DriverLease`] that counts the run against the connection's stream limit for as long as it lives.
+///
+/// # Errors
+/// This function errors if we had to connect to the driver but failed to do so.
+async fn acquire_stream(endpoint: &str) -> Result<(DriverServiceClient, DriverLease), specifications::driving::Error> {
+    if let Some(conn) = checkout_driver(endpoint, true) {
+        return Ok(conn);
+    }
+
+    // Otherwise, connect a new one (without holding the lock while we do)
+    debug!("All pooled connections to driver '{}' are busy; opening a new one...", endpoint);
+    let client: DriverServiceClient = DriverServiceClient::connect(endpoint).await?;
+    Ok((client.clone(), pool_driver(endpoint, client, true)))
+}
+
+/// Computes the path of the on-disk cache file for an index downloaded from the given endpoint.
+///
+/// # Arguments
+/// - `cache_dir`: The directory where the cached indices live.
+/// - `kind`: Some identifier for the kind of index (e.g., `pindex` or `dindex`).
+/// - `endpoint`: The endpoint from which the index is downloaded.
+///
+/// # Returns
+/// The path to the cache file, which may or may not exist.
+#[inline]
+fn index_cache_path(cache_dir: &Path, kind: &str, endpoint: &str) -> PathBuf {
+    let endpoint: String = endpoint.chars().map(|c| if c.is_ascii_alphanumeric() { c } else { '_' }).collect();
+    cache_dir.join(format!("{kind}-{endpoint}.json"))
+}
+
+/// Reads an index from the on-disk cache, but only if it is younger than the given age.
+///
+/// # Arguments
+/// - `path`: The path of the cache file to read.
+/// - `max_age`: The maximum age of the cache file before we consider it stale.
+///
+/// # Returns
+/// The raw contents of the cache file, or [`None`] if it did not exist, was stale or could not be read.
+fn read_index_cache(path: &Path, max_age: Duration) -> Option<String> {
+    // Check how old the file is
+    let modified: SystemTime = match std::fs::metadata(path).and_then(|md| md.modified()) {
+        Ok(modified) => modified,
+        Err(_) => {
+            debug!("No cached index '{}' found", path.display());
+            return None;
+        },
+    };
+    if SystemTime::now().duration_since(modified).map(|age| age > max_age).unwrap_or(false) {
+        debug!("Cached index '{}' is stale", path.display());
+        return None;
+    }
+
+    // Read it
+    match std::fs::read_to_string(path) {
+        Ok(raw) => Some(raw),
+        Err(err) => {
+            warn!("Failed to read cached index '{}': {} (ignoring cache)", path.display(), err);
+            None
+        },
+    }
+}
+
+/// Writes the given bytes to a file by writing a uniquely named temporary file next to it first and then moving it over, so that concurrent readers never see half a file and concurrent writers never write to the same temporary file.
+///
+/// # Arguments
+/// - `path`: The path of the file to write.
+/// - `raw`: The contents to write.
+///
+/// # Errors
+/// This function errors if we failed to create the parent directory, or to write or move the temporary file. The error is already formatted as a message.
+fn write_atomically(path: &Path, raw: &[u8]) -> Result<(), String> {
+    let dir: &Path = match path.parent() {
+        Some(dir) if !dir.as_os_str().is_empty() => dir,
+        _ => Path::new("."),
+    };
+    if let Err(err) = std::fs::create_dir_all(dir) {
+        return Err(format!("Failed to create directory '{}': {}", dir.display(), err));
+    }
+
+    // Write to a temporary file first, then move it over
+    let mut tmp: NamedTempFile = match NamedTempFile::new_in(dir) {
+        Ok(tmp) => tmp,
+        Err(err) => return Err(format!("Failed to create temporary file in '{}': {}", dir.display(), err)),
+    };
+    if let Err(err) = tmp.write_all(raw) {
+        return Err(format!("Failed to write '{}': {}", tmp.path().display(), err));
+    }
+    if let Err(err) = tmp.persist(path) {
+        return Err(format!("Failed to move '{}' to '{}': {}", err.file.path().display(), path.display(), err.error));
+    }
+    Ok(())
+}
+
+/// Writes an index to the on-disk cache.
+///
+/// Failing to do so is not fatal; it only emits a warning.
+///
+/// # Arguments
+/// - `path`: The path of the cache file to write.
+/// - `raw`: The serialized index to write.
+fn write_index_cache(path: &Path, raw: &str) {
+    if let Err(err) = write_atomically(path, raw.as_bytes()) {
+        warn!("{err} (not caching index)");
+    }
+}
 
 /// Reads a C-string as a Rust string (or at least, attempts to).
 ///
@@ -158,16 +756,205 @@ unsafe fn rust_to_cstr(string: String) -> *mut c_char {
     target
 }
 
+/// Writes a Rust string to a buffer given by the caller, `snprintf`-style.
+///
+/// At most `len - 1` bytes of the string are written, followed by a null-byte. Note that this may truncate in the middle of a UTF-8 character.
+///
+/// # Arguments
+/// - `string`: The Rust-string to write.
+/// - `buffer`: The buffer to write to. May be [`NULL`] if `len` is 0.
+/// - `len`: The size of the `buffer`, in bytes (including space for the null-byte).
+///
+/// # Returns
+/// The length of the full string (excluding the null-byte). If this is `len` or more, the string was truncated.
+#[inline]
+unsafe fn rust_to_buffer(string: &str, buffer: *mut c_char, len: usize) -> usize {
+    if !buffer.is_null() && len > 0 {
+        let n_chars: usize = string.len().min(len - 1);
+        std::ptr::copy_nonoverlapping(string.as_ptr(), buffer as *mut u8, n_chars);
+        *buffer.add(n_chars) = '\0' as c_char;
+    }
+    string.len()
+}
+
 
 
 
 
 /***** HELPER STRUCTS *****/
+/// Defines the parameters with which the shared tokio runtime is built.
+#[derive(Clone, Copy, Debug)]
+struct RuntimeConfig {
+    /// The number of worker threads to spawn. `0` means one per CPU core.
+    worker_threads: usize,
+    /// The maximum number of threads spawned for blocking operations. `0` means the tokio default.
+    max_blocking:   usize,
+}
+
+/// Defines the lock-free counters kept for a single kind of operation.
+///
+/// Latencies are kept in an HDR-style histogram of power-of-two buckets, such that recording is a handful of relaxed atomic operations.
+#[derive(Debug)]
+struct OpCounters {
+    /// The number of operations recorded.
+    calls:    AtomicU64,
+    /// The number of operations that failed.
+    errors:   AtomicU64,
+    /// The summed latency of all operations, in microseconds.
+    total_us: AtomicU64,
+    /// The highest latency of any operation, in microseconds.
+    max_us:   AtomicU64,
+    /// Bucket `i` counts the operations that took less than `2^i` microseconds (but not less than `2^(i - 1)`). The last bucket also counts anything slower.
+    buckets:  [AtomicU64; METRICS_BUCKETS],
+}
+impl OpCounters {
+    /// Constructor for the OpCounters that initializes everything to zero.
+    const fn new() -> Self {
+        #[allow(clippy::declare_interior_mutable_const)]
+        const ZERO: AtomicU64 = AtomicU64::new(0);
+        Self { calls: ZERO, errors: ZERO, total_us: ZERO, max_us: ZERO, buckets: [ZERO; METRICS_BUCKETS] }
+    }
+
+    /// Records a single operation.
+    ///
+    /// # Arguments
+    /// - `elapsed`: How long the operation took.
+    /// - `ok`: Whether the operation succeeded.
+    fn record(&self, elapsed: Duration, ok: bool) {
+        let us: u64 = elapsed.as_micros().min(u64::MAX as u128) as u64;
+        let bucket: usize = ((u64::BITS - us.leading_zeros()) as usize).min(METRICS_BUCKETS - 1);
+        self.calls.fetch_add(1, Ordering::Relaxed);
+        if !ok {
+            self.errors.fetch_add(1, Ordering::Relaxed);
+        }
+        self.total_us.fetch_add(us, Ordering::Relaxed);
+        self.max_us.fetch_max(us, Ordering::Relaxed);
+        self.buckets[bucket].fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// Runs the given function and records it as a single operation.
+    ///
+    /// # Arguments
+    /// - `func`: The operation to run.
+    /// - `ok`: Decides whether the operation succeeded based on its result.
+    ///
+    /// # Returns
+    /// The result of `func`.
+    #[inline]
+    fn measure_with<R>(&self, func: impl FnOnce() -> R, ok: impl FnOnce(&R) -> bool) -> R {
+        let start: Instant = Instant::now();
+        let res: R = func();
+        self.record(start.elapsed(), ok(&res));
+        res
+    }
+
+    /// Runs the given fallible function and records it as a single operation, which failed if it returned an error.
+    ///
+    /// # Arguments
+    /// - `func`: The operation to run.
+    ///
+    /// # Returns
+    /// The result of `func`.
+    #[inline]
+    fn measure<T, E>(&self, func: impl FnOnce() -> Result<T, E>) -> Result<T, E> { self.measure_with(func, Result::is_ok) }
+
+    /// Takes a snapshot of the counters.
+    ///
+    /// Note that the counters are read one-by-one, so operations recorded concurrently may be only partially visible.
+    ///
+    /// # Returns
+    /// A new [`OpMetrics`] with the current values.
+    fn snapshot(&self) -> OpMetrics {
+        let mut metrics: OpMetrics = OpMetrics {
+            calls:    self.calls.load(Ordering::Relaxed),
+            errors:   self.errors.load(Ordering::Relaxed),
+            total_us: self.total_us.load(Ordering::Relaxed),
+            max_us:   self.max_us.load(Ordering::Relaxed),
+            p50_us:   0,
+            p90_us:   0,
+            p99_us:   0,
+            buckets:  [0; METRICS_BUCKETS],
+        };
+        for (i, bucket) in self.buckets.iter().enumerate() {
+            metrics.buckets[i] = bucket.load(Ordering::Relaxed);
+        }
+        metrics.p50_us = metrics.percentile(0.50);
+        metrics.p90_us = metrics.percentile(0.90);
+        metrics.p99_us = metrics.percentile(0.99);
+        metrics
+    }
+
+    /// Resets all counters back to zero.
+    fn reset(&self) {
+        self.calls.store(0, Ordering::Relaxed);
+        self.errors.store(0, Ordering::Relaxed);
+        self.total_us.store(0, Ordering::Relaxed);
+        self.max_us.store(0, Ordering::Relaxed);
+        for bucket in &self.buckets {
+            bucket.store(0, Ordering::Relaxed);
+        }
+    }
+}
+
+/// Defines a single connection in the [`DRIVER_POOL`].
+#[derive(Debug)]
+struct PooledDriver {
+    /// The client that owns the connection. Clones of it share the same underlying channel.
+    client:    DriverServiceClient,
+    /// Shared with every [`DriverLease`] handed out for this connection, such that we can count its users.
+    lease:     Arc<()>,
+    /// The number of workflows currently running over this connection, each of which has a stream open.
+    streams:   Arc<AtomicUsize>,
+    /// When this connection was last handed out.
+    last_used: Instant,
+}
+impl PooledDriver {
+    /// Returns the number of virtual machines and runs currently using this connection.
+    #[inline]
+    fn users(&self) -> usize { Arc::strong_count(&self.lease) - 1 }
+
+    /// Hands out a new [`DriverLease`] for this connection.
+    ///
+    /// # Arguments
+    /// - `stream`: Whether the lease is for a workflow run, which counts against the connection's stream limit until the lease is dropped.
+    #[inline]
+    fn lease(&self, stream: bool) -> DriverLease {
+        let streams: Option<Arc<AtomicUsize>> = stream.then(|| self.streams.clone());
+        if let Some(streams) = &streams {
+            streams.fetch_add(1, Ordering::Relaxed);
+        }
+        DriverLease { _users: self.lease.clone(), streams }
+    }
+}
+
+/// Marks a connection in the [`DRIVER_POOL`] as being in use for as long as it lives.
+#[derive(Debug)]
+struct DriverLease {
+    /// Counts this lease as one of the connection's users.
+    _users:  Arc<()>,
+    /// The stream counter of the connection if this lease is for a workflow run.
+    streams: Option<Arc<AtomicUsize>>,
+}
+impl Drop for DriverLease {
+    #[inline]
+    fn drop(&mut self) {
+        if let Some(streams) = &self.streams {
+            streams.fetch_sub(1, Ordering::Relaxed);
+        }
+    }
+}
+
 /// Defines a [`Write`]-capable, shared handle over a single bytes buffer.
+///
+/// The buffer is thread-safe, such that it can be moved into tasks spawned on the runtime. If an [`OutputSink`] is installed, then writes are forwarded to it as they arrive instead of being buffered.
 #[derive(Clone, Debug)]
 struct BytesHandle {
     /// The shared bytes buffer to write to.
-    buffer: Rc<RefCell<Vec<u8>>>,
+    buffer: Arc<Mutex<Vec<u8>>>,
+    /// The (shared) sink to forward writes to instead, if any.
+    sink:   Arc<Mutex<Option<OutputSink>>>,
+    /// Whether this handle represents stderr (true) or stdout (false). Only relevant when writing to the `sink`.
+    stderr: bool,
 }
 
 impl Default for BytesHandle {
@@ -180,7 +967,30 @@ impl BytesHandle {
     /// # Returns
     /// A new instance of Self that is empty, ready for writing.
     #[inline]
-    pub fn new() -> Self { Self { buffer: Rc::new(RefCell::new(vec![])) } }
+    pub fn new() -> Self { Self::with_sink(Arc::new(Mutex::new(None))) }
+
+    /// Constructor for the StringHandle that forwards to the given (shared) sink if it is set.
+    ///
+    /// # Arguments
+    /// - `sink`: The shared [`OutputSink`] to forward writes to.
+    ///
+    /// # Returns
+    /// A new instance of Self that is empty, ready for writing.
+    #[inline]
+    pub fn with_sink(sink: Arc<Mutex<Option<OutputSink>>>) -> Self { Self { buffer: Arc::new(Mutex::new(vec![])), sink, stderr: false } }
+
+    /// Returns a handle to the same buffer and sink, but that reports its writes as stderr-writes.
+    ///
+    /// # Returns
+    /// A new instance of Self that shares everything with this one except for the stream it represents.
+    #[inline]
+    pub fn as_stderr(&self) -> Self { Self { buffer: self.buffer.clone(), sink: self.sink.clone(), stderr: true } }
+
+    /// Returns the currently installed sink, if any.
+    ///
+    /// We copy it out to avoid holding the lock while calling the host.
+    #[inline]
+    fn current_sink(&self) -> Option<OutputSink> { *self.sink.lock() }
 
     /// Flushes the bytes handle, returning its contents and the resetting them to empty.
     ///
@@ -190,8 +1000,8 @@ impl BytesHandle {
     fn flush_as_bytes(&self) -> Vec<u8> {
         let mut result: Vec<u8> = vec![];
         {
-            // Get a mutable borrow
-            let mut buffer: RefMut<Vec<u8>> = self.buffer.borrow_mut();
+            // Get a lock on the buffer
+            let mut buffer: MutexGuard<Vec<u8>> = self.buffer.lock();
             // Swap the contents with a fresh un
             mem::swap(&mut result, buffer.as_mut());
         }
@@ -212,47 +1022,273 @@ impl BytesHandle {
 }
 impl Write for BytesHandle {
     #[inline]
-    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> { self.buffer.borrow_mut().write(buf) }
+    fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+        match self.current_sink() {
+            Some(sink) => {
+                sink.send(self.stderr, buf);
+                Ok(buf.len())
+            },
+            None => self.buffer.lock().write(buf),
+        }
+    }
 
     #[inline]
-    fn write_all(&mut self, buf: &[u8]) -> std::io::Result<()> { self.buffer.borrow_mut().write_all(buf) }
+    fn write_all(&mut self, buf: &[u8]) -> std::io::Result<()> {
+        match self.current_sink() {
+            Some(sink) => {
+                sink.send(self.stderr, buf);
+                Ok(())
+            },
+            None => self.buffer.lock().write_all(buf),
+        }
+    }
 
     #[inline]
-    fn write_fmt(&mut self, fmt: std::fmt::Arguments<'_>) -> std::io::Result<()> { self.buffer.borrow_mut().write_fmt(fmt) }
+    fn write_fmt(&mut self, fmt: std::fmt::Arguments<'_>) -> std::io::Result<()> {
+        match self.current_sink() {
+            Some(sink) => {
+                // Format it first to give it to the host as a single chunk
+                sink.send(self.stderr, std::fmt::format(fmt).as_bytes());
+                Ok(())
+            },
+            None => self.buffer.lock().write_fmt(fmt),
+        }
+    }
 
     #[inline]
-    fn write_vectored(&mut self, bufs: &[std::io::IoSlice<'_>]) -> std::io::Result<usize> { self.buffer.borrow_mut().write_vectored(bufs) }
+    fn write_vectored(&mut self, bufs: &[std::io::IoSlice<'_>]) -> std::io::Result<usize> {
+        match self.current_sink() {
+            Some(sink) => {
+                let mut n: usize = 0;
+                for buf in bufs {
+                    sink.send(self.stderr, buf);
+                    n += buf.len();
+                }
+                Ok(n)
+            },
+            None => self.buffer.lock().write_vectored(bufs),
+        }
+    }
 
     #[inline]
-    fn flush(&mut self) -> std::io::Result<()> { self.buffer.borrow_mut().flush() }
+    fn flush(&mut self) -> std::io::Result<()> { self.buffer.lock().flush() }
 
     #[inline]
     fn by_ref(&mut self) -> &mut Self { self }
 }
 
 
+/// Identifies a compilation in the [`CompileCache`] by its snippet and the exact index snapshots it was compiled against.
+#[derive(Clone, Debug, Eq, Hash, PartialEq)]
+struct CompileKey {
+    /// The snippet that was compiled.
+    raw:    String,
+    /// The address of the [`PackageIndex`] snapshot used.
+    pindex: usize,
+    /// The address of the [`DataIndex`] snapshot used.
+    dindex: usize,
+}
 
+/// A compilation result remembered by the [`CompileCache`].
+#[derive(Debug)]
+struct CompileEntry {
+    /// The compiled workflow.
+    workflow: Workflow,
+    /// The compile state as it was after compiling the snippet.
+    state:    CompileState,
+    /// Keeps the [`PackageIndex`] snapshot's allocation around, such that its address cannot be re-used by another snapshot while this entry exists.
+    pindex:   Weak<PackageIndex>,
+    /// Keeps the [`DataIndex`] snapshot's allocation around, such that its address cannot be re-used by another snapshot while this entry exists.
+    dindex:   Weak<DataIndex>,
+}
 
-
-/***** LIBRARY FUNCTIONS *****/
-/// Returns the BRANE version for which this compiler is valid.
-///
-/// # Returns
-/// String version that contains a major, minor and patch version separated by dots.
-#[no_mangle]
-pub extern "C" fn version() -> *const c_char {
-    // SAFETY: We can easily do this without a care in the world, since the string is static and won't need deallocation.
-    C_VERSION.as_ptr() as *const c_char
+/// A bounded cache of compiled workflows, evicting the oldest entries first.
+#[derive(Debug, Default)]
+struct CompileCache {
+    /// The cached compilations.
+    entries: HashMap<CompileKey, CompileEntry>,
+    /// The order in which the entries were inserted.
+    order:   VecDeque<CompileKey>,
 }
+impl CompileCache {
+    /// Inserts a new entry into the cache, evicting entries for dropped index snapshots and then the oldest entries to make room.
+    ///
+    /// # Arguments
+    /// - `key`: The [`CompileKey`] to insert the entry under.
+    /// - `entry`: The [`CompileEntry`] to insert.
+    fn insert(&mut self, key: CompileKey, entry: CompileEntry) {
+        // Drop anything compiled against indices that nobody uses anymore (they can never be hit again)
+        if self.order.len() >= COMPILE_CACHE_CAPACITY {
+            let entries: &mut HashMap<CompileKey, CompileEntry> = &mut self.entries;
+            self.order.retain(|key| {
+                let alive: bool = entries.get(key).map(|e| e.pindex.strong_count() > 0 && e.dindex.strong_count() > 0).unwrap_or(false);
+                if !alive {
+                    entries.remove(key);
+                }
+                alive
+            });
+        }
+        while self.order.len() >= COMPILE_CACHE_CAPACITY {
+            if let Some(old) = self.order.pop_front() {
+                self.entries.remove(&old);
+            }
+        }
 
+        // Now insert it
+        if self.entries.insert(key.clone(), entry).is_none() {
+            self.order.push_back(key);
+        }
+    }
+}
 
 
-/// Forces the serialization functions to either use colour or not.
+/// An append-only store for all the source text compiled by a [`Compiler`].
 ///
-/// If you don't call this function, then it depends on whether the backend [`console`] library thinks if the stdout/stderr support ANSI colours.
-///
-/// # Arguments
-/// - `force`: If true, then ANSI characters will be forced to be printed. Otherwise, if false, they will be forced to _not_ be printed.
+/// [`SourceError`]s share it with the compiler that produced them, and only remember how much of the store existed at the time. As such, compiling a snippet only costs the snippet itself instead of a copy of the entire session's source.
+#[derive(Clone, Debug, Default)]
+struct SourceStore(Arc<RwLock<String>>);
+impl SourceStore {
+    /// Adds a new snippet to the end of the store.
+    ///
+    /// # Arguments
+    /// - `raw`: The snippet to add. A newline is appended after it.
+    ///
+    /// # Returns
+    /// A [`SourceView`] that sees all source up to and including the new snippet.
+    #[inline]
+    fn append(&self, raw: &str) -> SourceView {
+        let mut source = self.0.write();
+        source.push_str(raw);
+        source.push('\n');
+        SourceView { store: self.clone(), len: source.len() }
+    }
+}
+
+/// A view on a prefix of a [`SourceStore`], i.e., the source as it was at some point in time.
+#[derive(Clone, Debug)]
+struct SourceView {
+    /// The store to view.
+    store: SourceStore,
+    /// The number of bytes that are part of the view.
+    len:   usize,
+}
+impl SourceView {
+    /// Calls the given closure with the source text in this view.
+    ///
+    /// # Arguments
+    /// - `f`: The closure to call. Note that the store is locked for reading while it runs, so it may not compile anything with the same [`Compiler`].
+    ///
+    /// # Returns
+    /// Whatever the closure returns.
+    #[inline]
+    fn with<R>(&self, f: impl FnOnce(&str) -> R) -> R {
+        let source = self.store.0.read();
+        f(&source[..self.len])
+    }
+}
+
+
+/// Wraps an opaque pointer given to us by the host such that it can be passed to tasks spawned on the runtime.
+///
+/// # Safety
+/// We never dereference the pointer ourselves; we only hand it back to the host's callback. It's up to the host to make sure that whatever it points to may be accessed from another thread.
+#[derive(Clone, Copy, Debug)]
+struct UserData(*mut c_void);
+unsafe impl Send for UserData {}
+
+/// Defines a host callback to which workflow output is forwarded as it arrives.
+#[derive(Clone, Copy, Debug)]
+struct OutputSink {
+    /// The callback to call.
+    callback:  OutputCallback,
+    /// The opaque pointer to give back to the callback.
+    user_data: UserData,
+}
+impl OutputSink {
+    /// Gives a chunk of output to the host.
+    ///
+    /// # Arguments
+    /// - `stderr`: Whether the chunk was written to stderr (true) or stdout (false).
+    /// - `chunk`: The chunk of output to give. It is only borrowed for the duration of the callback.
+    #[inline]
+    fn send(&self, stderr: bool, chunk: &[u8]) {
+        // SAFETY: The host promised us the callback is valid when it installed it.
+        unsafe { (self.callback)(self.user_data.0, stderr, chunk.as_ptr() as *const c_char, chunk.len()) }
+    }
+}
+
+/// Defines a host callback to which log records are routed instead of the terminal.
+#[derive(Clone, Copy, Debug)]
+struct LogSink {
+    /// The callback to call.
+    callback:  LogCallback,
+    /// The opaque pointer to give back to the callback.
+    user_data: UserData,
+}
+// SAFETY: The sink is called from whichever thread logs. The host promised us this is OK when it installed it (see [`set_log_sink()`]).
+unsafe impl Sync for LogSink {}
+
+/// Defines the logger that the library installs, which writes to either the terminal or the host's [`LogSink`].
+///
+/// Which records reach it at all is decided by [`log::max_level()`], which the `log`-macros check before formatting anything.
+struct LibLogger {
+    /// The logger that writes to the terminal if no sink is installed.
+    terminal: HumanLogger,
+}
+impl Log for LibLogger {
+    #[inline]
+    fn enabled(&self, metadata: &Metadata) -> bool { metadata.level() <= log::max_level() }
+
+    fn log(&self, record: &Record) {
+        if LOG_SINK.read().is_none() {
+            self.terminal.log(record);
+            return;
+        }
+
+        // Format the target and the message in one go, both null-terminated (and before locking the sink, in case formatting logs too)
+        let mut buffer: String = String::with_capacity(record.target().len() + 64);
+        if write!(&mut buffer, "{}\0{}\0", record.target(), record.args()).is_err() {
+            return;
+        }
+        let target: *const c_char = buffer.as_ptr() as *const c_char;
+        let message: *const c_char = buffer[record.target().len() + 1..].as_ptr() as *const c_char;
+
+        // Keep the sink locked while the host handles the record, so that `set_log_sink()` can wait for it before the host frees the old sink
+        let sink: RwLockReadGuard<Option<LogSink>> = LOG_SINK.read();
+        match *sink {
+            // SAFETY: The host promised us the callback is valid when it installed it.
+            Some(sink) => unsafe { (sink.callback)(sink.user_data.0, record.level() as u32, target, message) },
+            None => self.terminal.log(record),
+        }
+    }
+
+    #[inline]
+    fn flush(&self) { self.terminal.flush() }
+}
+
+
+
+
+
+/***** LIBRARY FUNCTIONS *****/
+/// Returns the BRANE version for which this compiler is valid.
+///
+/// # Returns
+/// String version that contains a major, minor and patch version separated by dots.
+#[no_mangle]
+pub extern "C" fn version() -> *const c_char {
+    // SAFETY: We can easily do this without a care in the world, since the string is static and won't need deallocation.
+    C_VERSION.as_ptr() as *const c_char
+}
+
+
+
+/// Forces the serialization functions to either use colour or not.
+///
+/// If you don't call this function, then it depends on whether the backend [`console`] library thinks if the stdout/stderr support ANSI colours.
+///
+/// # Arguments
+/// - `force`: If true, then ANSI characters will be forced to be printed. Otherwise, if false, they will be forced to _not_ be printed.
 #[no_mangle]
 pub extern "C" fn set_force_colour(force: bool) {
     // Delegate to the console functions, is all we need to do.
@@ -260,6 +1296,439 @@ pub extern "C" fn set_force_colour(force: bool) {
     console::set_colors_enabled_stderr(force);
 }
 
+/// Sets which log records the library emits.
+///
+/// Records below the given level are skipped before they are formatted, so silencing the library (e.g., in a service that compiles at a high rate) removes the logging overhead from every call.
+///
+/// # Arguments
+/// - `level`: The most verbose level to emit: `0` for nothing, `1` for errors, `2` for warnings, `3` for info, `4` for debug (the default) and `5` (or higher) for trace.
+#[no_mangle]
+pub extern "C" fn set_log_level(level: u32) {
+    init_logger();
+    let level: LevelFilter = match level {
+        0 => LevelFilter::Off,
+        1 => LevelFilter::Error,
+        2 => LevelFilter::Warn,
+        3 => LevelFilter::Info,
+        4 => LevelFilter::Debug,
+        _ => LevelFilter::Trace,
+    };
+    log::set_max_level(level);
+}
+
+/// Defines the callback to which the library routes its log records (see [`set_log_sink()`]).
+///
+/// # Arguments
+/// - `user_data`: The opaque pointer given to [`set_log_sink()`].
+/// - `level`: The level of the record: `1` for errors, `2` for warnings, `3` for info, `4` for debug and `5` for trace.
+/// - `target`: The (null-terminated) module path that emitted the record. Only valid for the duration of the call.
+/// - `message`: The (null-terminated) message of the record. Only valid for the duration of the call.
+pub type LogCallback = unsafe extern "C" fn(user_data: *mut c_void, level: u32, target: *const c_char, message: *const c_char);
+
+/// Routes the log records of the library to the given callback instead of writing them to the terminal.
+///
+/// Which records are emitted is still decided by [`set_log_level()`].
+///
+/// Replacing or removing the callback waits until any calls to the old one on other threads have returned, so once this function returns, the old callback and its `user_data` are no longer used and may be freed.
+///
+/// # Safety
+/// The `callback` is called from whichever thread emits a record, including the runtime's own threads. It must not call any library functions itself (and calling this function from it deadlocks).
+///
+/// # Arguments
+/// - `callback`: The [`LogCallback`] to call for every record. If [`NULL`], any installed callback is removed and records are written to the terminal again.
+/// - `user_data`: Some opaque pointer that is given back to the `callback`.
+#[no_mangle]
+pub unsafe extern "C" fn set_log_sink(callback: Option<LogCallback>, user_data: *mut c_void) {
+    init_logger();
+    *LOG_SINK.write() = callback.map(|callback| LogSink { callback, user_data: UserData(user_data) });
+}
+
+
+
+
+
+/// Configures the shared runtime that the library uses to do any networking on.
+///
+/// By default, the library uses a runtime with a single worker thread. Hosts that run many workflows concurrently (e.g., from multiple threads or using `vm_run_async()`) can use this function to give it more threads, such that runs actually overlap.
+///
+/// Note that this function must be called _before_ any index, compiler or virtual machine has been created (or after all of them have been freed again), since the runtime is shared among all of them.
+///
+/// # Arguments
+/// - `worker_threads`: The number of worker threads to run the runtime on. If `0`, then one is spawned per CPU core.
+/// - `max_blocking`: The maximum number of additional threads spawned for blocking operations (e.g., file I/O). If `0`, then tokio's default is used.
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+#[no_mangle]
+pub extern "C" fn runtime_configure(worker_threads: usize, max_blocking: usize) -> *const Error {
+    init_logger();
+    info!("Configuring Tokio runtime...");
+
+    // Refuse to do anything if the runtime is already in use
+    let rt: MutexGuard<Option<Arc<Runtime>>> = RUNTIME.lock();
+    if rt.is_some() {
+        let err: Error =
+            Error { msg: "Cannot configure runtime while it is in use; call runtime_configure() before creating any other object".into() };
+        return Box::into_raw(Box::new(err));
+    }
+
+    // Otherwise, update the config for the next time it's initialized
+    *RUNTIME_CONFIG.lock() = RuntimeConfig { worker_threads, max_blocking };
+    debug!("Runtime will be initialized with worker_threads={worker_threads}, max_blocking={max_blocking}");
+    std::ptr::null()
+}
+
+/// Configures the process-wide pool of driver connections that virtual machines run their workflows on.
+///
+/// Every [`vm_new()`] and every workflow run re-uses an existing connection to the same driver endpoint if one is available, instead of setting up a new one. Each connection multiplexes the requests of everything that shares it over a single HTTP/2 connection, where every running workflow keeps a stream open. A run takes the connection with the fewest running workflows; by default, at most 16 workflows run over one connection at the same time before a new one is opened. Connections that no virtual machine or run has used for a minute are closed.
+///
+/// Note that this only affects runs started after the call. Pooled connections live at most as long as the shared runtime does, i.e., until the last index, compiler and virtual machine has been freed.
+///
+/// # Arguments
+/// - `max_streams`: The maximum number of workflows that run over a single connection at the same time. If `0`, then there is no limit; if `1`, every concurrent run gets a connection of its own.
+#[no_mangle]
+pub extern "C" fn driver_pool_configure(max_streams: usize) {
+    init_logger();
+    debug!("Driver connections will run at most {} workflow(s) concurrently", if max_streams > 0 { max_streams.to_string() } else { "any".into() });
+    DRIVER_POOL_MAX_STREAMS.store(max_streams, Ordering::Relaxed);
+}
+
+
+
+
+
+/***** FUNCTION TABLE *****/
+/// Wraps a pointer to one of the library functions such that it can be stored in the [`FUNCTIONS`].
+#[repr(transparent)]
+struct FunctionPtr(*const c_void);
+// SAFETY: The pointers point to code, which is never written to.
+unsafe impl Sync for FunctionPtr {}
+
+/// Defines a table with pointers to all functions of the library (see [`brane_cli_get_vtable()`]).
+#[repr(C)]
+pub struct FunctionTable {
+    /// The version of the layout of this table (see [`ABI_VERSION`]).
+    abi_version: u32,
+    /// The number of pointers in `functions`.
+    len:         usize,
+    /// Pointers to the library functions.
+    functions:   *const FunctionPtr,
+}
+// SAFETY: The table is immutable and only points to the (equally immutable) [`FUNCTIONS`].
+unsafe impl Sync for FunctionTable {}
+
+/// The pointers in the [`FUNCTION_TABLE`].
+///
+/// These are in the same order as the members of the `Functions`-struct in `brane_cli.h`, which copies them in one go. New functions must therefore only be added at the end (of both).
+const FUNCTIONS: &[FunctionPtr] = &[
+    // Library functions
+    FunctionPtr(version as *const c_void),
+    FunctionPtr(set_force_colour as *const c_void),
+    FunctionPtr(set_log_level as *const c_void),
+    FunctionPtr(set_log_sink as *const c_void),
+    FunctionPtr(runtime_configure as *const c_void),
+    FunctionPtr(driver_pool_configure as *const c_void),
+    FunctionPtr(metrics_snapshot as *const c_void),
+    FunctionPtr(metrics_serialize as *const c_void),
+    FunctionPtr(metrics_reset as *const c_void),
+
+    // Error
+    FunctionPtr(error_free as *const c_void),
+    FunctionPtr(error_serialize_err as *const c_void),
+    FunctionPtr(error_serialize_err_into as *const c_void),
+    FunctionPtr(error_view_err as *const c_void),
+    FunctionPtr(error_print_err as *const c_void),
+
+    // Source error
+    FunctionPtr(serror_free as *const c_void),
+    FunctionPtr(serror_has_swarns as *const c_void),
+    FunctionPtr(serror_has_serrs as *const c_void),
+    FunctionPtr(serror_has_err as *const c_void),
+    FunctionPtr(serror_serialize_swarns as *const c_void),
+    FunctionPtr(serror_serialize_serrs as *const c_void),
+    FunctionPtr(serror_serialize_err as *const c_void),
+    FunctionPtr(serror_serialize_swarns_into as *const c_void),
+    FunctionPtr(serror_view_swarns as *const c_void),
+    FunctionPtr(serror_serialize_serrs_into as *const c_void),
+    FunctionPtr(serror_view_serrs as *const c_void),
+    FunctionPtr(serror_serialize_err_into as *const c_void),
+    FunctionPtr(serror_view_err as *const c_void),
+    FunctionPtr(serror_print_swarns as *const c_void),
+    FunctionPtr(serror_print_serrs as *const c_void),
+    FunctionPtr(serror_print_err as *const c_void),
+
+    // Package index
+    FunctionPtr(pindex_new_remote as *const c_void),
+    FunctionPtr(pindex_new_remote_cached as *const c_void),
+    FunctionPtr(pindex_free as *const c_void),
+
+    // Data index
+    FunctionPtr(dindex_new_remote as *const c_void),
+    FunctionPtr(dindex_new_remote_cached as *const c_void),
+    FunctionPtr(dindex_free as *const c_void),
+
+    // Workflow
+    FunctionPtr(workflow_free as *const c_void),
+    FunctionPtr(workflow_set_user as *const c_void),
+    FunctionPtr(workflow_disassemble as *const c_void),
+    FunctionPtr(workflow_disassemble_into as *const c_void),
+
+    // Compiler
+    FunctionPtr(compiler_new as *const c_void),
+    FunctionPtr(compiler_free as *const c_void),
+    FunctionPtr(compiler_compile as *const c_void),
+    FunctionPtr(compiler_compile_batch as *const c_void),
+    FunctionPtr(compiler_cache_stats as *const c_void),
+    FunctionPtr(compiler_cache_clear as *const c_void),
+
+    // Full value
+    FunctionPtr(fvalue_free as *const c_void),
+    FunctionPtr(fvalue_needs_processing as *const c_void),
+    FunctionPtr(fvalue_serialize as *const c_void),
+    FunctionPtr(fvalue_serialize_into as *const c_void),
+    FunctionPtr(profile_free as *const c_void),
+    FunctionPtr(profile_len as *const c_void),
+    FunctionPtr(profile_entry_name as *const c_void),
+    FunctionPtr(profile_entry_depth as *const c_void),
+    FunctionPtr(profile_entry_is_scope as *const c_void),
+    FunctionPtr(profile_entry_nanos as *const c_void),
+    FunctionPtr(profile_total_nanos as *const c_void),
+    FunctionPtr(profile_serialize as *const c_void),
+
+    // Virtual machine
+    FunctionPtr(vm_new as *const c_void),
+    FunctionPtr(vm_new_offline as *const c_void),
+    FunctionPtr(vm_new_dummy as *const c_void),
+    FunctionPtr(vm_free as *const c_void),
+    FunctionPtr(vm_set_output_callback as *const c_void),
+    FunctionPtr(vm_set_index_ttl as *const c_void),
+    FunctionPtr(vm_run as *const c_void),
+    FunctionPtr(vm_run_profiled as *const c_void),
+    FunctionPtr(vm_run_with_deadline as *const c_void),
+    FunctionPtr(vm_cancel as *const c_void),
+    FunctionPtr(vm_process as *const c_void),
+    FunctionPtr(vm_process_ex as *const c_void),
+    FunctionPtr(vm_process_many as *const c_void),
+    FunctionPtr(vm_run_async as *const c_void),
+    FunctionPtr(vm_run_poll as *const c_void),
+    FunctionPtr(vm_run_wait as *const c_void),
+    FunctionPtr(runhandle_free as *const c_void),
+
+    // Appended functions
+    FunctionPtr(workflow_clone as *const c_void),
+    FunctionPtr(workflow_bind as *const c_void),
+    FunctionPtr(workflow_bind_dataset as *const c_void),
+    FunctionPtr(vm_run_batch as *const c_void),
+    FunctionPtr(pindex_new_local as *const c_void),
+    FunctionPtr(pindex_read_cache as *const c_void),
+    FunctionPtr(pindex_write_cache as *const c_void),
+    FunctionPtr(dindex_new_local as *const c_void),
+    FunctionPtr(dindex_read_cache as *const c_void),
+    FunctionPtr(dindex_write_cache as *const c_void),
+    FunctionPtr(fvalue_kind as *const c_void),
+    FunctionPtr(fvalue_get_bool as *const c_void),
+    FunctionPtr(fvalue_get_int as *const c_void),
+    FunctionPtr(fvalue_get_real as *const c_void),
+    FunctionPtr(fvalue_get_string as *const c_void),
+    FunctionPtr(fvalue_get_class as *const c_void),
+    FunctionPtr(fvalue_array_len as *const c_void),
+    FunctionPtr(fvalue_array_get as *const c_void),
+    FunctionPtr(fvalue_field as *const c_void),
+    FunctionPtr(serror_count as *const c_void),
+    FunctionPtr(serror_get as *const c_void),
+    FunctionPtr(vm_set_plan_cache as *const c_void),
+    FunctionPtr(vm_plan_cached as *const c_void),
+    FunctionPtr(vmpool_new as *const c_void),
+    FunctionPtr(vmpool_free as *const c_void),
+    FunctionPtr(vmpool_run as *const c_void),
+    FunctionPtr(vmpool_process as *const c_void),
+];
+
+/// The table returned by [`brane_cli_get_vtable()`].
+static FUNCTION_TABLE: FunctionTable = FunctionTable { abi_version: ABI_VERSION, len: FUNCTIONS.len(), functions: FUNCTIONS.as_ptr() };
+
+/// Returns a table with pointers to all functions of this library.
+///
+/// This allows a host to load the library with a single symbol lookup, instead of one for every function. Functions are only ever appended to the table, so a host built against an older header can use the start of a newer table.
+///
+/// # Arguments
+/// - `abi_version`: The version of the table layout that the host expects.
+///
+/// # Returns
+/// A pointer to the (static) [`FunctionTable`], which must not be freed. Is [`NULL`] if this library does not support the given `abi_version`, e.g., because it is older than the host's header.
+#[no_mangle]
+pub extern "C" fn brane_cli_get_vtable(abi_version: u32) -> *const FunctionTable {
+    if abi_version == 0 || abi_version > ABI_VERSION {
+        return std::ptr::null();
+    }
+    &FUNCTION_TABLE
+}
+
+
+
+
+
+/***** METRICS *****/
+/// Defines a snapshot of the metrics of a single kind of operation (see [`metrics_snapshot()`]).
+#[derive(Clone, Copy, Debug)]
+#[repr(C)]
+pub struct OpMetrics {
+    /// The number of operations performed.
+    pub calls:    u64,
+    /// The number of operations that failed.
+    pub errors:   u64,
+    /// The summed latency of all operations, in microseconds.
+    pub total_us: u64,
+    /// The highest latency of any operation, in microseconds.
+    pub max_us:   u64,
+    /// An upper bound of the median latency, in microseconds.
+    pub p50_us:   u64,
+    /// An upper bound of the 90th percentile latency, in microseconds.
+    pub p90_us:   u64,
+    /// An upper bound of the 99th percentile latency, in microseconds.
+    pub p99_us:   u64,
+    /// Bucket `i` counts the operations that took less than `2^i` microseconds (but not less than `2^(i - 1)`). The last bucket also counts anything slower.
+    pub buckets:  [u64; METRICS_BUCKETS],
+}
+impl OpMetrics {
+    /// Estimates the given percentile of the latency from the buckets.
+    ///
+    /// # Arguments
+    /// - `q`: The percentile to find, as a fraction (e.g., `0.99`).
+    ///
+    /// # Returns
+    /// The upper bound of the bucket containing the percentile (capped at the highest latency seen), in microseconds. `0` if there are no operations.
+    fn percentile(&self, q: f64) -> u64 {
+        let count: u64 = self.buckets.iter().sum();
+        if count == 0 {
+            return 0;
+        }
+        let target: u64 = ((count as f64 * q).ceil() as u64).max(1);
+        let mut seen: u64 = 0;
+        for (i, bucket) in self.buckets.iter().enumerate() {
+            seen += bucket;
+            if seen >= target {
+                return if i + 1 < METRICS_BUCKETS { ((1u64 << i) - 1).min(self.max_us) } else { self.max_us };
+            }
+        }
+        self.max_us
+    }
+
+    /// Renders the metrics as a JSON object.
+    ///
+    /// # Returns
+    /// A [`serde_json::Value`] with a field for every field in the struct.
+    fn to_json(&self) -> serde_json::Value {
+        serde_json::json!({
+            "calls": self.calls,
+            "errors": self.errors,
+            "total_us": self.total_us,
+            "max_us": self.max_us,
+            "p50_us": self.p50_us,
+            "p90_us": self.p90_us,
+            "p99_us": self.p99_us,
+            "buckets": self.buckets.as_slice(),
+        })
+    }
+}
+
+/// Defines a snapshot of all metrics collected by the library (see [`metrics_snapshot()`]).
+#[derive(Clone, Copy, Debug)]
+#[repr(C)]
+pub struct Metrics {
+    /// Snippets compiled with [`compiler_compile()`] or [`compiler_compile_batch()`] (including ones answered from the cache). Compiles that only produced warnings count as successful.
+    pub compile: OpMetrics,
+    /// Workflows run with [`vm_run()`], [`vm_run_profiled()`], [`vm_run_with_deadline()`], [`vm_run_async()`] or [`vm_run_batch()`] (once per workflow).
+    pub run: OpMetrics,
+    /// Datasets downloaded by [`vm_process()`], [`vm_process_ex()`] or [`vm_process_many()`].
+    pub download: OpMetrics,
+    /// Package indices downloaded from a remote (i.e., not ones read from a cache).
+    pub pindex: OpMetrics,
+    /// Data indices downloaded from a remote, including refreshes by [`vm_process()`] (but not ones read from a cache).
+    pub dindex: OpMetrics,
+    /// Workflows disassembled with [`workflow_disassemble()`] or [`workflow_disassemble_into()`].
+    pub disassemble: OpMetrics,
+    /// Values serialized with [`fvalue_serialize()`] or [`fvalue_serialize_into()`].
+    pub serialize: OpMetrics,
+}
+impl Metrics {
+    /// Takes a snapshot of all the counters.
+    ///
+    /// # Returns
+    /// A new [`Metrics`] with the current values.
+    fn snapshot() -> Self {
+        Self {
+            compile: METRICS_COMPILE.snapshot(),
+            run: METRICS_RUN.snapshot(),
+            download: METRICS_DOWNLOAD.snapshot(),
+            pindex: METRICS_PINDEX.snapshot(),
+            dindex: METRICS_DINDEX.snapshot(),
+            disassemble: METRICS_DISASSEMBLE.snapshot(),
+            serialize: METRICS_SERIALIZE.snapshot(),
+        }
+    }
+}
+
+
+
+/// Takes a snapshot of the metrics that the library collected since it was loaded (or since [`metrics_reset()`]).
+///
+/// Collecting the metrics is cheap and lock-free, so they are always enabled.
+///
+/// # Arguments
+/// - `metrics`: The [`Metrics`]-struct to write the snapshot to.
+///
+/// # Panics
+/// This function can panic if the given `metrics` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn metrics_snapshot(metrics: *mut Metrics) {
+    // Unwrap the pointer
+    let metrics: &mut Metrics = match metrics.as_mut() {
+        Some(metrics) => metrics,
+        None => {
+            panic!("Given Metrics is a NULL-pointer");
+        },
+    };
+
+    // Write all of them
+    *metrics = Metrics::snapshot();
+}
+
+/// Serializes a snapshot of the metrics that the library collected (see [`metrics_snapshot()`]) as JSON.
+///
+/// This is meant for benchmarks and load tests that want to record the library's own view of its latencies in a machine-readable form. The result is a single object with a field per operation (e.g., `"compile"`), each of which is an object with the same fields as [`OpMetrics`].
+///
+/// # Returns
+/// The serialized metrics, as a string. Don't forget to free it!
+#[no_mangle]
+pub extern "C" fn metrics_serialize() -> *mut c_char {
+    init_logger();
+    let metrics: Metrics = Metrics::snapshot();
+    let json: serde_json::Value = serde_json::json!({
+        "compile": metrics.compile.to_json(),
+        "run": metrics.run.to_json(),
+        "download": metrics.download.to_json(),
+        "pindex": metrics.pindex.to_json(),
+        "dindex": metrics.dindex.to_json(),
+        "disassemble": metrics.disassemble.to_json(),
+        "serialize": metrics.serialize.to_json(),
+    });
+    rust_to_cstr(json.to_string())
+}
+
+/// Resets all metrics collected by the library back to zero.
+#[no_mangle]
+pub extern "C" fn metrics_reset() {
+    init_logger();
+    debug!("Resetting metrics");
+    let counters: [&OpCounters; 7] =
+        [&METRICS_COMPILE, &METRICS_RUN, &METRICS_DOWNLOAD, &METRICS_PINDEX, &METRICS_DINDEX, &METRICS_DISASSEMBLE, &METRICS_SERIALIZE];
+    for counters in counters {
+        counters.reset();
+    }
+}
+
 
 
 
@@ -318,6 +1787,60 @@ pub unsafe extern "C" fn error_serialize_err(err: *const Error, buffer: *mut *mu
     // OK, done!
 }
 
+/// Serializes the error message in this error to a buffer given by the caller, `snprintf`-style.
+///
+/// # Arguments
+/// - `err`: the [`Error`] to serialize the error of.
+/// - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+/// - `len`: The size of the `buffer`, in bytes.
+///
+/// # Returns
+/// The length of the complete message (excluding the null-byte). If this is `len` or more, the message was truncated; call again with a buffer of at least the returned length + 1.
+///
+/// # Panics
+/// This function can panic if the given `err` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn error_serialize_err_into(err: *const Error, buffer: *mut c_char, len: usize) -> usize {
+    // Unwrap the pointers
+    let err: &Error = match err.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given Error is a NULL-pointer");
+        },
+    };
+
+    // Write it
+    rust_to_buffer(&err.msg, buffer, len)
+}
+
+/// Provides a borrowed view of the error message in this error, without copying it.
+///
+/// # Arguments
+/// - `err`: the [`Error`] to view the error of.
+/// - `len`: Will be set to the length of the message, in bytes.
+///
+/// # Returns
+/// A pointer to the message. Note that it is _not_ null-terminated, and only valid until `err` is freed.
+///
+/// # Panics
+/// This function can panic if the given `err` or `len` are NULL-pointers.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn error_view_err(err: *const Error, len: *mut usize) -> *const c_char {
+    // Unwrap the pointers
+    let err: &Error = match err.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given Error is a NULL-pointer");
+        },
+    };
+
+    // Return the view
+    *len = err.msg.len();
+    err.msg.as_ptr() as *const c_char
+}
+
 /// Prints the error message in this error to stderr.
 ///
 /// # Arguments
@@ -347,13 +1870,65 @@ pub unsafe extern "C" fn error_print_err(err: *const Error) {
 
 
 /***** LIBRARY SOURCE ERROR *****/
+/// Defines a single warning or error of a [`SourceError`], as filled in by [`serror_get()`].
+///
+/// All strings are owned by the [`SourceError`], and are only valid for as long as it is.
+#[derive(Clone, Copy, Debug)]
+#[repr(C)]
+pub struct Diagnostic {
+    /// Whether this is an error (true) or a warning (false).
+    is_error:    bool,
+    /// The (null-terminated) description of what was compiled, i.e., the `what` given to the compiler.
+    file:        *const c_char,
+    /// The (one-indexed) line where the diagnostic starts, or `0` if it is not about a specific piece of source text.
+    line:        usize,
+    /// The (one-indexed) column where the diagnostic starts, or `0` if it is not about a specific piece of source text.
+    column:      usize,
+    /// The (one-indexed) line where the diagnostic ends, or `0` if it is not about a specific piece of source text.
+    end_line:    usize,
+    /// The (one-indexed) column where the diagnostic ends, or `0` if it is not about a specific piece of source text.
+    end_column:  usize,
+    /// The (null-terminated) message of the diagnostic, without any styling.
+    message:     *const c_char,
+    /// The (null-terminated) source text of the line where the diagnostic starts, without its line ending. Empty if it is not about a specific piece of source text.
+    source_line: *const c_char,
+}
+
+/// The warnings and errors of a [`SourceError`], in the form that [`Diagnostic`]s can point to.
+#[derive(Debug)]
+struct Diagnostics {
+    /// The description of what was compiled.
+    file:    CString,
+    /// The warnings and errors themselves.
+    entries: Vec<DiagnosticEntry>,
+}
+
+/// A single warning or error in the [`Diagnostics`].
+#[derive(Debug)]
+struct DiagnosticEntry {
+    /// Whether this is an error (true) or a warning (false).
+    is_error:    bool,
+    /// The line where the diagnostic starts (or `0`).
+    line:        usize,
+    /// The column where the diagnostic starts (or `0`).
+    column:      usize,
+    /// The line where the diagnostic ends (or `0`).
+    end_line:    usize,
+    /// The column where the diagnostic ends (or `0`).
+    end_column:  usize,
+    /// The message of the diagnostic.
+    message:     CString,
+    /// The source text of the line where the diagnostic starts.
+    source_line: CString,
+}
+
 /// Defines the error type returned by this library.
 #[derive(Debug)]
 pub struct SourceError<'f> {
     /// The filename of the file we are referencing.
     file:   &'f str,
-    /// The complete source we attempted to parse. Note that we copy instead of reference to be cooler (and to rollback the state on errors).
-    source: String,
+    /// The complete source we attempted to parse, as a view on the [`Compiler`]'s source (which may have grown since).
+    source: Option<SourceView>,
 
     /// The warning messages to print.
     warns: Vec<AstWarning>,
@@ -361,21 +1936,150 @@ pub struct SourceError<'f> {
     errs:  Vec<AstError>,
     /// Any custom error message to print that is not from the compiler itself.
     msg:   Option<String>,
+
+    /// The serialized warnings, which are rendered the first time they are asked for.
+    swarns: OnceLock<String>,
+    /// The serialized errors, which are rendered the first time they are asked for.
+    serrs:  OnceLock<String>,
+    /// The warnings and errors as given to the host by [`serror_get()`], which are collected the first time they are asked for.
+    diags:  OnceLock<Diagnostics>,
+    /// Where every line in `source` starts, which is indexed the first time a warning or error needs its line.
+    lines:  OnceLock<Vec<usize>>,
 }
+impl<'f> SourceError<'f> {
+    /// Constructor for a SourceError that has no warnings or errors (yet).
+    ///
+    /// # Arguments
+    /// - `file`: The filename of the file we are referencing.
+    /// - `source`: The complete source we attempted to parse, if any.
+    ///
+    /// # Returns
+    /// A new, boxed SourceError.
+    #[inline]
+    fn new(file: &'f str, source: Option<SourceView>) -> Box<Self> {
+        Box::new(Self {
+            file,
+            source,
+            warns:  vec![],
+            errs:   vec![],
+            msg:    None,
+            swarns: OnceLock::new(),
+            serrs:  OnceLock::new(),
+            diags:  OnceLock::new(),
+            lines:  OnceLock::new(),
+        })
+    }
 
+    /// Returns the serialized warnings in this error, rendering them if that hadn't happened yet.
+    ///
+    /// # Returns
+    /// The warnings as they would be printed. Empty if there are none.
+    fn swarns(&self) -> &str {
+        self.swarns.get_or_init(|| {
+            let mut warns: Vec<u8> = Vec::new();
+            self.with_lines(|lines| {
+                for warn in &self.warns {
+                    warn.prettywrite_lines(&mut warns, self.file, lines).unwrap();
+                }
+            });
+            String::from_utf8(warns).unwrap()
+        })
+    }
 
+    /// Returns the serialized errors in this error, rendering them if that hadn't happened yet.
+    ///
+    /// # Returns
+    /// The errors as they would be printed. Empty if there are none.
+    fn serrs(&self) -> &str {
+        self.serrs.get_or_init(|| {
+            let mut errs: Vec<u8> = Vec::new();
+            self.with_lines(|lines| {
+                for err in &self.errs {
+                    err.prettywrite_lines(&mut errs, self.file, lines).unwrap();
+                }
+            });
+            String::from_utf8(errs).unwrap()
+        })
+    }
 
-/// Destructor for the Error type.
-///
-/// # Safety
-/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
-///
-/// # Arguments
-/// - `serr`: The [`SourceError`] to deallocate.
-#[no_mangle]
-pub unsafe extern "C" fn serror_free(serr: *mut SourceError) {
-    init_logger();
-    trace!("Destroying SourceError...");
+    /// Returns the warnings and errors in this error in the form that [`Diagnostic`]s can point to, collecting them if that hadn't happened yet.
+    ///
+    /// # Returns
+    /// The [`Diagnostics`], with the warnings first and then the errors.
+    fn diags(&self) -> &Diagnostics {
+        self.diags.get_or_init(|| {
+            self.with_lines(|lines| {
+                let entry = |is_error: bool, range: Option<(usize, usize, usize, usize)>, message: String| -> DiagnosticEntry {
+                    let (line, column, end_line, end_column): (usize, usize, usize, usize) = range.unwrap_or((0, 0, 0, 0));
+                    let source_line: &str = lines.line(line).unwrap_or("");
+                    DiagnosticEntry {
+                        is_error,
+                        line,
+                        column,
+                        end_line,
+                        end_column,
+                        message:     CString::new(message).unwrap_or_default(),
+                        source_line: CString::new(source_line).unwrap_or_default(),
+                    }
+                };
+
+                // Collect the warnings and errors with their positions
+                let mut entries: Vec<DiagnosticEntry> = Vec::with_capacity(self.warns.len() + self.errs.len());
+                for warn in &self.warns {
+                    let range = warn.range().filter(|r| !r.is_none()).map(|r| (r.start.line, r.start.col, r.end.line, r.end.col));
+                    entries.push(entry(false, range, warn.to_string()));
+                }
+                for err in &self.errs {
+                    let range = err.range().filter(|r| !r.is_none()).map(|r| (r.start.line, r.start.col, r.end.line, r.end.col));
+                    entries.push(entry(true, range, err.to_string()));
+                }
+                Diagnostics { file: CString::new(self.file).unwrap_or_default(), entries }
+            })
+        })
+    }
+
+    /// Calls the given closure with the source that this error refers to.
+    ///
+    /// # Arguments
+    /// - `f`: The closure to call with the source text. Is given an empty string if this error has no source.
+    ///
+    /// # Returns
+    /// Whatever the closure returns.
+    #[inline]
+    fn with_source<R>(&self, f: impl FnOnce(&str) -> R) -> R {
+        match &self.source {
+            Some(source) => source.with(f),
+            None => f(""),
+        }
+    }
+
+    /// Calls the given closure with the source that this error refers to, indexed by line.
+    ///
+    /// The index is computed only once per error, such that rendering its warnings, its errors and its [`Diagnostics`] does not search the source for every line again.
+    ///
+    /// # Arguments
+    /// - `f`: The closure to call with the indexed source text. Is given an empty one if this error has no source.
+    ///
+    /// # Returns
+    /// Whatever the closure returns.
+    fn with_lines<R>(&self, f: impl FnOnce(&SourceLines) -> R) -> R {
+        self.with_source(|source| f(&SourceLines::with_index(source, self.lines.get_or_init(|| SourceLines::index(source)))))
+    }
+}
+
+
+
+/// Destructor for the Error type.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `serr`: The [`SourceError`] to deallocate.
+#[no_mangle]
+pub unsafe extern "C" fn serror_free(serr: *mut SourceError) {
+    init_logger();
+    trace!("Destroying SourceError...");
 
     // Simply captute the box, then drop
     drop(Box::from_raw(serr));
@@ -484,27 +2188,8 @@ pub unsafe extern "C" fn serror_serialize_swarns(serr: *const SourceError, buffe
         },
     };
 
-    // Early quit if there is no warning
-    if serr.warns.is_empty() {
-        // Write a single-byte buffer with only the null buffer
-        let target: *mut c_char = libc::malloc(1) as *mut c_char;
-        std::slice::from_raw_parts_mut(target, 1)[0] = '\0' as i8;
-        *buffer = target;
-
-        // A'ight that's it then
-        return;
-    }
-
-    // Otherwise, serialize all warnings to a C-string
-    let mut warns: Vec<u8> = Vec::new();
-    for warn in &serr.warns {
-        // Write them to a Rust string first
-        warn.prettywrite(&mut warns, serr.file, &serr.source).unwrap();
-    }
-    let warns: String = String::from_utf8(warns).unwrap();
-
-    // Set the C-string equivalent of this as the result
-    *buffer = rust_to_cstr(warns);
+    // Set the C-string equivalent of the (possibly empty) warnings as the result
+    *buffer = rust_to_cstr(serr.swarns().into());
 
     // And that's it
 }
@@ -533,27 +2218,8 @@ pub unsafe extern "C" fn serror_serialize_serrs(serr: *const SourceError, buffer
         },
     };
 
-    // Early quit if there is no warning
-    if serr.errs.is_empty() {
-        // Write a single-byte buffer with only the null buffer
-        let target: *mut c_char = libc::malloc(1) as *mut c_char;
-        std::slice::from_raw_parts_mut(target, 1)[0] = '\0' as i8;
-        *buffer = target;
-
-        // A'ight that's it then
-        return;
-    }
-
-    // Otherwise, serialize all warnings to a C-string
-    let mut errs: Vec<u8> = Vec::new();
-    for err in &serr.errs {
-        // Write them to a Rust string first
-        err.prettywrite(&mut errs, serr.file, &serr.source).unwrap();
-    }
-    let errs: String = String::from_utf8(errs).unwrap();
-
-    // Set the C-string equivalent of this as the result
-    *buffer = rust_to_cstr(errs);
+    // Set the C-string equivalent of the (possibly empty) errors as the result
+    *buffer = rust_to_cstr(serr.serrs().into());
 
     // And that's it
 }
@@ -598,6 +2264,177 @@ pub unsafe extern "C" fn serror_serialize_err(serr: *const SourceError, buffer:
     }
 }
 
+/// Serializes the source warnings in this error to a buffer given by the caller, `snprintf`-style.
+///
+/// Note that there may be zero or more warnings at once. To discover if there are any, check [`serror_has_swarns()`].
+///
+/// # Arguments
+/// - `serr`: the [`SourceError`] to serialize the source warnings of.
+/// - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+/// - `len`: The size of the `buffer`, in bytes.
+///
+/// # Returns
+/// The length of the complete serialized warnings (excluding the null-byte). If this is `len` or more, they were truncated; call again with a buffer of at least the returned length + 1.
+///
+/// # Panics
+/// This function can panic if the given `serr` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_serialize_swarns_into(serr: *const SourceError, buffer: *mut c_char, len: usize) -> usize {
+    // Unwrap the pointers
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+
+    // Write it
+    rust_to_buffer(serr.swarns(), buffer, len)
+}
+
+/// Provides a borrowed view of the serialized source warnings in this error, without copying them.
+///
+/// # Arguments
+/// - `serr`: the [`SourceError`] to view the source warnings of.
+/// - `len`: Will be set to the length of the serialized warnings, in bytes.
+///
+/// # Returns
+/// A pointer to the serialized warnings. Note that it is _not_ null-terminated, and only valid until `serr` is freed.
+///
+/// # Panics
+/// This function can panic if the given `serr` or `len` are NULL-pointers.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_view_swarns(serr: *const SourceError, len: *mut usize) -> *const c_char {
+    // Unwrap the pointers
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+
+    // Return the view
+    let view: &str = serr.swarns();
+    *len = view.len();
+    view.as_ptr() as *const c_char
+}
+
+/// Serializes the source errors in this error to a buffer given by the caller, `snprintf`-style.
+///
+/// Note that there may be zero or more errors at once. To discover if there are any, check [`serror_has_serrs()`].
+///
+/// # Arguments
+/// - `serr`: the [`SourceError`] to serialize the source errors of.
+/// - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+/// - `len`: The size of the `buffer`, in bytes.
+///
+/// # Returns
+/// The length of the complete serialized errors (excluding the null-byte). If this is `len` or more, they were truncated; call again with a buffer of at least the returned length + 1.
+///
+/// # Panics
+/// This function can panic if the given `serr` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_serialize_serrs_into(serr: *const SourceError, buffer: *mut c_char, len: usize) -> usize {
+    // Unwrap the pointers
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+
+    // Write it
+    rust_to_buffer(serr.serrs(), buffer, len)
+}
+
+/// Provides a borrowed view of the serialized source errors in this error, without copying them.
+///
+/// # Arguments
+/// - `serr`: the [`SourceError`] to view the source errors of.
+/// - `len`: Will be set to the length of the serialized errors, in bytes.
+///
+/// # Returns
+/// A pointer to the serialized errors. Note that it is _not_ null-terminated, and only valid until `serr` is freed.
+///
+/// # Panics
+/// This function can panic if the given `serr` or `len` are NULL-pointers.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_view_serrs(serr: *const SourceError, len: *mut usize) -> *const c_char {
+    // Unwrap the pointers
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+
+    // Return the view
+    let view: &str = serr.serrs();
+    *len = view.len();
+    view.as_ptr() as *const c_char
+}
+
+/// Serializes the error message in this error to a buffer given by the caller, `snprintf`-style.
+///
+/// Note that there may be no error, but only source warnings- or errors. To discover if there is any, check [`serror_has_err()`].
+///
+/// # Arguments
+/// - `serr`: the [`SourceError`] to serialize the error message of.
+/// - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+/// - `len`: The size of the `buffer`, in bytes.
+///
+/// # Returns
+/// The length of the complete serialized message (excluding the null-byte). If this is `len` or more, they were truncated; call again with a buffer of at least the returned length + 1.
+///
+/// # Panics
+/// This function can panic if the given `serr` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_serialize_err_into(serr: *const SourceError, buffer: *mut c_char, len: usize) -> usize {
+    // Unwrap the pointers
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+
+    // Write it
+    rust_to_buffer(serr.msg.as_deref().unwrap_or(""), buffer, len)
+}
+
+/// Provides a borrowed view of the serialized error message in this error, without copying it.
+///
+/// # Arguments
+/// - `serr`: the [`SourceError`] to view the error message of.
+/// - `len`: Will be set to the length of the serialized message, in bytes.
+///
+/// # Returns
+/// A pointer to the serialized message. Note that it is _not_ null-terminated, and only valid until `serr` is freed.
+///
+/// # Panics
+/// This function can panic if the given `serr` or `len` are NULL-pointers.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_view_err(serr: *const SourceError, len: *mut usize) -> *const c_char {
+    // Unwrap the pointers
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+
+    // Return the view
+    let view: &str = serr.msg.as_deref().unwrap_or("");
+    *len = view.len();
+    view.as_ptr() as *const c_char
+}
+
 
 
 /// Prints the source warnings in this error to stderr.
@@ -621,9 +2458,11 @@ pub unsafe extern "C" fn serror_print_swarns(serr: *const SourceError) {
     };
 
     // Iterate over the warnings to print them
-    for warn in &serr.warns {
-        warn.prettyprint(serr.file, &serr.source);
-    }
+    serr.with_lines(|lines| {
+        for warn in &serr.warns {
+            warn.prettywrite_lines(std::io::stderr(), serr.file, lines).unwrap();
+        }
+    });
 }
 
 /// Prints the source errors in this error to stderr.
@@ -647,9 +2486,11 @@ pub unsafe extern "C" fn serror_print_serrs(serr: *const SourceError) {
     };
 
     // Iterate over the errors to print them
-    for err in &serr.errs {
-        err.prettyprint(serr.file, &serr.source);
-    }
+    serr.with_lines(|lines| {
+        for err in &serr.errs {
+            err.prettywrite_lines(std::io::stderr(), serr.file, lines).unwrap();
+        }
+    });
 }
 
 /// Prints the error message in this error to stderr.
@@ -681,6 +2522,88 @@ pub unsafe extern "C" fn serror_print_err(serr: *const SourceError) {
 }
 
 
+/// Returns the number of warnings and errors in a source error, which can be read one-by-one using [`serror_get()`].
+///
+/// # Arguments
+/// - `serr`: The [`SourceError`] struct to inspect.
+///
+/// # Returns
+/// The number of warnings plus the number of errors.
+///
+/// # Panics
+/// This function can panic if the given `serr` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_count(serr: *const SourceError) -> usize {
+    // Unwrap the pointer
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+
+    // Count them all
+    serr.warns.len() + serr.errs.len()
+}
+
+/// Reads a single warning or error of a source error as a structured [`Diagnostic`], such that the host can render it itself.
+///
+/// The warnings come first, followed by the errors. Any custom message (see [`serror_has_err()`]) is not included.
+///
+/// The first call for a given `serr` collects all of its diagnostics at once; any subsequent ones are cheap.
+///
+/// # Arguments
+/// - `serr`: The [`SourceError`] struct to read.
+/// - `index`: The index of the diagnostic to read. Must be lower than [`serror_count()`].
+/// - `diag`: The [`Diagnostic`] to fill in. Its strings are owned by `serr`. Left untouched if `index` is out-of-bounds.
+///
+/// # Returns
+/// Whether `index` was in bounds.
+///
+/// # Panics
+/// This function can panic if the given `serr` or `diag` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn serror_get(serr: *const SourceError, index: usize, diag: *mut Diagnostic) -> bool {
+    init_logger();
+
+    // Unwrap the pointers
+    let serr: &SourceError = match serr.as_ref() {
+        Some(err) => err,
+        None => {
+            panic!("Given SourceError is a NULL-pointer");
+        },
+    };
+    let diag: &mut Diagnostic = match diag.as_mut() {
+        Some(diag) => diag,
+        None => {
+            panic!("Given Diagnostic is a NULL-pointer");
+        },
+    };
+
+    // Find the diagnostic
+    let diags: &Diagnostics = serr.diags();
+    let entry: &DiagnosticEntry = match diags.entries.get(index) {
+        Some(entry) => entry,
+        None => {
+            return false;
+        },
+    };
+    *diag = Diagnostic {
+        is_error:    entry.is_error,
+        file:        diags.file.as_ptr(),
+        line:        entry.line,
+        column:      entry.column,
+        end_line:    entry.end_line,
+        end_column:  entry.end_column,
+        message:     entry.message.as_ptr(),
+        source_line: entry.source_line.as_ptr(),
+    };
+    true
+}
+
+
 
 
 
@@ -698,7 +2621,7 @@ pub unsafe extern "C" fn serror_print_err(serr: *const SourceError) {
 /// This function can panic if the given `endpoint` does not point to a valud UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn pindex_new_remote(endpoint: *const c_char, pindex: *mut *mut Arc<Mutex<PackageIndex>>) -> *const Error {
+pub unsafe extern "C" fn pindex_new_remote(endpoint: *const c_char, pindex: *mut *mut Arc<ArcSwap<PackageIndex>>) -> *const Error {
     init_logger();
     *pindex = std::ptr::null_mut();
     info!("Collecting package index...");
@@ -717,7 +2640,7 @@ pub unsafe extern "C" fn pindex_new_remote(endpoint: *const c_char, pindex: *mut
 
     // Build the package index around it
     let addr: String = format!("{endpoint}/graphql");
-    let index: PackageIndex = match runtime.block_on(get_package_index(&addr)) {
+    let index: PackageIndex = match METRICS_PINDEX.measure(|| runtime.block_on(get_package_index(&addr))) {
         Ok(index) => index,
         Err(e) => {
             let err: Error = Error { msg: format!("Failed to read package index from '{addr}': {e}") };
@@ -727,52 +2650,54 @@ pub unsafe extern "C" fn pindex_new_remote(endpoint: *const c_char, pindex: *mut
 
     // Store it and we're done
     debug!("Found {} packages", index.packages.len());
-    *pindex = Box::into_raw(Box::new(Arc::new(Mutex::new(index))));
+    *pindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
     std::ptr::null()
 }
 
-/// Destructor for the PackageIndex.
-///
-/// # Safety
-/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+/// Constructs a new [`PackageIndex`] that lists the available packages in a remote instance, re-using an on-disk copy if it is recent enough.
 ///
-/// # Arguments
-/// - `pindex`: The [`PackageIndex`] to free.
-#[no_mangle]
-pub unsafe extern "C" fn pindex_free(pindex: *mut Arc<Mutex<PackageIndex>>) {
-    init_logger();
-    trace!("Destroying PackageIndex...");
-
-    // Simply capture the box, then drop
-    drop(Box::from_raw(pindex));
-    cleanup_runtime();
-}
-
-
-
-
-
-/***** LIBRARY DATAINDEX *****/
-/// Constructs a new [`DataIndex`] that lists the available datasets in a remote instance.
+/// If the remote has to be contacted, then the downloaded index is written to the cache for subsequent calls (possibly from other processes).
 ///
 /// # Arguments
-/// - `endpoint`: The remote API-endpoint to read the datasets from. The path (`/data/info`) will be deduced and needn't be given, just the host and port.
-/// - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
+/// - `endpoint`: The remote API-endpoint to read the packages from. The path (`/graphql`) will be deduced and needn't be given, just the host and port.
+/// - `cache_dir`: The directory where cached indices are stored. Will be created if it does not exist.
+/// - `max_age`: The maximum age (in seconds) of the cached index before it is considered stale and re-downloaded.
+/// - `pindex`: Will point to the newly created [`PackageIndex`] when done. Will be [`NULL`] if there is an error (see below).
 ///
 /// # Returns
 /// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
 ///
 /// # Panics
-/// This function can panic if the given `endpoint` does not point to a valud UTF-8 string.
+/// This function can panic if the given `endpoint` or `cache_dir` do not point to a valud UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn dindex_new_remote(endpoint: *const c_char, dindex: *mut *mut Arc<Mutex<DataIndex>>) -> *const Error {
+pub unsafe extern "C" fn pindex_new_remote_cached(
+    endpoint: *const c_char,
+    cache_dir: *const c_char,
+    max_age: u64,
+    pindex: *mut *mut Arc<ArcSwap<PackageIndex>>,
+) -> *const Error {
     init_logger();
-    *dindex = std::ptr::null_mut();
-    info!("Collecting data index...");
+    *pindex = std::ptr::null_mut();
+    info!("Collecting package index (cached)...");
 
-    // Read the input string
+    // Read the input strings
     let endpoint: &str = cstr_to_rust(endpoint);
+    let cache_path: PathBuf = index_cache_path(Path::new(cstr_to_rust(cache_dir)), "pindex", endpoint);
+
+    // See if we can get away with the cache
+    if let Some(raw) = read_index_cache(&cache_path, Duration::from_secs(max_age)) {
+        match PackageIndex::from_reader(raw.as_bytes()) {
+            Ok(index) => {
+                debug!("Found {} packages (from cache '{}')", index.packages.len(), cache_path.display());
+                *pindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
+                return std::ptr::null();
+            },
+            Err(e) => {
+                warn!("Failed to parse cached package index '{}': {} (re-downloading)", cache_path.display(), e);
+            },
+        }
+    }
 
     // Create a local threaded tokio context
     let runtime: Arc<Runtime> = match init_runtime() {
@@ -784,448 +2709,3645 @@ pub unsafe extern "C" fn dindex_new_remote(endpoint: *const c_char, dindex: *mut
     };
 
     // Build the package index around it
-    let addr: String = format!("{endpoint}/data/info");
-    let index: DataIndex = match runtime.block_on(get_data_index(&addr)) {
+    let addr: String = format!("{endpoint}/graphql");
+    let index: PackageIndex = match METRICS_PINDEX.measure(|| runtime.block_on(get_package_index(&addr))) {
         Ok(index) => index,
         Err(e) => {
-            let err: Error = Error { msg: format!("Failed to read data index from '{addr}': {e}") };
+            let err: Error = Error { msg: format!("Failed to read package index from '{addr}': {e}") };
             return Box::into_raw(Box::new(err));
         },
     };
 
+    // Update the cache
+    let packages: Vec<&PackageInfo> = index.packages.values().collect();
+    match serde_json::to_string(&packages) {
+        Ok(raw) => write_index_cache(&cache_path, &raw),
+        Err(e) => warn!("Failed to serialize package index: {e} (not caching index)"),
+    }
+
     // Store it and we're done
-    debug!("Found {} datasets", index.iter().count());
-    *dindex = Box::into_raw(Box::new(Arc::new(Mutex::new(index))));
+    debug!("Found {} packages", index.packages.len());
+    *pindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
     std::ptr::null()
 }
 
-/// Destructor for the DataIndex.
-///
-/// # Safety
-/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
-///
-/// # Arguments
-/// - `dindex`: The [`DataIndex`] to free.
-#[no_mangle]
-pub unsafe extern "C" fn dindex_free(dindex: *mut Arc<Mutex<DataIndex>>) {
-    init_logger();
-    trace!("Destroying DataIndex...");
-
-    // Simply capture the box, then drop
-    drop(Box::from_raw(dindex));
-    cleanup_runtime();
-}
-
-
-
-
-
-/***** LIBRARY WORKFLOW *****/
-/// Destructor for the Workflow.
-///
-/// # Safety
-/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+/// Constructs a new [`PackageIndex`] that lists the packages in a local directory (i.e., without contacting any instance).
 ///
 /// # Arguments
-/// - `workflow`: The [`Workflow`] to free.
-#[no_mangle]
-pub unsafe extern "C" fn workflow_free(workflow: *mut Workflow) {
-    init_logger();
-    trace!("Destroying Workflow...");
-
-    // Simply capture the box, then drop
-    drop(Box::from_raw(workflow));
-    cleanup_runtime();
-}
-
-
-
-/// Given a workflow, injects an end user into it.
+/// - `packages_dir`: The directory to read the packages from. It is expected to be laid out as `<name>/<version>/package.yml`.
+/// - `pindex`: Will point to the newly created [`PackageIndex`] when done. Will be [`NULL`] if there is an error (see below).
 ///
-/// # Arguments
-/// - `workflow`: The [`Workflow`] to inject into.
-/// - `user`: The name of the user to inject.
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
 ///
 /// # Panics
-/// This function can panic if the given `workflow` is a NULL-pointer, or if the given `user` is not valid UTF-8/a NULL-pointer.
-#[no_mangle]
+/// This function can panic if the given `packages_dir` does not point to a valud UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
-pub unsafe extern "C" fn workflow_set_user(workflow: *mut Workflow, user: *const c_char) {
-    // Set the output to NULL
+#[no_mangle]
+pub unsafe extern "C" fn pindex_new_local(packages_dir: *const c_char, pindex: *mut *mut Arc<ArcSwap<PackageIndex>>) -> *const Error {
     init_logger();
-    info!("Injecting user into workflow...");
+    *pindex = std::ptr::null_mut();
+    info!("Collecting local package index...");
 
-    // Unwrap the input workflow & user
-    let workflow: &mut Workflow = match workflow.as_mut() {
-        Some(wf) => wf,
-        None => {
-            panic!("Given Workflow is a NULL-pointer");
+    // Read the input string
+    let packages_dir: &str = cstr_to_rust(packages_dir);
+
+    // Read the packages in the directory
+    let index: PackageIndex = match get_local_package_index(packages_dir) {
+        Ok(index) => index,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to read local package index from '{packages_dir}': {e}") };
+            return Box::into_raw(Box::new(err));
         },
     };
-    let user: &str = cstr_to_rust(user);
 
-    // Inject one into the other, done
-    workflow.user = Arc::new(Some(user.into()));
-    debug!("End-user is now set to '{user}'");
+    // Store it and we're done
+    debug!("Found {} packages", index.packages.len());
+    *pindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
+    std::ptr::null()
 }
 
-
-
-/// Serializes the workflow by essentially disassembling it.
+/// Constructs a new [`PackageIndex`] from a local cache file written by [`pindex_write_cache()`] or by [`pindex_new_remote_cached()`] (which use the same format).
+///
+/// The file simply holds the index as JSON. It saves contacting the instance, but every process that loads it still reads and parses it in full.
 ///
 /// # Arguments
-/// - `workflow`: The [`Workflow`] to disassemble.
-/// - `assembly`: The serialized assembly of the same workflow, as a string. Don't forget to free it! Will be [`NULL`] if there is an error (see below).
+/// - `path`: The path to the cache file.
+/// - `pindex`: Will point to the newly created [`PackageIndex`] when done. Will be [`NULL`] if there is an error (see below).
 ///
 /// # Returns
 /// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
 ///
 /// # Panics
-/// This function can panic if the given `workflow` is a NULL-pointer.
+/// This function can panic if the given `path` does not point to a valud UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn workflow_disassemble(workflow: *const Workflow, assembly: *mut *mut c_char) -> *const Error {
-    // Set the output to NULL
+pub unsafe extern "C" fn pindex_read_cache(path: *const c_char, pindex: *mut *mut Arc<ArcSwap<PackageIndex>>) -> *const Error {
     init_logger();
-    *assembly = std::ptr::null_mut();
-    info!("Generating workflow assembly...");
+    *pindex = std::ptr::null_mut();
+    info!("Loading package index cache...");
 
-    // Unwrap the input workflow
-    let workflow: &Workflow = match workflow.as_ref() {
-        Some(wf) => wf,
-        None => {
-            panic!("Given Workflow is a NULL-pointer");
+    // Read the input string
+    let path: &str = cstr_to_rust(path);
+
+    // Read the file
+    let raw: Vec<u8> = match std::fs::read(path) {
+        Ok(raw) => raw,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to read package index cache '{path}': {e}") };
+            return Box::into_raw(Box::new(err));
         },
     };
 
-    // Run the compiler traversal to serialize it
-    let mut result: Vec<u8> = Vec::new();
-    if let Err(e) = ast::do_traversal(workflow, &mut result) {
-        let err: Error = Error { msg: format!("Failed to print given workflow: {}", e[0]) };
-        return Box::into_raw(Box::new(err));
+    // Parse it
+    let index: PackageIndex = match PackageIndex::from_reader(raw.as_slice()) {
+        Ok(index) => index,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to parse package index cache '{path}': {e}") };
+            return Box::into_raw(Box::new(err));
+        },
     };
 
-    // Write that in a malloc-allocated area (so C can free it), and then set it in the output
-    *assembly = rust_to_cstr(String::from_utf8_unchecked(result));
-
-    // Done, return that no error occurred
+    // Store it and we're done
+    debug!("Found {} packages (from cache '{}')", index.packages.len(), path);
+    *pindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
     std::ptr::null()
 }
 
-
-
-
-
-/***** LIBRARY COMPILER *****/
-#[derive(Debug)]
-pub struct Compiler {
-    /// The package index to use for compilation.
-    pindex: Arc<Mutex<PackageIndex>>,
-    /// The data index to use for compilation.
-    dindex: Arc<Mutex<DataIndex>>,
-
-    /// The additional, total collected source that we are working with
-    source: String,
-    /// The compile state to use in between snippets.
-    state:  CompileState,
-}
-
-
-
-/// Constructor for the Compiler.
+/// Writes the given [`PackageIndex`] to a local cache file (as JSON), such that it can be loaded later using [`pindex_read_cache()`] without contacting the instance.
+///
+/// The file is written to a temporary file first and then moved into place, so that processes loading it concurrently never see a partial file.
 ///
 /// # Arguments
-/// - `pindex`: The [`PackageIndex`] to resolve package references in the snippets with.
-/// - `dindex`: The [`DataIndex`] to resolve dataset references in the snippets with.
-/// - `compiler`: Will point to the newly created [`Compiler`] when done. Will be [`NULL`] if there is an error (see below).
+/// - `pindex`: The [`PackageIndex`] to write.
+/// - `path`: The path to write the cache file to. Its parent directory will be created if it does not exist.
 ///
 /// # Returns
 /// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
 ///
 /// # Panics
-/// This function can panic if the given `pindex` or `dindex` points to NULL.
+/// This function can panic if the given `pindex` points to NULL, or `path` does not point to a valud UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn compiler_new(
-    pindex: *const Arc<Mutex<PackageIndex>>,
-    dindex: *const Arc<Mutex<DataIndex>>,
-    compiler: *mut *mut Compiler,
-) -> *const Error {
+pub unsafe extern "C" fn pindex_write_cache(pindex: *const Arc<ArcSwap<PackageIndex>>, path: *const c_char) -> *const Error {
     init_logger();
-    *compiler = std::ptr::null_mut();
-    info!("Constructing BraneScript compiler v{}...", env!("CARGO_PKG_VERSION"));
+    info!("Writing package index cache...");
 
-    // Read the indices
-    let pindex: &Arc<Mutex<PackageIndex>> = match pindex.as_ref() {
+    // Read the input
+    let index: &Arc<ArcSwap<PackageIndex>> = match pindex.as_ref() {
         Some(index) => index,
         None => {
             panic!("Given PackageIndex is a NULL-pointer");
         },
     };
-    let dindex: &Arc<Mutex<DataIndex>> = match dindex.as_ref() {
-        Some(index) => index,
-        None => {
-            panic!("Given DataIndex is a NULL-pointer");
+    let path: &str = cstr_to_rust(path);
+    let index: Arc<PackageIndex> = index.load_full();
+
+    // Serialize it in the same format as the index cache
+    let packages: Vec<&PackageInfo> = index.packages.values().collect();
+    let raw: String = match serde_json::to_string(&packages) {
+        Ok(raw) => raw,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to serialize package index: {e}") };
+            return Box::into_raw(Box::new(err));
         },
     };
 
-    // Construct a new Compiler and return it as a pointer
-    *compiler = Box::into_raw(Box::new(Compiler {
-        pindex: pindex.clone(),
-        dindex: dindex.clone(),
-
-        source: String::new(),
-        state:  CompileState::new(),
-    }));
-    debug!("Compiler created");
+    // Write it
+    if let Err(msg) = write_atomically(Path::new(path), raw.as_bytes()) {
+        return Box::into_raw(Box::new(Error { msg }));
+    }
+    debug!("Wrote {} packages to cache '{}'", index.packages.len(), path);
     std::ptr::null()
 }
 
-/// Destructor for the Compiler.
+/// Destructor for the PackageIndex.
 ///
 /// # Safety
 /// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
 ///
 /// # Arguments
-/// - `compiler`: The [`Compiler`] to free.
+/// - `pindex`: The [`PackageIndex`] to free.
 #[no_mangle]
-pub unsafe extern "C" fn compiler_free(compiler: *mut Compiler) {
+pub unsafe extern "C" fn pindex_free(pindex: *mut Arc<ArcSwap<PackageIndex>>) {
     init_logger();
-    trace!("Destroying BraneScript compiler...");
+    trace!("Destroying PackageIndex...");
 
-    // Take ownership of the compiler and then drop it to destroy
-    drop(Box::from_raw(compiler));
+    // Simply capture the box, then drop
+    drop(Box::from_raw(pindex));
     cleanup_runtime();
 }
 
 
 
-/// Compiles the given BraneScript snippet to the BRANE Workflow Representation.
-///
-/// Note that this function changes the `compiler`'s state.
-///
-/// # Safety
-/// Be aware that the returned [`SourceError`] refers the the given `compiler` and `what`. Freeing any of those two and then using the [`SourceError`] _will_ lead to undefined behaviour.
-///
-/// You _must_ free this [`SourceError`] using [`serror_free()`], since its allocated using Rust internals and cannot be deallocated directly using `malloc`. Note, however, that it's safe to call [`serror_free()`] _after_ freeing `compiler` or `what` (but that's the only function).
+
+
+/***** LIBRARY DATAINDEX *****/
+/// Constructs a new [`DataIndex`] that lists the available datasets in a remote instance.
 ///
 /// # Arguments
-/// - `compiler`: The [`Compiler`] to compile with. Essentially this determines which previous compile state to use.
-/// - `what`: Some string describing what we are compiling (e.g., a file, `<intern>`, a cell, etc.)
-/// - `raw`: The raw BraneScript snippet to parse.
-/// - `workflow`: Will point to the compiled AST. Will be [`NULL`] if there is an error (see below).
+/// - `endpoint`: The remote API-endpoint to read the datasets from. The path (`/data/info`) will be deduced and needn't be given, just the host and port.
+/// - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
 ///
 /// # Returns
-/// A [`SourceError`]-struct describing the error, if any, and source warnings/errors.
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
 ///
 /// # Panics
-/// This function can panic if the given `compiler` points to NULL, or `what`/`raw` does not point to a valid UTF-8 string.
+/// This function can panic if the given `endpoint` does not point to a valud UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn compiler_compile(
-    compiler: *mut Compiler,
-    what: *const c_char,
-    raw: *const c_char,
-    workflow: *mut *mut Workflow,
-) -> *const SourceError<'static> {
-    // Initialize the logger if we hadn't already
+pub unsafe extern "C" fn dindex_new_remote(endpoint: *const c_char, dindex: *mut *mut Arc<ArcSwap<DataIndex>>) -> *const Error {
     init_logger();
-    *workflow = std::ptr::null_mut();
-    info!("Compiling snippet...");
-
+    *dindex = std::ptr::null_mut();
+    info!("Collecting data index...");
 
+    // Read the input string
+    let endpoint: &str = cstr_to_rust(endpoint);
 
-    /* INPUT */
-    // Cast the Compiler pointer to a Compiler reference
-    debug!("Reading compiler input...");
-    let compiler: &mut Compiler = match compiler.as_mut() {
-        Some(compiler) => compiler,
-        None => {
-            panic!("Given Compiler is a NULL-pointer");
+    // Create a local threaded tokio context
+    let runtime: Arc<Runtime> = match init_runtime() {
+        Ok(runtime) => runtime,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to create local Tokio context: {e}") };
+            return Box::into_raw(Box::new(err));
         },
     };
 
-    // Get the input as a Rust string
-    let what: &str = cstr_to_rust(what);
-    let raw: &str = cstr_to_rust(raw);
-
-    // Create the error already
-    let mut serr: Box<SourceError> = Box::new(SourceError { file: what, source: String::new(), warns: vec![], errs: vec![], msg: None });
-
-
-
-    /* COMPILE */
-    debug!("Compiling snippet...");
-
-    // Append the source we keep track of
-    compiler.source.push_str(raw);
-    compiler.source.push('\n');
-
-    // Compile that using `brane-ast`
-    serr.source.clone_from(&compiler.source);
-    let wf: Workflow = {
-        // Acquire locks on the indices
-        let pindex: MutexGuard<PackageIndex> = compiler.pindex.lock();
-        let dindex: MutexGuard<DataIndex> = compiler.dindex.lock();
-
-        // Run the snippet
-        match brane_ast::compile_snippet(&mut compiler.state, raw.as_bytes(), &pindex, &dindex, &ParserOptions::bscript()) {
-            CompileResult::Workflow(workflow, warns) => {
-                compiler.state.offset += 1 + raw.chars().filter(|c| *c == '\n').count();
-                serr.warns = warns;
-                workflow
-            },
-
-            CompileResult::Eof(e) => {
-                serr.errs = vec![e];
-                compiler.state.offset += 1 + raw.chars().filter(|c| *c == '\n').count();
-                return Box::into_raw(serr);
-            },
-            CompileResult::Err(errs) => {
-                serr.errs = errs;
-                compiler.state.offset += 1 + raw.chars().filter(|c| *c == '\n').count();
-                return Box::into_raw(serr);
-            },
-
-            CompileResult::Program(_, _) | CompileResult::Unresolved(_, _) => {
-                unreachable!();
-            },
-        }
+    // Build the package index around it
+    let addr: String = format!("{endpoint}/data/info");
+    let index: DataIndex = match METRICS_DINDEX.measure(|| runtime.block_on(get_data_index(&addr))) {
+        Ok(index) => index,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to read data index from '{addr}': {e}") };
+            return Box::into_raw(Box::new(err));
+        },
     };
 
-    // Write the workflow to the output
-    *workflow = Box::into_raw(Box::new(wf));
-
-    // OK, return the error struct!
-    debug!("Compilation success");
-    Box::into_raw(serr)
+    // Store it and we're done
+    debug!("Found {} datasets", index.iter().count());
+    *dindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
+    std::ptr::null()
 }
 
-
-
-
-
-/***** FULL VALUE *****/
-/// Destructor for the FullValue.
+/// Constructs a new [`DataIndex`] that lists the available datasets in a remote instance, re-using an on-disk copy if it is recent enough.
 ///
-/// # Safety
-/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+/// If the remote has to be contacted, then the downloaded index is written to the cache for subsequent calls (possibly from other processes).
 ///
 /// # Arguments
-/// - `fvalue`: The [`FullValue`] to free.
-#[no_mangle]
+/// - `endpoint`: The remote API-endpoint to read the datasets from. The path (`/data/info`) will be deduced and needn't be given, just the host and port.
+/// - `cache_dir`: The directory where cached indices are stored. Will be created if it does not exist.
+/// - `max_age`: The maximum age (in seconds) of the cached index before it is considered stale and re-downloaded.
+/// - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+///
+/// # Panics
+/// This function can panic if the given `endpoint` or `cache_dir` do not point to a valud UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn dindex_new_remote_cached(
+    endpoint: *const c_char,
+    cache_dir: *const c_char,
+    max_age: u64,
+    dindex: *mut *mut Arc<ArcSwap<DataIndex>>,
+) -> *const Error {
+    init_logger();
+    *dindex = std::ptr::null_mut();
+    info!("Collecting data index (cached)...");
+
+    // Read the input strings
+    let endpoint: &str = cstr_to_rust(endpoint);
+    let cache_path: PathBuf = index_cache_path(Path::new(cstr_to_rust(cache_dir)), "dindex", endpoint);
+
+    // See if we can get away with the cache
+    if let Some(raw) = read_index_cache(&cache_path, Duration::from_secs(max_age)) {
+        match serde_json::from_str::<DataIndex>(&raw) {
+            Ok(index) => {
+                debug!("Found {} datasets (from cache '{}')", index.iter().count(), cache_path.display());
+                *dindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
+                return std::ptr::null();
+            },
+            Err(e) => {
+                warn!("Failed to parse cached data index '{}': {} (re-downloading)", cache_path.display(), e);
+            },
+        }
+    }
+
+    // Create a local threaded tokio context
+    let runtime: Arc<Runtime> = match init_runtime() {
+        Ok(runtime) => runtime,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to create local Tokio context: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Build the package index around it
+    let addr: String = format!("{endpoint}/data/info");
+    let index: DataIndex = match METRICS_DINDEX.measure(|| runtime.block_on(get_data_index(&addr))) {
+        Ok(index) => index,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to read data index from '{addr}': {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Update the cache
+    match serde_json::to_string(&index) {
+        Ok(raw) => write_index_cache(&cache_path, &raw),
+        Err(e) => warn!("Failed to serialize data index: {e} (not caching index)"),
+    }
+
+    // Store it and we're done
+    debug!("Found {} datasets", index.iter().count());
+    *dindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
+    std::ptr::null()
+}
+
+/// Constructs a new [`DataIndex`] that lists the datasets in a local directory (i.e., without contacting any instance).
+///
+/// # Arguments
+/// - `datasets_dir`: The directory to read the datasets from. It is expected to be laid out as `<name>/data.yml`.
+/// - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+///
+/// # Panics
+/// This function can panic if the given `datasets_dir` does not point to a valud UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn dindex_new_local(datasets_dir: *const c_char, dindex: *mut *mut Arc<ArcSwap<DataIndex>>) -> *const Error {
+    init_logger();
+    *dindex = std::ptr::null_mut();
+    info!("Collecting local data index...");
+
+    // Read the input string
+    let datasets_dir: &str = cstr_to_rust(datasets_dir);
+
+    // Read the datasets in the directory
+    let index: DataIndex = match get_local_data_index(datasets_dir) {
+        Ok(index) => index,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to read local data index from '{datasets_dir}': {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Store it and we're done
+    debug!("Found {} datasets", index.iter().count());
+    *dindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
+    std::ptr::null()
+}
+
+/// Constructs a new [`DataIndex`] from a local cache file written by [`dindex_write_cache()`] or by [`dindex_new_remote_cached()`] (which use the same format).
+///
+/// The file simply holds the index as JSON. It saves contacting the instance, but every process that loads it still reads and parses it in full.
+///
+/// # Arguments
+/// - `path`: The path to the cache file.
+/// - `dindex`: Will point to the newly created [`DataIndex`] when done. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+///
+/// # Panics
+/// This function can panic if the given `path` does not point to a valud UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn dindex_read_cache(path: *const c_char, dindex: *mut *mut Arc<ArcSwap<DataIndex>>) -> *const Error {
+    init_logger();
+    *dindex = std::ptr::null_mut();
+    info!("Loading data index cache...");
+
+    // Read the input string
+    let path: &str = cstr_to_rust(path);
+
+    // Read the file
+    let raw: Vec<u8> = match std::fs::read(path) {
+        Ok(raw) => raw,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to read data index cache '{path}': {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Parse it
+    let index: DataIndex = match serde_json::from_slice::<DataIndex>(&raw) {
+        Ok(index) => index,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to parse data index cache '{path}': {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Store it and we're done
+    debug!("Found {} datasets (from cache '{}')", index.iter().count(), path);
+    *dindex = Box::into_raw(Box::new(Arc::new(ArcSwap::from_pointee(index))));
+    std::ptr::null()
+}
+
+/// Writes the given [`DataIndex`] to a local cache file (as JSON), such that it can be loaded later using [`dindex_read_cache()`] without contacting the instance.
+///
+/// The file is written to a temporary file first and then moved into place, so that processes loading it concurrently never see a partial file.
+///
+/// # Arguments
+/// - `dindex`: The [`DataIndex`] to write.
+/// - `path`: The path to write the cache file to. Its parent directory will be created if it does not exist.
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+///
+/// # Panics
+/// This function can panic if the given `dindex` points to NULL, or `path` does not point to a valud UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn dindex_write_cache(dindex: *const Arc<ArcSwap<DataIndex>>, path: *const c_char) -> *const Error {
+    init_logger();
+    info!("Writing data index cache...");
+
+    // Read the input
+    let index: &Arc<ArcSwap<DataIndex>> = match dindex.as_ref() {
+        Some(index) => index,
+        None => {
+            panic!("Given DataIndex is a NULL-pointer");
+        },
+    };
+    let path: &str = cstr_to_rust(path);
+    let index: Arc<DataIndex> = index.load_full();
+
+    // Serialize it in the same format as the index cache
+    let raw: String = match serde_json::to_string(&*index) {
+        Ok(raw) => raw,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to serialize data index: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Write it
+    if let Err(msg) = write_atomically(Path::new(path), raw.as_bytes()) {
+        return Box::into_raw(Box::new(Error { msg }));
+    }
+    debug!("Wrote {} datasets to cache '{}'", index.iter().count(), path);
+    std::ptr::null()
+}
+
+/// Destructor for the DataIndex.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `dindex`: The [`DataIndex`] to free.
+#[no_mangle]
+pub unsafe extern "C" fn dindex_free(dindex: *mut Arc<ArcSwap<DataIndex>>) {
+    init_logger();
+    trace!("Destroying DataIndex...");
+
+    // Simply capture the box, then drop
+    drop(Box::from_raw(dindex));
+    cleanup_runtime();
+}
+
+
+
+
+
+/***** LIBRARY WORKFLOW *****/
+/// Destructor for the Workflow.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to free.
+#[no_mangle]
+pub unsafe extern "C" fn workflow_free(workflow: *mut Workflow) {
+    init_logger();
+    trace!("Destroying Workflow...");
+
+    // Simply capture the box, then drop
+    drop(Box::from_raw(workflow));
+    cleanup_runtime();
+}
+
+
+
+/// Given a workflow, injects an end user into it.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to inject into.
+/// - `user`: The name of the user to inject.
+///
+/// # Panics
+/// This function can panic if the given `workflow` is a NULL-pointer, or if the given `user` is not valid UTF-8/a NULL-pointer.
+#[no_mangle]
+#[allow(clippy::missing_safety_doc)]
+pub unsafe extern "C" fn workflow_set_user(workflow: *mut Workflow, user: *const c_char) {
+    // Set the output to NULL
+    init_logger();
+    info!("Injecting user into workflow...");
+
+    // Unwrap the input workflow & user
+    let workflow: &mut Workflow = match workflow.as_mut() {
+        Some(wf) => wf,
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+    let user: &str = cstr_to_rust(user);
+
+    // Inject one into the other, done
+    workflow.user = Arc::new(Some(user.into()));
+    debug!("End-user is now set to '{user}'");
+}
+
+/// Creates a copy of the given workflow.
+///
+/// This is cheap, since the compiled parts of the workflow are shared between the copies. Changing one copy (e.g., with [`workflow_set_user()`] or [`workflow_bind()`]) does not affect the others.
+///
+/// The copy gets a new ID, since the driver and the checkers identify submissions by it and copies are typically submitted alongside each other.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to copy.
+///
+/// # Returns
+/// A new [`Workflow`] that is the same as `workflow` except for its ID. Has to be freed using [`workflow_free()`].
+///
+/// # Panics
+/// This function can panic if the given `workflow` is a NULL-pointer.
+#[no_mangle]
+#[allow(clippy::missing_safety_doc)]
+pub unsafe extern "C" fn workflow_clone(workflow: *const Workflow) -> *mut Workflow {
+    init_logger();
+    trace!("Cloning Workflow...");
+
+    // Unwrap the input workflow
+    let workflow: &Workflow = match workflow.as_ref() {
+        Some(wf) => wf,
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+
+    // The workflow's parts are all behind `Arc`s, so this only bumps reference counts
+    Box::into_raw(Box::new(Workflow { id: generate_random_workflow_id(), ..workflow.clone() }))
+}
+
+
+
+/// Replaces the literal that initializes a top-level variable of the given workflow.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to bind in.
+/// - `name`: The name of the variable to bind.
+/// - `value`: The [`FullValue`] to bind it to. Must have the same type as the literal it replaces, except that integers may replace reals.
+///
+/// # Errors
+/// This function errors if the variable is not assigned exactly once in the main body of the workflow, if it is not assigned a literal, or if the value has the wrong type.
+fn bind_param(workflow: &mut Workflow, name: &str, value: &FullValue) -> Result<(), String> {
+    // Find all places where the variable is assigned in the main body
+    let mut sites: Vec<(usize, usize, usize)> = vec![];
+    for (e, edge) in workflow.graph.iter().enumerate() {
+        if let Edge::Linear { instrs, .. } = edge {
+            for (i, instr) in instrs.iter().enumerate() {
+                if let EdgeInstr::VarSet { def } = instr {
+                    if workflow.table.vars.get(*def).map(|var| var.name == name).unwrap_or(false) {
+                        sites.push((e, i, *def));
+                    }
+                }
+            }
+        }
+    }
+    let (e, i, def): (usize, usize, usize) = match sites.as_slice() {
+        [site] => *site,
+        [] => return Err(format!("Workflow has no top-level variable '{name}'")),
+        _ => return Err(format!("Variable '{name}' is assigned {} times", sites.len())),
+    };
+
+    // Build the new literal based on the old one
+    let literal: &EdgeInstr = match &workflow.graph[e] {
+        Edge::Linear { instrs, .. } if i > 0 => &instrs[i - 1],
+        _ => return Err(format!("Variable '{name}' is not assigned a literal")),
+    };
+    let literal: EdgeInstr = match (literal, value) {
+        (EdgeInstr::Boolean { .. }, FullValue::Boolean(value)) => EdgeInstr::Boolean { value: *value },
+        (EdgeInstr::Integer { .. }, FullValue::Integer(value)) => EdgeInstr::Integer { value: *value },
+        (EdgeInstr::Real { .. }, FullValue::Real(value)) => EdgeInstr::Real { value: *value },
+        (EdgeInstr::Real { .. }, FullValue::Integer(value)) => EdgeInstr::Real { value: *value as f64 },
+        (EdgeInstr::String { .. }, FullValue::String(value)) => EdgeInstr::String { value: value.clone() },
+        (EdgeInstr::Boolean { .. } | EdgeInstr::Integer { .. } | EdgeInstr::Real { .. } | EdgeInstr::String { .. }, value) => {
+            let data_type: &DataType = &workflow.table.vars[def].data_type;
+            return Err(format!("Cannot bind {} value to variable '{}' of type {}", value.data_type(), name, data_type));
+        },
+        _ => return Err(format!("Variable '{name}' is not assigned a literal")),
+    };
+
+    // Only copy the main body (if it is shared with other workflows), then replace it
+    if let Edge::Linear { instrs, .. } = &mut Arc::make_mut(&mut workflow.graph)[e] {
+        instrs[i - 1] = literal;
+    }
+    Ok(())
+}
+
+/// Renames a dataset in the given edges.
+///
+/// # Arguments
+/// - `edges`: The edges to rename in.
+/// - `data_class`: The index of the builtin `Data`-class in the workflow's table.
+/// - `from`: The name of the dataset to replace.
+/// - `to`: The name of the dataset to replace it with.
+///
+/// # Returns
+/// A copy of the `edges` with the dataset renamed, or [`None`] if they do not mention it.
+fn rename_dataset(edges: &[Edge], data_class: Option<usize>, from: &str, to: &str) -> Option<Vec<Edge>> {
+    let rename = |name: &DataName| -> DataName {
+        match name {
+            DataName::Data(name) if name == from => DataName::Data(to.into()),
+            name => name.clone(),
+        }
+    };
+
+    let mut changed: bool = false;
+    let mut renamed: Vec<Edge> = edges.to_vec();
+    for edge in &mut renamed {
+        match edge {
+            // Rename the literal in any `new Data { name := ... }`
+            Edge::Linear { instrs, .. } => {
+                for i in 1..instrs.len() {
+                    if !matches!(instrs[i], EdgeInstr::Instance { def } if Some(def) == data_class) {
+                        continue;
+                    }
+                    if let EdgeInstr::String { value } = &mut instrs[i - 1] {
+                        if value == from {
+                            *value = to.into();
+                            changed = true;
+                        }
+                    }
+                }
+            },
+
+            // Rename the inputs and outputs that the compiler derived from them
+            Edge::Node { input, .. } => {
+                if input.keys().any(|name| matches!(name, DataName::Data(name) if name == from)) {
+                    // Its availability is no longer known; the planner resolves it again
+                    *input = input
+                        .iter()
+                        .map(|(name, avail)| if rename(name) != *name { (rename(name), None) } else { (name.clone(), avail.clone()) })
+                        .collect();
+                    changed = true;
+                }
+            },
+            Edge::Call { input, result, .. } => {
+                if input.iter().chain(result.iter()).any(|name| matches!(name, DataName::Data(name) if name == from)) {
+                    *input = input.iter().map(rename).collect();
+                    *result = result.iter().map(rename).collect();
+                    changed = true;
+                }
+            },
+            Edge::Return { result } => {
+                if result.iter().any(|name| matches!(name, DataName::Data(name) if name == from)) {
+                    *result = result.iter().map(rename).collect();
+                    changed = true;
+                }
+            },
+
+            Edge::Stop {} | Edge::Branch { .. } | Edge::Parallel { .. } | Edge::Join { .. } | Edge::Loop { .. } => {},
+        }
+    }
+    if changed { Some(renamed) } else { None }
+}
+
+/// Binds a value to a top-level variable of the given workflow, without compiling it again.
+///
+/// The variable must be assigned a literal exactly once in the main body of the workflow (e.g., `let n := 42;`), which is then replaced by the given value. Use [`workflow_bind_dataset()`] to change the datasets that a workflow uses instead.
+///
+/// Combined with [`workflow_clone()`], this allows one compiled workflow to be submitted many times with different inputs.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to bind in. Other copies of it are not affected.
+/// - `name`: The name of the variable to bind.
+/// - `value`: The [`FullValue`] to bind it to. Must be a boolean, integer, real or string of the same type as the variable (although integers may be bound to reals).
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function can panic if the given `workflow` or `value` is a NULL-pointer, or if the given `name` is not valid UTF-8/a NULL-pointer.
+#[no_mangle]
+#[allow(clippy::missing_safety_doc)]
+pub unsafe extern "C" fn workflow_bind(workflow: *mut Workflow, name: *const c_char, value: *const FullValue) -> *const Error {
+    init_logger();
+    info!("Binding value in workflow...");
+
+    // Unwrap the input
+    let workflow: &mut Workflow = match workflow.as_mut() {
+        Some(wf) => wf,
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+    let name: &str = cstr_to_rust(name);
+    let value: &FullValue = match value.as_ref() {
+        Some(value) => value,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Do the binding
+    if let Err(msg) = bind_param(workflow, name, value) {
+        return Box::into_raw(Box::new(Error { msg: format!("Failed to bind '{name}': {msg}") }));
+    }
+    debug!("Variable '{name}' is now bound to '{value}'");
+    std::ptr::null()
+}
+
+/// Replaces a dataset used by the given workflow with another, without compiling it again.
+///
+/// This changes every `new Data { name := "<from>" }` in the workflow, as well as the inputs of the tasks that use it. The new dataset does not have to be known at compile time; the remote resolves where it is when planning.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to bind in. Other copies of it are not affected.
+/// - `from`: The name of the dataset to replace.
+/// - `to`: The name of the dataset to replace it with.
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred (i.e., the workflow does not use `from`), or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function can panic if the given `workflow` is a NULL-pointer, or if the given `from` or `to` is not valid UTF-8/a NULL-pointer.
+#[no_mangle]
+#[allow(clippy::missing_safety_doc)]
+pub unsafe extern "C" fn workflow_bind_dataset(workflow: *mut Workflow, from: *const c_char, to: *const c_char) -> *const Error {
+    init_logger();
+    info!("Binding dataset in workflow...");
+
+    // Unwrap the input
+    let workflow: &mut Workflow = match workflow.as_mut() {
+        Some(wf) => wf,
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+    let from: &str = cstr_to_rust(from);
+    let to: &str = cstr_to_rust(to);
+
+    // Rename it in the main body and every function body, only copying those that mention it
+    let data_class: Option<usize> = workflow.table.classes.iter().position(|class| class.name == "Data" && class.package.is_none());
+    let mut changed: bool = false;
+    if let Some(graph) = rename_dataset(&workflow.graph, data_class, from, to) {
+        workflow.graph = Arc::new(graph);
+        changed = true;
+    }
+    let funcs: Vec<(usize, Vec<Edge>)> =
+        workflow.funcs.iter().filter_map(|(id, edges)| rename_dataset(edges, data_class, from, to).map(|edges| (*id, edges))).collect();
+    if !funcs.is_empty() {
+        Arc::make_mut(&mut workflow.funcs).extend(funcs);
+        changed = true;
+    }
+    if !changed {
+        return Box::into_raw(Box::new(Error { msg: format!("Workflow does not use dataset '{from}'") }));
+    }
+    debug!("Dataset '{from}' is now replaced by '{to}'");
+    std::ptr::null()
+}
+
+
+
+/// Disassembles the given workflow into a Rust string.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to disassemble.
+///
+/// # Returns
+/// The serialized assembly of the workflow.
+///
+/// # Errors
+/// This function errors if the compiler's printing traversal failed.
+fn disassemble(workflow: &Workflow) -> Result<String, Error> {
+    METRICS_DISASSEMBLE.measure(|| {
+        let mut result: Vec<u8> = Vec::new();
+        if let Err(e) = ast::do_traversal(workflow, &mut result) {
+            return Err(Error { msg: format!("Failed to print given workflow: {}", e[0]) });
+        };
+        Ok(String::from_utf8_lossy(&result).into_owned())
+    })
+}
+
+/// Serializes the workflow by essentially disassembling it.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to disassemble.
+/// - `assembly`: The serialized assembly of the same workflow, as a string. Don't forget to free it! Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+///
+/// # Panics
+/// This function can panic if the given `workflow` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn workflow_disassemble(workflow: *const Workflow, assembly: *mut *mut c_char) -> *const Error {
+    // Set the output to NULL
+    init_logger();
+    *assembly = std::ptr::null_mut();
+    info!("Generating workflow assembly...");
+
+    // Unwrap the input workflow
+    let workflow: &Workflow = match workflow.as_ref() {
+        Some(wf) => wf,
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+
+    // Run the compiler traversal to serialize it
+    let result: String = match disassemble(workflow) {
+        Ok(result) => result,
+        Err(err) => return Box::into_raw(Box::new(err)),
+    };
+
+    // Write that in a malloc-allocated area (so C can free it), and then set it in the output
+    *assembly = rust_to_cstr(result);
+
+    // Done, return that no error occurred
+    std::ptr::null()
+}
+
+/// Serializes the workflow by essentially disassembling it, writing it to a buffer given by the caller `snprintf`-style.
+///
+/// # Arguments
+/// - `workflow`: The [`Workflow`] to disassemble.
+/// - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+/// - `len`: The size of the `buffer`, in bytes.
+/// - `written`: Will be set to the length of the complete assembly (excluding the null-byte). If this is `len` or more, it was truncated; call again with a buffer of at least this length + 1.
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+///
+/// # Panics
+/// This function can panic if the given `workflow` or `written` are NULL-pointers.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn workflow_disassemble_into(workflow: *const Workflow, buffer: *mut c_char, len: usize, written: *mut usize) -> *const Error {
+    // Set the output to nothing
+    init_logger();
+    *written = 0;
+    info!("Generating workflow assembly...");
+
+    // Unwrap the input workflow
+    let workflow: &Workflow = match workflow.as_ref() {
+        Some(wf) => wf,
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+
+    // Run the compiler traversal to serialize it
+    let result: String = match disassemble(workflow) {
+        Ok(result) => result,
+        Err(err) => return Box::into_raw(Box::new(err)),
+    };
+
+    // Write that to the caller's buffer
+    *written = rust_to_buffer(&result, buffer, len);
+
+    // Done, return that no error occurred
+    std::ptr::null()
+}
+
+
+
+
+
+/***** LIBRARY COMPILER *****/
+#[derive(Debug)]
+pub struct Compiler {
+    /// The package index to use for compilation.
+    pindex: Arc<ArcSwap<PackageIndex>>,
+    /// The data index to use for compilation.
+    dindex: Arc<ArcSwap<DataIndex>>,
+
+    /// The additional, total collected source that we are working with
+    source: SourceStore,
+    /// The compile state to use in between snippets.
+    state:  CompileState,
+}
+
+
+/// Compiles a single snippet, appending it to the given source store.
+///
+/// # Arguments
+/// - `state`: The [`CompileState`] to compile on top of. Will be updated with the new snippet.
+/// - `source`: The [`SourceStore`] to which the snippet is appended.
+/// - `what`: Some string describing what we are compiling.
+/// - `raw`: The raw BraneScript snippet to parse.
+/// - `pindex`: The [`PackageIndex`] to resolve package references in the snippet with.
+/// - `dindex`: The [`DataIndex`] to resolve dataset references in the snippet with.
+///
+/// # Returns
+/// The compiled [`Workflow`] if compilation succeeded, together with a [`SourceError`] describing any warnings and/or errors.
+fn compile_unit<'f>(
+    state: &mut CompileState,
+    source: &SourceStore,
+    what: &'f str,
+    raw: &str,
+    pindex: &PackageIndex,
+    dindex: &DataIndex,
+) -> (Option<Workflow>, Box<SourceError<'f>>) {
+    // Create the error already, together with the source it references
+    let mut serr: Box<SourceError> = SourceError::new(what, Some(source.append(raw)));
+
+    // Compile that using `brane-ast`
+    let res: CompileResult = brane_ast::compile_snippet(state, raw.as_bytes(), pindex, dindex, &ParserOptions::bscript());
+    state.offset += 1 + raw.chars().filter(|c| *c == '\n').count();
+    match res {
+        CompileResult::Workflow(workflow, warns) => {
+            serr.warns = warns;
+            (Some(workflow), serr)
+        },
+
+        CompileResult::Eof(e) => {
+            serr.errs = vec![e];
+            (None, serr)
+        },
+        CompileResult::Err(errs) => {
+            serr.errs = errs;
+            (None, serr)
+        },
+
+        CompileResult::Program(_, _) | CompileResult::Unresolved(_, _) => {
+            unreachable!();
+        },
+    }
+}
+
+/// Compiles a single snippet like [`compile_unit()`], but consults the [`COMPILE_CACHE`] first.
+///
+/// Only snippets compiled on a fresh [`CompileState`] are cached, since otherwise the result depends on earlier snippets too. Compilations that emit warnings are not cached either, so that they are shown every time.
+///
+/// # Arguments
+/// - `state`: The [`CompileState`] to compile on top of. Will be updated with the new snippet.
+/// - `source`: The [`SourceStore`] to which the snippet is appended.
+/// - `what`: Some string describing what we are compiling.
+/// - `raw`: The raw BraneScript snippet to parse.
+/// - `pindex`: The [`PackageIndex`] snapshot to resolve package references in the snippet with.
+/// - `dindex`: The [`DataIndex`] snapshot to resolve dataset references in the snippet with.
+///
+/// # Returns
+/// The compiled [`Workflow`] if compilation succeeded, together with a [`SourceError`] describing any warnings and/or errors.
+fn compile_unit_cached<'f>(
+    state: &mut CompileState,
+    source: &SourceStore,
+    what: &'f str,
+    raw: &str,
+    pindex: &Arc<PackageIndex>,
+    dindex: &Arc<DataIndex>,
+) -> (Option<Workflow>, Box<SourceError<'f>>) {
+    // Only fresh states are cacheable
+    if state.offset > 0 {
+        return compile_unit(state, source, what, raw, pindex, dindex);
+    }
+    let key: CompileKey = CompileKey { raw: raw.into(), pindex: Arc::as_ptr(pindex) as usize, dindex: Arc::as_ptr(dindex) as usize };
+
+    // See if we've seen it before
+    let hit: Option<(Workflow, CompileState)> =
+        COMPILE_CACHE.lock().as_ref().and_then(|cache| cache.entries.get(&key)).map(|entry| (entry.workflow.clone(), entry.state.clone()));
+    if let Some((workflow, new_state)) = hit {
+        COMPILE_CACHE_HITS.fetch_add(1, Ordering::Relaxed);
+        debug!("Found compiled snippet in cache");
+        *state = new_state;
+        let serr: Box<SourceError> = SourceError::new(what, Some(source.append(raw)));
+        // Every compilation is a separate submission to the driver and checkers, so it needs its own ID
+        return (Some(Workflow { id: generate_random_workflow_id(), ..workflow }), serr);
+    }
+    COMPILE_CACHE_MISSES.fetch_add(1, Ordering::Relaxed);
+
+    // Otherwise, compile it and remember it if it's clean
+    let (workflow, serr): (Option<Workflow>, Box<SourceError>) = compile_unit(state, source, what, raw, pindex, dindex);
+    if let Some(workflow) = &workflow {
+        if serr.warns.is_empty() {
+            let entry: CompileEntry =
+                CompileEntry { workflow: workflow.clone(), state: state.clone(), pindex: Arc::downgrade(pindex), dindex: Arc::downgrade(dindex) };
+            COMPILE_CACHE.lock().get_or_insert_with(CompileCache::default).insert(key, entry);
+        }
+    }
+    (workflow, serr)
+}
+
+
+
+/// Constructor for the Compiler.
+///
+/// # Arguments
+/// - `pindex`: The [`PackageIndex`] to resolve package references in the snippets with.
+/// - `dindex`: The [`DataIndex`] to resolve dataset references in the snippets with.
+/// - `compiler`: Will point to the newly created [`Compiler`] when done. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// [`Null`] in all cases except when an error occurs. Then, an [`Error`]-struct is returned describing the error. Don't forget this has to be freed using [`error_free()`]!
+///
+/// # Panics
+/// This function can panic if the given `pindex` or `dindex` points to NULL.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn compiler_new(
+    pindex: *const Arc<ArcSwap<PackageIndex>>,
+    dindex: *const Arc<ArcSwap<DataIndex>>,
+    compiler: *mut *mut Compiler,
+) -> *const Error {
+    init_logger();
+    *compiler = std::ptr::null_mut();
+    info!("Constructing BraneScript compiler v{}...", env!("CARGO_PKG_VERSION"));
+
+    // Read the indices
+    let pindex: &Arc<ArcSwap<PackageIndex>> = match pindex.as_ref() {
+        Some(index) => index,
+        None => {
+            panic!("Given PackageIndex is a NULL-pointer");
+        },
+    };
+    let dindex: &Arc<ArcSwap<DataIndex>> = match dindex.as_ref() {
+        Some(index) => index,
+        None => {
+            panic!("Given DataIndex is a NULL-pointer");
+        },
+    };
+
+    // Construct a new Compiler and return it as a pointer
+    *compiler = Box::into_raw(Box::new(Compiler {
+        pindex: pindex.clone(),
+        dindex: dindex.clone(),
+
+        source: SourceStore::default(),
+        state:  CompileState::new(),
+    }));
+    debug!("Compiler created");
+    std::ptr::null()
+}
+
+/// Destructor for the Compiler.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `compiler`: The [`Compiler`] to free.
+#[no_mangle]
+pub unsafe extern "C" fn compiler_free(compiler: *mut Compiler) {
+    init_logger();
+    trace!("Destroying BraneScript compiler...");
+
+    // Take ownership of the compiler and then drop it to destroy
+    drop(Box::from_raw(compiler));
+    cleanup_runtime();
+}
+
+
+
+/// Compiles the given BraneScript snippet to the BRANE Workflow Representation.
+///
+/// Note that this function changes the `compiler`'s state.
+///
+/// If this is the first snippet given to the `compiler`, the result may be served from a process-wide cache (see [`compiler_cache_stats()`]).
+///
+/// # Safety
+/// Be aware that the returned [`SourceError`] refers the the given `compiler` and `what`. Freeing any of those two and then using the [`SourceError`] _will_ lead to undefined behaviour.
+///
+/// You _must_ free this [`SourceError`] using [`serror_free()`], since its allocated using Rust internals and cannot be deallocated directly using `malloc`. Note, however, that it's safe to call [`serror_free()`] _after_ freeing `compiler` or `what` (but that's the only function).
+///
+/// # Arguments
+/// - `compiler`: The [`Compiler`] to compile with. Essentially this determines which previous compile state to use.
+/// - `what`: Some string describing what we are compiling (e.g., a file, `<intern>`, a cell, etc.)
+/// - `raw`: The raw BraneScript snippet to parse.
+/// - `workflow`: Will point to the compiled AST. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// A [`SourceError`]-struct describing the error, if any, and source warnings/errors.
+///
+/// # Panics
+/// This function can panic if the given `compiler` points to NULL, or `what`/`raw` does not point to a valid UTF-8 string.
+#[no_mangle]
+pub unsafe extern "C" fn compiler_compile(
+    compiler: *mut Compiler,
+    what: *const c_char,
+    raw: *const c_char,
+    workflow: *mut *mut Workflow,
+) -> *const SourceError<'static> {
+    // Initialize the logger if we hadn't already
+    init_logger();
+    *workflow = std::ptr::null_mut();
+    info!("Compiling snippet...");
+
+
+
+    /* INPUT */
+    // Cast the Compiler pointer to a Compiler reference
+    debug!("Reading compiler input...");
+    let compiler: &mut Compiler = match compiler.as_mut() {
+        Some(compiler) => compiler,
+        None => {
+            panic!("Given Compiler is a NULL-pointer");
+        },
+    };
+
+    // Get the input as a Rust string
+    let what: &str = cstr_to_rust(what);
+    let raw: &str = cstr_to_rust(raw);
+
+
+
+    /* COMPILE */
+    debug!("Compiling snippet...");
+    let (wf, serr): (Option<Workflow>, Box<SourceError>) = {
+        // Take a snapshot of the indices
+        let pindex: Arc<PackageIndex> = compiler.pindex.load_full();
+        let dindex: Arc<DataIndex> = compiler.dindex.load_full();
+
+        // Run the snippet
+        METRICS_COMPILE
+            .measure_with(|| compile_unit_cached(&mut compiler.state, &compiler.source, what, raw, &pindex, &dindex), |(wf, _)| wf.is_some())
+    };
+
+    // Write the workflow to the output
+    if let Some(wf) = wf {
+        *workflow = Box::into_raw(Box::new(wf));
+        debug!("Compilation success");
+    }
+
+    // OK, return the error struct!
+    Box::into_raw(serr)
+}
+
+/// Compiles many independent BraneScript snippets to the BRANE Workflow Representation in parallel.
+///
+/// Unlike [`compiler_compile()`], every snippet is compiled as if it were the first snippet given to a fresh [`Compiler`]; i.e., they cannot refer to each other, and the `compiler`'s own state is not used nor changed. Only its indices are used, of which a single snapshot is taken for the entire batch.
+///
+/// # Safety
+/// Be aware that the returned [`SourceError`]s refer to the given `whats`. Freeing any of those and then using the matching [`SourceError`] _will_ lead to undefined behaviour.
+///
+/// You _must_ free every returned [`SourceError`] using [`serror_free()`], and every returned [`Workflow`] using [`workflow_free()`].
+///
+/// # Arguments
+/// - `compiler`: The [`Compiler`] of which to use the indices.
+/// - `whats`: An array of `n` strings describing what we are compiling (e.g., a file, `<intern>`, a cell, etc.)
+/// - `raws`: An array of `n` raw BraneScript snippets to parse.
+/// - `n`: The number of snippets in the batch.
+/// - `workflows`: A caller-allocated array of `n` elements. Element `i` will point to the compiled AST of snippet `i`, or [`NULL`] if it failed to compile.
+/// - `serrs`: A caller-allocated array of `n` elements. Element `i` will point to a [`SourceError`]-struct describing the error, if any, and source warnings/errors of snippet `i`.
+///
+/// # Panics
+/// This function can panic if the given `compiler`, `whats`, `raws`, `workflows` or `serrs` point to NULL, or any `what`/`raw` does not point to a valid UTF-8 string.
+#[no_mangle]
+pub unsafe extern "C" fn compiler_compile_batch(
+    compiler: *const Compiler,
+    whats: *const *const c_char,
+    raws: *const *const c_char,
+    n: usize,
+    workflows: *mut *mut Workflow,
+    serrs: *mut *mut SourceError<'static>,
+) {
+    // Initialize the logger if we hadn't already
+    init_logger();
+    info!("Compiling batch of {n} snippets...");
+    if n == 0 {
+        return;
+    }
+
+
+
+    /* INPUT */
+    // Cast the Compiler pointer to a Compiler reference
+    debug!("Reading compiler input...");
+    let compiler: &Compiler = match compiler.as_ref() {
+        Some(compiler) => compiler,
+        None => {
+            panic!("Given Compiler is a NULL-pointer");
+        },
+    };
+    if whats.is_null() || raws.is_null() {
+        panic!("Given snippet array is a NULL-pointer");
+    }
+    if workflows.is_null() || serrs.is_null() {
+        panic!("Given output array is a NULL-pointer");
+    }
+
+    // Get the input as Rust strings
+    let units: Vec<(&'static str, &str)> = std::slice::from_raw_parts(whats, n)
+        .iter()
+        .zip(std::slice::from_raw_parts(raws, n))
+        .map(|(w, r)| (cstr_to_rust(*w), cstr_to_rust(*r)))
+        .collect();
+    let workflows: &mut [*mut Workflow] = std::slice::from_raw_parts_mut(workflows, n);
+    let serrs: &mut [*mut SourceError<'static>] = std::slice::from_raw_parts_mut(serrs, n);
+
+
+
+    /* COMPILE */
+    // Take a snapshot of the indices once, and share it among the threads
+    let pindex: Arc<PackageIndex> = compiler.pindex.load_full();
+    let dindex: Arc<DataIndex> = compiler.dindex.load_full();
+    let (pindex, dindex): (&Arc<PackageIndex>, &Arc<DataIndex>) = (&pindex, &dindex);
+
+    // Divide the units over as many threads as we have cores
+    let n_threads: usize = std::thread::available_parallelism().map(|n| n.get()).unwrap_or(1).min(n);
+    let chunk_size: usize = (n + n_threads - 1) / n_threads;
+    debug!("Compiling on {n_threads} threads ({chunk_size} snippets each)...");
+    std::thread::scope(|scope| {
+        let handles: Vec<_> = units
+            .chunks(chunk_size)
+            .map(|chunk| {
+                scope.spawn(move || {
+                    chunk
+                        .iter()
+                        .map(|&(what, raw)| {
+                            METRICS_COMPILE.measure_with(
+                                || compile_unit_cached(&mut CompileState::new(), &SourceStore::default(), what, raw, pindex, dindex),
+                                |(wf, _)| wf.is_some(),
+                            )
+                        })
+                        .collect::<Vec<(Option<Workflow>, Box<SourceError>)>>()
+                })
+            })
+            .collect();
+
+        // Collect the results in order
+        for (i, (wf, serr)) in handles.into_iter().flat_map(|h| h.join().unwrap_or_else(|_| panic!("Compile thread panicked"))).enumerate() {
+            workflows[i] = wf.map(|wf| Box::into_raw(Box::new(wf))).unwrap_or(std::ptr::null_mut());
+            serrs[i] = Box::into_raw(serr);
+        }
+    });
+    debug!("Batch compilation done");
+}
+
+/// Reports how well the process-wide cache of compiled workflows performs.
+///
+/// The cache is consulted by [`compiler_compile()`] for the first snippet given to a [`Compiler`] and by [`compiler_compile_batch()`] for every snippet. It is keyed on the snippet text and on the exact package and data index snapshots compiled against; so replacing an index (e.g., by [`vm_process()`] refreshing it) naturally invalidates the entries.
+///
+/// # Arguments
+/// - `hits`: Will be set to the number of compilations answered from the cache. May be [`NULL`] if not interesting.
+/// - `misses`: Will be set to the number of cacheable compilations that had to be compiled. May be [`NULL`] if not interesting.
+/// - `entries`: Will be set to the number of workflows currently in the cache. May be [`NULL`] if not interesting.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn compiler_cache_stats(hits: *mut u64, misses: *mut u64, entries: *mut usize) {
+    init_logger();
+
+    if let Some(hits) = hits.as_mut() {
+        *hits = COMPILE_CACHE_HITS.load(Ordering::Relaxed);
+    }
+    if let Some(misses) = misses.as_mut() {
+        *misses = COMPILE_CACHE_MISSES.load(Ordering::Relaxed);
+    }
+    if let Some(entries) = entries.as_mut() {
+        *entries = COMPILE_CACHE.lock().as_ref().map(|cache| cache.entries.len()).unwrap_or(0);
+    }
+}
+
+/// Empties the process-wide cache of compiled workflows and resets its counters.
+#[no_mangle]
+pub extern "C" fn compiler_cache_clear() {
+    init_logger();
+    debug!("Clearing compile cache...");
+
+    *COMPILE_CACHE.lock() = None;
+    COMPILE_CACHE_HITS.store(0, Ordering::Relaxed);
+    COMPILE_CACHE_MISSES.store(0, Ordering::Relaxed);
+}
+
+
+
+
+
+/***** FULL VALUE *****/
+/// Destructor for the FullValue.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to free.
+#[no_mangle]
 pub unsafe extern "C" fn fvalue_free(fvalue: *mut FullValue) {
     init_logger();
-    trace!("Destroying FullValue...");
+    trace!("Destroying FullValue...");
+
+    // Take ownership of the value and then drop it to destroy
+    drop(Box::from_raw(fvalue));
+    cleanup_runtime();
+}
+
+
+
+/// Checks if this [`FullValue`] needs processing.
+///
+/// For now, this only occurs when it is a [`FullValue::Data`] (download it) or [`FullValue::IntermediateResult`] (throw a warning).
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to analyse.
+///
+/// # Returns
+/// True if `vm_process()` should be called on this value or false otherwise.
+///
+/// # Panics
+/// This function can panic if `fvalue` pointed to [`NULL`].
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_needs_processing(fvalue: *const FullValue) -> bool {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(vm) => vm,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Match it
+    matches!(fvalue, FullValue::Data(_) | FullValue::IntermediateResult(_))
+}
+
+/// Renders a FullValue as it is shown as result of the workflow.
+///
+/// # Arguments
+/// - `fvalue`: the [`FullValue`] to render.
+/// - `data_dir`: The data directory to which we downloaded the `fvalue`, if we did so.
+///
+/// # Returns
+/// The rendered value. Empty if the value is [`FullValue::Void`].
+fn render_fvalue(fvalue: &FullValue, data_dir: &Path) -> String {
+    // Render the result only if there is anything to serialize
+    let mut sfvalue: String = String::new();
+    if fvalue != &FullValue::Void {
+        writeln!(&mut sfvalue, "\nWorkflow returned value {}", style(format!("'{fvalue}'")).bold().cyan()).unwrap();
+
+        // Treat some values special
+        match fvalue {
+            // Print sommat additional if it's an intermediate result.
+            FullValue::IntermediateResult(_) => {
+                writeln!(&mut sfvalue, "(Intermediate results are not available locally; promote it using 'commit_result()')").unwrap();
+            },
+
+            // If it's a dataset, show where to access it
+            FullValue::Data(name) => {
+                writeln!(&mut sfvalue, "(It's available under '{}')", data_dir.join(name.as_ref()).display()).unwrap();
+            },
+
+            // Nothing for the rest
+            _ => {},
+        }
+    }
+
+    sfvalue
+}
+
+/// Serializes a FullValue to show as result of the workflow.
+///
+/// # Arguments
+/// - `fvalue`: the [`FullValue`] to serialize.
+/// - `data_dir`: The data directory to which we downloaded the `fvalue`, if we did so.
+/// - `result`: The buffer to serialize to. Will be freshly allocated using `malloc` for the correct size; can be freed using `free()`.
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer or if `data_dir` did not point to a valid UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_serialize(fvalue: *const FullValue, data_dir: *const c_char, result: *mut *mut c_char) {
+    *result = std::ptr::null_mut();
+
+    // Unwrap the pointers
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+    let data_dir: PathBuf = PathBuf::from(cstr_to_rust(data_dir));
+
+    // That's what we serialize to the output
+    *result = rust_to_cstr(METRICS_SERIALIZE.measure_with(|| render_fvalue(fvalue, &data_dir), |_| true));
+
+    // Done!
+}
+
+/// Serializes a FullValue to show as result of the workflow, writing it to a buffer given by the caller `snprintf`-style.
+///
+/// # Arguments
+/// - `fvalue`: the [`FullValue`] to serialize.
+/// - `data_dir`: The data directory to which we downloaded the `fvalue`, if we did so.
+/// - `buffer`: The buffer to serialize to. At most `len - 1` bytes are written, followed by a null-byte. May be [`NULL`] if `len` is 0.
+/// - `len`: The size of the `buffer`, in bytes.
+///
+/// # Returns
+/// The length of the complete serialized value (excluding the null-byte). If this is `len` or more, it was truncated; call again with a buffer of at least the returned length + 1.
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer or if `data_dir` did not point to a valid UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_serialize_into(fvalue: *const FullValue, data_dir: *const c_char, buffer: *mut c_char, len: usize) -> usize {
+    // Unwrap the pointers
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+    let data_dir: PathBuf = PathBuf::from(cstr_to_rust(data_dir));
+
+    // Write it to the caller's buffer
+    rust_to_buffer(&METRICS_SERIALIZE.measure_with(|| render_fvalue(fvalue, &data_dir), |_| true), buffer, len)
+}
+
+
+
+/// Defines the kinds of [`FullValue`]s, as returned by [`fvalue_kind()`].
+#[derive(Clone, Copy, Debug, Eq, PartialEq)]
+#[repr(C)]
+pub enum FullValueKind {
+    /// The value is a [`FullValue::Void`].
+    Void  = 0,
+    /// The value is a [`FullValue::Boolean`] (see [`fvalue_get_bool()`]).
+    Boolean = 1,
+    /// The value is a [`FullValue::Integer`] (see [`fvalue_get_int()`]).
+    Integer = 2,
+    /// The value is a [`FullValue::Real`] (see [`fvalue_get_real()`]).
+    Real  = 3,
+    /// The value is a [`FullValue::String`] (see [`fvalue_get_string()`]).
+    String = 4,
+    /// The value is a [`FullValue::Array`] (see [`fvalue_array_len()`] and [`fvalue_array_get()`]).
+    Array = 5,
+    /// The value is a [`FullValue::Instance`] (see [`fvalue_get_class()`] and [`fvalue_field()`]).
+    Instance = 6,
+    /// The value is a [`FullValue::Data`] (see [`fvalue_get_string()`]).
+    Data  = 7,
+    /// The value is a [`FullValue::IntermediateResult`] (see [`fvalue_get_string()`]).
+    IntermediateResult = 8,
+}
+
+/// Returns the kind of the given [`FullValue`], so that it can be read with the matching accessor without serializing it.
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to inspect.
+///
+/// # Returns
+/// The [`FullValueKind`] of `fvalue`.
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_kind(fvalue: *const FullValue) -> FullValueKind {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Match it
+    match fvalue {
+        FullValue::Void => FullValueKind::Void,
+        FullValue::Boolean(_) => FullValueKind::Boolean,
+        FullValue::Integer(_) => FullValueKind::Integer,
+        FullValue::Real(_) => FullValueKind::Real,
+        FullValue::String(_) => FullValueKind::String,
+        FullValue::Array(_) => FullValueKind::Array,
+        FullValue::Instance(_, _) => FullValueKind::Instance,
+        FullValue::Data(_) => FullValueKind::Data,
+        FullValue::IntermediateResult(_) => FullValueKind::IntermediateResult,
+    }
+}
+
+/// Reads the given [`FullValue`] as a boolean.
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `value`: Will be set to the boolean value if `fvalue` is a [`FullValue::Boolean`]. Left untouched otherwise.
+///
+/// # Returns
+/// Whether `fvalue` was a [`FullValue::Boolean`].
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_get_bool(fvalue: *const FullValue, value: *mut bool) -> bool {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Read it if it's the correct type
+    match fvalue.as_bool() {
+        Some(inner) => {
+            *value = inner;
+            true
+        },
+        None => false,
+    }
+}
+
+/// Reads the given [`FullValue`] as an integer.
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `value`: Will be set to the integer value if `fvalue` is a [`FullValue::Integer`]. Left untouched otherwise.
+///
+/// # Returns
+/// Whether `fvalue` was a [`FullValue::Integer`].
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_get_int(fvalue: *const FullValue, value: *mut i64) -> bool {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Read it if it's the correct type
+    match fvalue.as_int() {
+        Some(inner) => {
+            *value = inner;
+            true
+        },
+        None => false,
+    }
+}
+
+/// Reads the given [`FullValue`] as a real.
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `value`: Will be set to the real value if `fvalue` is a [`FullValue::Real`]. Left untouched otherwise.
+///
+/// # Returns
+/// Whether `fvalue` was a [`FullValue::Real`].
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_get_real(fvalue: *const FullValue, value: *mut f64) -> bool {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Read it if it's the correct type
+    match fvalue.as_real() {
+        Some(inner) => {
+            *value = inner;
+            true
+        },
+        None => false,
+    }
+}
+
+/// Reads the given [`FullValue`] as a string, without copying it.
+///
+/// Next to [`FullValue::String`]s, this also reads the identifier of [`FullValue::Data`]s and [`FullValue::IntermediateResult`]s.
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `value`: Will point to the string if `fvalue` has one. Note that it is _not_ null-terminated, and only valid for as long as `fvalue` is. Left untouched otherwise.
+/// - `len`: Will be set to the length of `value`, in bytes. Left untouched if `fvalue` has no string.
+///
+/// # Returns
+/// Whether `fvalue` was a [`FullValue::String`], [`FullValue::Data`] or [`FullValue::IntermediateResult`].
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_get_string(fvalue: *const FullValue, value: *mut *const c_char, len: *mut usize) -> bool {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Point to the string if it has one
+    match fvalue.as_str().or_else(|| fvalue.as_data()).or_else(|| fvalue.as_result()) {
+        Some(inner) => {
+            *value = inner.as_ptr() as *const c_char;
+            *len = inner.len();
+            true
+        },
+        None => false,
+    }
+}
+
+/// Reads the name of the class of the given [`FullValue`] if it is an instance, without copying it.
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `name`: Will point to the name of the class if `fvalue` is a [`FullValue::Instance`]. Note that it is _not_ null-terminated, and only valid for as long as `fvalue` is. Left untouched otherwise.
+/// - `len`: Will be set to the length of `name`, in bytes. Left untouched if `fvalue` is not an instance.
+///
+/// # Returns
+/// Whether `fvalue` was a [`FullValue::Instance`].
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_get_class(fvalue: *const FullValue, name: *mut *const c_char, len: *mut usize) -> bool {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Point to the name if it's an instance
+    match fvalue.as_instance() {
+        Some((class, _)) => {
+            *name = class.as_ptr() as *const c_char;
+            *len = class.len();
+            true
+        },
+        None => false,
+    }
+}
+
+/// Reads the number of elements in the given [`FullValue`] if it is an array.
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `len`: Will be set to the number of elements if `fvalue` is a [`FullValue::Array`]. Left untouched otherwise.
+///
+/// # Returns
+/// Whether `fvalue` was a [`FullValue::Array`].
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_array_len(fvalue: *const FullValue, len: *mut usize) -> bool {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Read the length if it's an array
+    match fvalue.as_array() {
+        Some(values) => {
+            *len = values.len();
+            true
+        },
+        None => false,
+    }
+}
+
+/// Returns a view of an element of the given [`FullValue`] if it is an array, without copying it.
+///
+/// # Safety
+/// The returned [`FullValue`] is borrowed from `fvalue`. It is only valid for as long as `fvalue` is, and must _not_ be freed using [`fvalue_free()`].
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `index`: The index of the element to return.
+///
+/// # Returns
+/// The element at `index`, or [`NULL`] if `fvalue` is not a [`FullValue::Array`] or `index` is out-of-bounds.
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer.
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_array_get(fvalue: *const FullValue, index: usize) -> *const FullValue {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+
+    // Return the element if there is any
+    match fvalue.as_array().and_then(|values| values.get(index)) {
+        Some(value) => value,
+        None => std::ptr::null(),
+    }
+}
+
+/// Returns a view of a field of the given [`FullValue`] if it is an instance, without copying it.
+///
+/// # Safety
+/// The returned [`FullValue`] is borrowed from `fvalue`. It is only valid for as long as `fvalue` is, and must _not_ be freed using [`fvalue_free()`].
+///
+/// # Arguments
+/// - `fvalue`: The [`FullValue`] to read.
+/// - `name`: The name of the field to return.
+///
+/// # Returns
+/// The value of the field called `name`, or [`NULL`] if `fvalue` is not a [`FullValue::Instance`] or has no such field.
+///
+/// # Panics
+/// This function can panic if the given `fvalue` is a NULL-pointer, or if `name` did not point to a valid UTF-8 string.
+#[no_mangle]
+pub unsafe extern "C" fn fvalue_field(fvalue: *const FullValue, name: *const c_char) -> *const FullValue {
+    // Unwrap the input
+    let fvalue: &FullValue = match fvalue.as_ref() {
+        Some(fvalue) => fvalue,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+    let name: &str = cstr_to_rust(name);
+
+    // Return the field if there is any
+    match fvalue.as_instance().and_then(|(_, fields)| fields.get(name)) {
+        Some(value) => value,
+        None => std::ptr::null(),
+    }
+}
+
+
+
+
+
+/***** PROFILE *****/
+/// Defines the profile timings of a single workflow run, as reported by the driver (see [`vm_run_profiled()`]).
+///
+/// The timings are given as a flattened tree: every entry is either a timing or a nested scope, followed by the entries in that scope (with one more depth).
+#[derive(Debug)]
+pub struct Profile {
+    /// The driver's timings. Is [`None`] if the driver did not report any.
+    scope:   Option<ProfileScope>,
+    /// The flattened entries of the `scope`.
+    entries: Vec<ProfileEntry>,
+    /// The names of the `entries`, as C-strings.
+    names:   Vec<CString>,
+    /// The time the whole run took, as seen by the client.
+    total:   Duration,
+}
+impl Profile {
+    /// Constructor for the Profile.
+    ///
+    /// # Arguments
+    /// - `scope`: The timings reported by the driver, if any.
+    /// - `total`: The time the whole run took, as seen by the client.
+    ///
+    /// # Returns
+    /// A new Profile instance.
+    fn new(scope: Option<ProfileScope>, total: Duration) -> Self {
+        let entries: Vec<ProfileEntry> = scope.as_ref().map(ProfileScope::flatten).unwrap_or_default();
+        let names: Vec<CString> = entries.iter().map(|entry| CString::new(entry.name.replace('\0', "")).unwrap()).collect();
+        Self { scope, entries, names, total }
+    }
+
+    /// Returns the entry with the given index, together with its name as a C-string.
+    ///
+    /// # Panics
+    /// This function panics if the index is out-of-bounds.
+    #[inline]
+    fn entry(&self, i: usize) -> (&ProfileEntry, &CStr) {
+        match self.entries.get(i) {
+            Some(entry) => (entry, &self.names[i]),
+            None => {
+                panic!("Index {} is out-of-bounds for Profile with {} entries", i, self.entries.len());
+            },
+        }
+    }
+}
+
+
+
+/// Destructor for the Profile.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to free.
+#[no_mangle]
+pub unsafe extern "C" fn profile_free(profile: *mut Profile) {
+    init_logger();
+    trace!("Destroying Profile...");
+
+    // Take ownership of the profile and then drop it to destroy
+    drop(Box::from_raw(profile));
+}
+
+
+
+/// Returns the number of entries in the given profile.
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to inspect.
+///
+/// # Returns
+/// The number of timings and scopes reported by the driver. Is `0` if the driver did not report any.
+///
+/// # Panics
+/// This function can panic if the given `profile` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn profile_len(profile: *const Profile) -> usize {
+    // Unwrap the pointer
+    let profile: &Profile = match profile.as_ref() {
+        Some(profile) => profile,
+        None => {
+            panic!("Given Profile is a NULL-pointer");
+        },
+    };
+
+    // Return the length
+    profile.entries.len()
+}
+
+/// Returns the name of an entry in the given profile.
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to inspect.
+/// - `i`: The index of the entry.
+///
+/// # Returns
+/// The name of the timing or scope. It is valid for as long as `profile` is; don't free it.
+///
+/// # Panics
+/// This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn profile_entry_name(profile: *const Profile, i: usize) -> *const c_char {
+    // Unwrap the pointer
+    let profile: &Profile = match profile.as_ref() {
+        Some(profile) => profile,
+        None => {
+            panic!("Given Profile is a NULL-pointer");
+        },
+    };
+
+    // Return the name
+    profile.entry(i).1.as_ptr()
+}
+
+/// Returns the depth of an entry in the given profile.
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to inspect.
+/// - `i`: The index of the entry.
+///
+/// # Returns
+/// The number of scopes that the entry is nested in. Toplevel entries have a depth of `0`.
+///
+/// # Panics
+/// This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn profile_entry_depth(profile: *const Profile, i: usize) -> usize {
+    // Unwrap the pointer
+    let profile: &Profile = match profile.as_ref() {
+        Some(profile) => profile,
+        None => {
+            panic!("Given Profile is a NULL-pointer");
+        },
+    };
+
+    // Return the depth
+    profile.entry(i).0.depth
+}
+
+/// Returns whether an entry in the given profile is a nested scope.
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to inspect.
+/// - `i`: The index of the entry.
+///
+/// # Returns
+/// True if the entry is a scope (and the next entries with a higher depth are in it), or false if it is a timing.
+///
+/// # Panics
+/// This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn profile_entry_is_scope(profile: *const Profile, i: usize) -> bool {
+    // Unwrap the pointer
+    let profile: &Profile = match profile.as_ref() {
+        Some(profile) => profile,
+        None => {
+            panic!("Given Profile is a NULL-pointer");
+        },
+    };
+
+    // Return whether it's a scope
+    profile.entry(i).0.timing.is_none()
+}
+
+/// Returns the time taken by an entry in the given profile.
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to inspect.
+/// - `i`: The index of the entry.
+///
+/// # Returns
+/// The time taken, in nanoseconds. Is `0` if the entry is a scope; its time is typically found in a nested `total`-timing instead.
+///
+/// # Panics
+/// This function can panic if the given `profile` is a NULL-pointer, or if `i` is out-of-bounds.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn profile_entry_nanos(profile: *const Profile, i: usize) -> u64 {
+    // Unwrap the pointer
+    let profile: &Profile = match profile.as_ref() {
+        Some(profile) => profile,
+        None => {
+            panic!("Given Profile is a NULL-pointer");
+        },
+    };
+
+    // Return the timing
+    profile.entry(i).0.timing.map(|timing| timing.elapsed_ns().min(u64::MAX as u128) as u64).unwrap_or(0)
+}
+
+/// Returns the total time of the run described by the given profile, as seen by the client.
+///
+/// This includes the time spent sending the workflow and receiving the result, so comparing it with the driver's own timings shows the overhead of the connection.
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to inspect.
+///
+/// # Returns
+/// The time taken, in nanoseconds.
+///
+/// # Panics
+/// This function can panic if the given `profile` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn profile_total_nanos(profile: *const Profile) -> u64 {
+    // Unwrap the pointer
+    let profile: &Profile = match profile.as_ref() {
+        Some(profile) => profile,
+        None => {
+            panic!("Given Profile is a NULL-pointer");
+        },
+    };
+
+    // Return the timing
+    profile.total.as_nanos().min(u64::MAX as u128) as u64
+}
+
+/// Serializes the given profile as a human-readable report.
+///
+/// # Arguments
+/// - `profile`: The [`Profile`] to serialize.
+/// - `buffer`: The buffer to serialize to. Will be freshly allocated using `malloc` for the correct size; can be freed using `free()`.
+///
+/// # Panics
+/// This function can panic if the given `profile` or `buffer` are NULL-pointers.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn profile_serialize(profile: *const Profile, buffer: *mut *mut c_char) {
+    // Unwrap the pointer
+    let profile: &Profile = match profile.as_ref() {
+        Some(profile) => profile,
+        None => {
+            panic!("Given Profile is a NULL-pointer");
+        },
+    };
+
+    // Write the report
+    let mut sprofile: String = format!("Workflow run took {:.3}s (client-side)\n", profile.total.as_secs_f64());
+    match &profile.scope {
+        Some(scope) => write!(&mut sprofile, "{}", scope.display_report()).unwrap(),
+        None => writeln!(&mut sprofile, "(Driver did not report any timings)").unwrap(),
+    }
+    *buffer = rust_to_cstr(sprofile);
+}
+
+
+
+
+
+/***** VIRTUAL MACHINE *****/
+/// The Docker socket that [`vm_new_offline()`] connects to by default.
+#[cfg(windows)]
+const DEFAULT_DOCKER_SOCKET: &str = "//./pipe/docker_engine";
+/// The Docker socket that [`vm_new_offline()`] connects to by default.
+#[cfg(not(windows))]
+const DEFAULT_DOCKER_SOCKET: &str = "/var/run/docker.sock";
+
+/// Defines the part of a [`VirtualMachine`] that runs workflows on a remote BRANE instance.
+struct InstanceBackend {
+    /// The endpoint to connect to for downloading registries
+    api_endpoint: String,
+    /// The endpoint to connect to when running.
+    drv_endpoint: String,
+    /// The directory of certificates to use.
+    certs_dir: String,
+    /// The state of everything we need to know about the virtual machine
+    state: InstanceVmState<BytesHandle, BytesHandle>,
+    /// Keeps the pooled driver connection used by the `state` marked as in use.
+    driver_lease: DriverLease,
+}
+
+impl InstanceBackend {
+    /// Creates a new [`InstanceVmState`] that shares the session, driver connection and indices with this VM, but writes to its own output buffer.
+    ///
+    /// This is used to run workflows without needing to borrow the VM for the duration of the run.
+    ///
+    /// # Arguments
+    /// - `handle`: The [`BytesHandle`] to which the new state will write its stdout and stderr. Should share this VM's sink if output should be streamed.
+    ///
+    /// # Returns
+    /// A new [`InstanceVmState`] that can be moved into a task on the runtime.
+    #[inline]
+    fn fork_state(&self, handle: BytesHandle) -> InstanceVmState<BytesHandle, BytesHandle> {
+        InstanceVmState {
+            stderr: handle.as_stderr(),
+            stdout: handle,
+
+            pindex: self.state.pindex.clone(),
+            dindex: self.state.dindex.clone(),
+            user:   self.state.user.clone(),
+
+            state:   CompileState::new(),
+            source:  String::new(),
+            options: self.state.options.clone(),
+
+            session: self.state.session.clone(),
+            client:  self.state.client.clone(),
+            binary:  self.state.binary,
+
+            cache_plan:  self.state.cache_plan,
+            plan_cached: false,
+        }
+    }
+}
+
+/// Defines a virtual machine that runs workflows on this machine instead of on an instance.
+#[derive(Clone)]
+enum LocalVm {
+    /// Runs tasks as containers on the local Docker daemon. Anything workflows print is collected in the buffer.
+    Offline(OfflineVm, Arc<Mutex<String>>),
+    /// Does not run tasks at all, but returns default values for them.
+    Dummy(DummyVm),
+}
+
+impl LocalVm {
+    /// Runs the given workflow on this VM.
+    ///
+    /// # Arguments
+    /// - `workflow`: The [`Workflow`] to execute.
+    ///
+    /// # Returns
+    /// The result of the workflow together with anything it printed, or an error message if it failed. It also returns `self` again for subsequent runs.
+    async fn exec(self, workflow: Workflow) -> (Self, Result<(FullValue, String), String>) {
+        match self {
+            LocalVm::Offline(vm, stdout) => {
+                let (vm, res) = vm.exec(workflow).await;
+                let prints: String = mem::take(&mut *stdout.lock());
+                (LocalVm::Offline(vm, stdout), res.map(|value| (value, prints)).map_err(|e| e.to_string()))
+            },
+            LocalVm::Dummy(vm) => {
+                let (vm, res) = vm.exec_buffered(workflow).await;
+                let prints: String = vm.take_stdout();
+                (LocalVm::Dummy(vm), res.map(|value| (value, prints)).map_err(|e| e.to_string()))
+            },
+        }
+    }
+
+    /// Throws away anything that an interrupted run printed, so it does not end up in the output of the next one.
+    fn discard_output(&self) {
+        match self {
+            LocalVm::Offline(_, stdout) => stdout.lock().clear(),
+            LocalVm::Dummy(vm) => drop(vm.take_stdout()),
+        }
+    }
+}
+
+/// Defines the part of a [`VirtualMachine`] that runs workflows locally.
+struct LocalBackend {
+    /// What kind of VM this is (used for debugging).
+    kind: &'static str,
+    /// The VM itself. Because running consumes it, it is taken out of the [`Option`] for the duration of a run; the lock thus makes runs take turns.
+    vm:   Arc<AsyncMutex<Option<LocalVm>>>,
+    /// The directory where the VM keeps intermediate results, if any. Removed when the VM is freed.
+    _results_dir: Option<TempDir>,
+}
+
+/// Defines where a [`VirtualMachine`] runs its workflows.
+enum Backend {
+    /// On a remote BRANE instance (see [`vm_new()`]).
+    Instance(Box<InstanceBackend>),
+    /// On this machine (see [`vm_new_offline()`] and [`vm_new_dummy()`]).
+    Local(LocalBackend),
+}
+
+impl Backend {
+    /// Describes where this backend runs workflows, for use in error messages.
+    fn describe(&self) -> String {
+        match self {
+            Backend::Instance(instance) => format!("'{}'", instance.drv_endpoint),
+            Backend::Local(local) => format!("the local {} VM", local.kind),
+        }
+    }
+
+    /// Prepares a [`RunTarget`] that can run a workflow on this backend from another task.
+    ///
+    /// # Arguments
+    /// - `output`: The [`BytesHandle`] that instance runs write their output to.
+    ///
+    /// # Returns
+    /// A new [`RunTarget`] that shares the session, connections and VM with this backend.
+    fn fork(&self, output: BytesHandle) -> RunTarget {
+        match self {
+            Backend::Instance(instance) => RunTarget::Instance(instance.drv_endpoint.clone(), Box::new(instance.fork_state(output))),
+            Backend::Local(local) => RunTarget::Local(self.describe(), local.vm.clone()),
+        }
+    }
+}
+
+/// Defines a [`Backend`] that has been prepared to run a workflow in the background (see [`vm_run_async()`]).
+enum RunTarget {
+    /// Runs on the instance with the given driver endpoint, using its own state.
+    Instance(String, Box<InstanceVmState<BytesHandle, BytesHandle>>),
+    /// Runs on a shared local VM, which is described by the given string.
+    Local(String, Arc<AsyncMutex<Option<LocalVm>>>),
+}
+
+impl RunTarget {
+    /// Runs the given workflow on this target.
+    ///
+    /// # Arguments
+    /// - `workflow`: The [`Workflow`] to execute.
+    /// - `output`: The [`BytesHandle`] to write prints to. For instances, this should be the same handle as given to [`Backend::fork()`].
+    /// - `stop`: A future that completes with a reason if the run has to be stopped early (see [`interrupted()`]).
+    ///
+    /// # Returns
+    /// A description of where the workflow ran (for use in error messages), together with its result or an error message.
+    async fn run(self, workflow: Workflow, output: &mut BytesHandle, stop: impl Future<Output = String>) -> (String, Result<FullValue, String>) {
+        match self {
+            RunTarget::Instance(drv_endpoint, mut state) => {
+                // Run on whichever pooled connection has room for another stream
+                let _stream: DriverLease = match acquire_stream(&drv_endpoint).await {
+                    Ok((client, lease)) => {
+                        state.client = client;
+                        lease
+                    },
+                    Err(e) => return (format!("'{drv_endpoint}'"), Err(format!("Failed to get driver connection: {e}"))),
+                };
+
+                // Dropping the run closes the stream to the driver, which then aborts the workflow
+                let res: Result<FullValue, String> = tokio::select! {
+                    res = run_instance(&drv_endpoint, &mut *state, &workflow, false) => res.map_err(|e| e.to_string()),
+                    reason = stop => Err(reason),
+                };
+                (format!("'{drv_endpoint}'"), res)
+            },
+            RunTarget::Local(what, vm) => {
+                let res: Result<FullValue, String> = run_local(&vm, workflow, output, stop).await;
+                (what, res)
+            },
+        }
+    }
+}
+
+/// Waits until a run has to be stopped before it completes.
+///
+/// # Arguments
+/// - `cancel`: A receiver for the cancellation generation of the [`VirtualMachine`] (see [`vm_cancel()`]), subscribed when the run started.
+/// - `timeout`: If given, the time after which the run is stopped.
+///
+/// # Returns
+/// A message that describes why the run was stopped. Never returns if the run is neither cancelled nor has a timeout.
+async fn interrupted(mut cancel: watch::Receiver<u64>, timeout: Option<Duration>) -> String {
+    let cancelled = async move {
+        // The VM being freed does not cancel background runs
+        if cancel.changed().await.is_err() {
+            std::future::pending::<()>().await;
+        }
+    };
+    let expired = async move {
+        match timeout {
+            Some(timeout) => tokio::time::sleep(timeout).await,
+            None => std::future::pending::<()>().await,
+        }
+    };
+    tokio::select! {
+        _ = cancelled => "Run was cancelled".into(),
+        _ = expired => format!("Run did not complete within {:.2}s", timeout.unwrap_or_default().as_secs_f32()),
+    }
+}
+
+/// Runs the given workflow on a local VM.
+///
+/// # Arguments
+/// - `vm`: The (shared) [`LocalVm`] to run on. Waits until it is not running anything else.
+/// - `workflow`: The [`Workflow`] to execute.
+/// - `output`: The [`BytesHandle`] to write anything to that the workflow printed.
+/// - `stop`: A future that completes with a reason if the run has to be stopped early (see [`interrupted()`]). The VM then gets back the variables it had before the run (but not its global state, which it shares with the backup).
+///
+/// # Returns
+/// The value returned by the workflow.
+///
+/// # Errors
+/// This function errors if the workflow failed or was stopped, or if an earlier run on the same VM panicked.
+async fn run_local(
+    vm: &AsyncMutex<Option<LocalVm>>,
+    workflow: Workflow,
+    output: &mut BytesHandle,
+    stop: impl Future<Output = String>,
+) -> Result<FullValue, String> {
+    let mut lock = vm.lock().await;
+    let local: LocalVm = match lock.take() {
+        Some(local) => local,
+        None => return Err("Virtual machine was lost during an earlier run".into()),
+    };
+    let backup: LocalVm = local.clone();
+    let res: Result<(FullValue, String), String> = tokio::select! {
+        (local, res) = local.exec(workflow) => {
+            *lock = Some(local);
+            res
+        },
+        reason = stop => {
+            backup.discard_output();
+            *lock = Some(backup);
+            return Err(reason);
+        },
+    };
+    drop(lock);
+
+    // Write the prints to the output like the instance would have
+    let (value, prints): (FullValue, String) = res?;
+    if let Err(e) = output.write_all(prints.as_bytes()) {
+        return Err(format!("Failed to write workflow output: {e}"));
+    }
+    Ok(value)
+}
+
+/// Defines a BRANE virtual machine.
+///
+/// This can run a compiled workflow on a running instance (see [`vm_new()`]), or on this machine (see [`vm_new_offline()`] and [`vm_new_dummy()`]).
+///
+/// A VirtualMachine may only be used by one thread at a time. To run workflows from many threads, use a [`VmPool`] instead.
+///
+/// The only exception is [`vm_cancel()`], which reads `cancel` while another thread may be running a workflow. Because of that, functions that run workflows borrow the fields they need separately instead of taking a `&mut` to the whole VM, and `cancel` itself is only ever borrowed immutably.
+pub struct VirtualMachine {
+    /// The tokio runtime handle to use for this VM
+    runtime: Arc<Runtime>,
+    /// Where this VM runs its workflows.
+    backend: Backend,
+    /// Buffers anything that workflows print, or forwards it to the host's callback. Shared with the instance state, if any.
+    output:  BytesHandle,
+    /// Counts how often [`vm_cancel()`] has been called. Runs subscribe to it when they start and are stopped when it changes. May be accessed concurrently, so never borrow it mutably.
+    cancel:  watch::Sender<u64>,
+
+    /// How long the data index may be re-used by [`vm_process()`] before it is downloaded again. A zero duration means always.
+    dindex_ttl: Duration,
+    /// When [`vm_process()`] last downloaded the data index, if ever.
+    dindex_refreshed: Option<Instant>,
+}
+
+impl VirtualMachine {
+
+    /// Returns a snapshot of the data index that knows about all of the given datasets, downloading it again if necessary.
+    ///
+    /// The index is only downloaded if the current one is older than the VM's TTL, or if it does not know about one of the given datasets.
+    ///
+    /// # Arguments
+    /// - `names`: The datasets that should be in the index.
+    ///
+    /// # Returns
+    /// The (possibly refreshed) [`DataIndex`].
+    ///
+    /// # Errors
+    /// This function errors if we failed to download the data index.
+    fn refresh_dindex(&mut self, names: &[&str]) -> Result<Arc<DataIndex>, Error> {
+        let instance: &InstanceBackend = match &self.backend {
+            Backend::Instance(instance) => instance,
+            Backend::Local(local) => return Err(Error { msg: format!("The local {} VM has no remote data index", local.kind) }),
+        };
+
+        // Take a snapshot of the current index
+        let mut dindex: Arc<DataIndex> = instance.state.dindex.load_full();
+
+        // Load it again, unless we did so recently and it already knows the datasets
+        let fresh: bool = self.dindex_refreshed.map(|at| at.elapsed() < self.dindex_ttl).unwrap_or(false);
+        if !fresh || names.iter().any(|name| dindex.get(name).is_none()) {
+            let data_endpoint: String = format!("{}/data/info", instance.api_endpoint);
+            dindex = match METRICS_DINDEX.measure(|| self.runtime.block_on(get_data_index(data_endpoint))) {
+                Ok(index) => Arc::new(index),
+                Err(e) => {
+                    return Err(Error { msg: format!("Failed to refresh data index: {e}") });
+                },
+            };
+
+            // Swap it in for everyone sharing this index; readers holding the old snapshot are unaffected
+            instance.state.dindex.store(dindex.clone());
+            self.dindex_refreshed = Some(Instant::now());
+        } else {
+            debug!("Re-using data index from {:.2}s ago", self.dindex_refreshed.map(|at| at.elapsed().as_secs_f32()).unwrap_or(0.0));
+        }
+        Ok(dindex)
+    }
+}
+
+
+
+/// Constructor for the VirtualMachine.
+///
+/// # Arguments
+/// - `api_endpoint`: The Brane API endpoint to connect to to download available registries and all that.
+/// - `drv_endpoint`: The BRANE driver endpoint to connect to to execute stuff.
+/// - `certs_dir`: The directory where certificates for downloading datasets are stored.
+/// - `pindex`: The [`PackageIndex`] to resolve package references in the snippets with.
+/// - `dindex`: The [`DataIndex`] to resolve dataset references in the snippets with.
+/// - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function can panic if the given `pindex` or `dindex` are NULL, or if the given `api_endpoint`, `drv_endpoint` or `certs_dir` do not point to a valid UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_new(
+    api_endpoint: *const c_char,
+    drv_endpoint: *const c_char,
+    certs_dir: *const c_char,
+    pindex: *const Arc<ArcSwap<PackageIndex>>,
+    dindex: *const Arc<ArcSwap<DataIndex>>,
+    vm: *mut *mut VirtualMachine,
+) -> *const Error {
+    init_logger();
+    *vm = std::ptr::null_mut();
+    info!("Constructing BraneScript virtual machine v{}...", env!("CARGO_PKG_VERSION"));
+
+    // Read the endpoints & directories
+    let api_endpoint: &str = cstr_to_rust(api_endpoint);
+    let drv_endpoint: &str = cstr_to_rust(drv_endpoint);
+    let certs_dir: &str = cstr_to_rust(certs_dir);
+
+    // Read the indices
+    let pindex: &Arc<ArcSwap<PackageIndex>> = match pindex.as_ref() {
+        Some(index) => index,
+        None => {
+            panic!("Given PackageIndex is a NULL-pointer");
+        },
+    };
+    let dindex: &Arc<ArcSwap<DataIndex>> = match dindex.as_ref() {
+        Some(index) => index,
+        None => {
+            panic!("Given DataIndex is a NULL-pointer");
+        },
+    };
+
+    // Prepare a tokio environment
+    let runtime: Arc<Runtime> = match init_runtime() {
+        Ok(runtime) => runtime,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to create local Tokio context: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Get a (possibly shared) connection to the driver
+    let (client, driver_lease): (DriverServiceClient, DriverLease) = match acquire_driver(&runtime, drv_endpoint) {
+        Ok(res) => res,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to get driver connection: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Prepare the state
+    let handle: BytesHandle = BytesHandle::new();
+    let state: InstanceVmState<BytesHandle, BytesHandle> = match runtime.block_on(initialize_instance_with_client(
+        handle.clone(),
+        handle.as_stderr(),
+        drv_endpoint,
+        client,
+        pindex.clone(),
+        dindex.clone(),
+        /* TODO: Add user here as well */
+        None,
+        None,
+        ParserOptions::bscript(),
+    )) {
+        Ok(state) => state,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to create new InstanceVmState: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // OK, return the new thing
+    *vm = Box::into_raw(Box::new(VirtualMachine {
+        runtime,
+        backend: Backend::Instance(Box::new(InstanceBackend {
+            api_endpoint: api_endpoint.into(),
+            drv_endpoint: drv_endpoint.into(),
+            certs_dir: certs_dir.into(),
+            state,
+            driver_lease,
+        })),
+        output: handle,
+        cancel: watch::channel(0).0,
+
+        dindex_ttl: Duration::ZERO,
+        dindex_refreshed: None,
+    }));
+    debug!("Virtual machine created");
+    std::ptr::null()
+}
+
+/// Constructor for a VirtualMachine that runs workflows on this machine, using the local Docker daemon.
+///
+/// This executes workflows in the same way as `brane run` without `--remote`: packages are taken from the local package directory, and datasets from (and committed results to) the local data directory. No instance is contacted.
+///
+/// Note that the workflows run on it should be compiled against indices of the local packages and datasets.
+///
+/// # Arguments
+/// - `docker_socket`: The path of the socket with which to connect to the Docker daemon. If [`NULL`], uses the platform's default socket.
+/// - `keep_containers`: Whether to keep the containers of tasks after they completed (useful for debugging).
+/// - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function can panic if the given `docker_socket` does not point to a valid UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_new_offline(docker_socket: *const c_char, keep_containers: bool, vm: *mut *mut VirtualMachine) -> *const Error {
+    init_logger();
+    *vm = std::ptr::null_mut();
+    info!("Constructing offline BraneScript virtual machine v{}...", env!("CARGO_PKG_VERSION"));
+
+    // Read the socket
+    let docker_socket: &str = if docker_socket.is_null() { DEFAULT_DOCKER_SOCKET } else { cstr_to_rust(docker_socket) };
+    let docker_opts: DockerOptions = DockerOptions { socket: docker_socket.into(), version: ClientVersion(*API_DEFAULT_VERSION) };
+
+    // Prepare a tokio environment
+    let runtime: Arc<Runtime> = match init_runtime() {
+        Ok(runtime) => runtime,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to create local Tokio context: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // Prepare the VM with the local indices
+    let OfflineVmState { results_dir, vm: offline, .. } = match initialize_offline_vm(ParserOptions::bscript(), docker_opts, keep_containers) {
+        Ok(state) => state,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to create new OfflineVmState: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+    let offline: OfflineVm = offline.unwrap();
+    let stdout: Arc<Mutex<String>> = Arc::new(Mutex::new(String::new()));
+    offline.capture_stdout(Some(stdout.clone()));
+
+    // OK, return the new thing
+    *vm = Box::into_raw(Box::new(VirtualMachine {
+        runtime,
+        backend: Backend::Local(LocalBackend {
+            kind: "offline",
+            vm:   Arc::new(AsyncMutex::new(Some(LocalVm::Offline(offline, stdout)))),
+            _results_dir: Some(results_dir),
+        }),
+        output: BytesHandle::new(),
+        cancel: watch::channel(0).0,
+
+        dindex_ttl: Duration::ZERO,
+        dindex_refreshed: None,
+    }));
+    debug!("Virtual machine created");
+    std::ptr::null()
+}
+
+/// Constructor for a VirtualMachine that does not run any tasks, but returns default values for them instead.
+///
+/// This is useful for testing whether workflows run as expected without needing an instance or Docker. Any prints done by the workflow itself are still collected.
+///
+/// # Arguments
+/// - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_new_dummy(vm: *mut *mut VirtualMachine) -> *const Error {
+    init_logger();
+    *vm = std::ptr::null_mut();
+    info!("Constructing dummy BraneScript virtual machine v{}...", env!("CARGO_PKG_VERSION"));
+
+    // Prepare a tokio environment
+    let runtime: Arc<Runtime> = match init_runtime() {
+        Ok(runtime) => runtime,
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to create local Tokio context: {e}") };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+
+    // OK, return the new thing
+    *vm = Box::into_raw(Box::new(VirtualMachine {
+        runtime,
+        backend: Backend::Local(LocalBackend {
+            kind: "dummy",
+            vm:   Arc::new(AsyncMutex::new(Some(LocalVm::Dummy(DummyVm::new())))),
+            _results_dir: None,
+        }),
+        output: BytesHandle::new(),
+        cancel: watch::channel(0).0,
+
+        dindex_ttl: Duration::ZERO,
+        dindex_refreshed: None,
+    }));
+    debug!("Virtual machine created");
+    std::ptr::null()
+}
+
+/// Destructor for the VirtualMachine.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] to free.
+#[no_mangle]
+pub unsafe extern "C" fn vm_free(vm: *mut VirtualMachine) {
+    init_logger();
+    trace!("Destroying VirtualMachine...");
+
+    // See if the global context needs to be destroyed
+    cleanup_runtime();
+
+    // Take ownership of the VM and then drop it to destroy
+    drop(Box::from_raw(vm));
+    cleanup_runtime();
+}
+
+
+
+/// Defines the callback to which a [`VirtualMachine`] forwards workflow output as it arrives (see [`vm_set_output_callback()`]).
+///
+/// # Arguments
+/// - `user_data`: The opaque pointer given to [`vm_set_output_callback()`].
+/// - `is_stderr`: Whether this chunk was written to stderr (true) or stdout (false).
+/// - `chunk`: The chunk of output. Note that it is _not_ null-terminated, and only valid for the duration of the call.
+/// - `len`: The length of `chunk`, in bytes.
+pub type OutputCallback = unsafe extern "C" fn(user_data: *mut c_void, is_stderr: bool, chunk: *const c_char, len: usize);
+
+/// Installs a callback that receives any stdout- or stderr output of workflows run on this VM as soon as the remote sends it.
+///
+/// While a callback is installed, output is no longer buffered; the `prints` returned by [`vm_run()`] (and friends) will be empty.
+///
+/// # Safety
+/// The `callback` may be called from any thread that is running a workflow for this VM, including the runtime's own threads for [`vm_run_async()`]. It must not call this function itself.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] to install the callback on.
+/// - `callback`: The [`OutputCallback`] to call for every chunk. If [`NULL`], any installed callback is removed and output is buffered again.
+/// - `user_data`: Some opaque pointer that is given back to the `callback`.
+///
+/// # Panics
+/// This function may panic if the input `vm` pointed to a NULL-pointer.
+#[no_mangle]
+pub unsafe extern "C" fn vm_set_output_callback(vm: *mut VirtualMachine, callback: Option<OutputCallback>, user_data: *mut c_void) {
+    init_logger();
+
+    // Unwrap the VM
+    let vm: &mut VirtualMachine = match vm.as_mut() {
+        Some(vm) => vm,
+        None => {
+            panic!("Given VirtualMachine is a NULL-pointer");
+        },
+    };
+
+    // Install the sink, which is shared between the VM's stdout and stderr
+    *vm.output.sink.lock() = callback.map(|callback| OutputSink { callback, user_data: UserData(user_data) });
+    debug!("Output callback {}", if callback.is_some() { "installed" } else { "removed" });
+}
+
+
+/// Sets how long [`vm_process()`] may re-use the data index it downloaded before downloading it again.
+///
+/// By default, the index is downloaded for every dataset that is processed. If a TTL is set, then the index is only downloaded again if it is older than the TTL _or_ if it does not know the dataset to process.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] to set the TTL of.
+/// - `ttl`: The time (in seconds) that a downloaded data index stays valid. `0` means that it is downloaded every time.
+///
+/// # Panics
+/// This function may panic if the input `vm` pointed to a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_set_index_ttl(vm: *mut VirtualMachine, ttl: u64) {
+    init_logger();
+
+    // Unwrap the VM
+    let vm: &mut VirtualMachine = match vm.as_mut() {
+        Some(vm) => vm,
+        None => {
+            panic!("Given VirtualMachine is a NULL-pointer");
+        },
+    };
+
+    // Set it
+    vm.dindex_ttl = Duration::from_secs(ttl);
+    debug!("Data index TTL is now {ttl}s");
+}
+
+/// Sets whether the driver may re-use an earlier plan of the same workflow instead of planning it again.
+///
+/// Plans are only re-used within this VM's session, and only while the instance's infrastructure does not change and the plan is not too old. The checkers are still asked about every run, since planning is where they normally see a workflow. Use [`vm_plan_cached()`] to find out if the last run used a cached plan.
+///
+/// Has no effect for VMs that run locally, since these do not plan.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] to configure.
+/// - `enabled`: Whether to ask for cached plans. Disabled by default.
+///
+/// # Panics
+/// This function may panic if the input `vm` pointed to a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_set_plan_cache(vm: *mut VirtualMachine, enabled: bool) {
+    init_logger();
+
+    // Unwrap the VM
+    let vm: &mut VirtualMachine = match vm.as_mut() {
+        Some(vm) => vm,
+        None => {
+            panic!("Given VirtualMachine is a NULL-pointer");
+        },
+    };
+
+    // Set it
+    match &mut vm.backend {
+        Backend::Instance(instance) => {
+            instance.state.cache_plan = enabled;
+            debug!("Plan cache is now {}", if enabled { "enabled" } else { "disabled" });
+        },
+        Backend::Local(_) => debug!("Ignoring plan cache setting for local virtual machine"),
+    }
+}
+
+/// Returns whether the last workflow run with [`vm_run()`] (or [`vm_run_profiled()`] and [`vm_run_with_deadline()`]) re-used a cached plan.
+///
+/// Runs in the background (e.g., [`vm_run_async()`]) do not update this.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] to query.
+///
+/// # Returns
+/// True if the driver re-used an earlier plan (see [`vm_set_plan_cache()`]), or false if the workflow was planned again, has not run yet or ran locally.
+///
+/// # Panics
+/// This function may panic if the input `vm` pointed to a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_plan_cached(vm: *const VirtualMachine) -> bool {
+    // Unwrap the VM
+    let vm: &VirtualMachine = match vm.as_ref() {
+        Some(vm) => vm,
+        None => {
+            panic!("Given VirtualMachine is a NULL-pointer");
+        },
+    };
+
+    match &vm.backend {
+        Backend::Instance(instance) => instance.state.plan_cached,
+        Backend::Local(_) => false,
+    }
+}
+
+
+
+/// Runs the given code snippet on the backend instance.
+///
+/// The workflow is submitted in a compact binary encoding (MessagePack) if the driver advertised support for it when the session was created, and as JSON otherwise.
+///
+/// This is equivalent to calling [`vm_run_profiled()`] without asking for a profile.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+/// - `workflow`: The compiled workflow to execute.
+/// - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below). Is empty if an output callback is installed (see [`vm_set_output_callback()`]).
+/// - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_run(
+    vm: *mut VirtualMachine,
+    workflow: *const Workflow,
+    prints: *mut *mut c_char,
+    result: *mut *mut FullValue,
+) -> *const Error {
+    vm_run_profiled(vm, workflow, prints, result, std::ptr::null_mut())
+}
+
+/// Runs the given code snippet on the backend instance, and optionally collects where it spent its time.
+///
+/// If a `profile` is asked for, the driver reports its timings along with the result. These include planning, and every task's preprocessing, execution and committing on the worker it was scheduled on.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+/// - `workflow`: The compiled workflow to execute.
+/// - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below). Is empty if an output callback is installed (see [`vm_set_output_callback()`]).
+/// - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+/// - `profile`: If not [`NULL`], will point to a new [`Profile`] with the timings of this run. Will be [`NULL`] if there is an error (see below). Has to be freed using [`profile_free()`].
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_run_profiled(
+    vm: *mut VirtualMachine,
+    workflow: *const Workflow,
+    prints: *mut *mut c_char,
+    result: *mut *mut FullValue,
+    profile: *mut *mut Profile,
+) -> *const Error {
+    run_workflow(vm, workflow, None, prints, result, profile)
+}
+
+/// Runs the given code snippet on the backend instance, but stops it if it does not complete in time.
+///
+/// Stopping a run on an instance closes the stream to its driver, which then aborts the workflow and closes its streams to the workers; they stop the containers of tasks that are still running. A local VM stops the container of a task that is still running, and gets back the variables it had before the run. Anything the run already did outside of the VM is not undone, though, e.g., the results and datasets it already produced are kept.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+/// - `workflow`: The compiled workflow to execute.
+/// - `timeout_ms`: The number of milliseconds after which the run is stopped. Zero means no deadline, although the run can still be cancelled with [`vm_cancel()`].
+/// - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below). Is empty if an output callback is installed (see [`vm_set_output_callback()`]).
+/// - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise. This includes the run being stopped because of the deadline or because it was cancelled.
+///
+/// # Panics
+/// This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_run_with_deadline(
+    vm: *mut VirtualMachine,
+    workflow: *const Workflow,
+    timeout_ms: u64,
+    prints: *mut *mut c_char,
+    result: *mut *mut FullValue,
+) -> *const Error {
+    let timeout: Option<Duration> = if timeout_ms > 0 { Some(Duration::from_millis(timeout_ms)) } else { None };
+    run_workflow(vm, workflow, timeout, prints, result, std::ptr::null_mut())
+}
+
+/// Cancels all workflows that are running on the given [`VirtualMachine`].
+///
+/// This affects runs started with [`vm_run()`], [`vm_run_profiled()`], [`vm_run_with_deadline()`] and [`vm_run_async()`] that are in progress; they return (or report) an error saying they were cancelled. Runs started after this call are not affected.
+///
+/// This function may be called from another thread than the one running the workflow. It only touches the cancellation state of the VM, so it is safe to call while [`vm_run()`] (or one of its variants) runs, but not concurrently with [`vm_free()`] or with functions that configure the VM (e.g., [`vm_set_output_callback()`]).
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] to cancel the runs of.
+///
+/// # Panics
+/// This function can panic if the given `vm` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_cancel(vm: *const VirtualMachine) {
+    init_logger();
+
+    // Unwrap the VM, but only its `cancel` field, since another thread may be running a workflow on (and thus borrowing) the rest of it
+    if vm.is_null() {
+        panic!("Given VirtualMachine is a NULL-pointer");
+    }
+    let cancel: &watch::Sender<u64> = &*addr_of!((*vm).cancel);
+
+    // Notify all runs subscribed so far
+    cancel.send_modify(|generation| *generation += 1);
+    info!("Cancelled workflows running on virtual machine");
+}
+
+/// Implements [`vm_run_profiled()`] and [`vm_run_with_deadline()`].
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we execute with.
+/// - `workflow`: The compiled workflow to execute.
+/// - `timeout`: If given, the time after which the run is stopped.
+/// - `prints`: Will point to a newly allocated string with the prints done during workflow execution, or [`NULL`] on error.
+/// - `result`: Will point to a [`FullValue`] with the return value of the workflow, or [`NULL`] on error.
+/// - `profile`: If not [`NULL`], will point to a new [`Profile`] with the timings of this run, or [`NULL`] on error.
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+unsafe fn run_workflow(
+    vm: *mut VirtualMachine,
+    workflow: *const Workflow,
+    timeout: Option<Duration>,
+    prints: *mut *mut c_char,
+    result: *mut *mut FullValue,
+    profile: *mut *mut Profile,
+) -> *const Error {
+    init_logger();
+    *prints = std::ptr::null_mut();
+    *result = std::ptr::null_mut();
+    if !profile.is_null() {
+        *profile = std::ptr::null_mut();
+    }
+    info!("Executing workflow on virtual machine...");
+    let start: Instant = Instant::now();
+
+    // Unwrap the VM field-by-field, since [`vm_cancel()`] may read its `cancel` from another thread while we run (see [`VirtualMachine`])
+    if vm.is_null() {
+        panic!("Given VirtualMachine is a NULL-pointer");
+    }
+    let runtime: &Arc<Runtime> = &*addr_of!((*vm).runtime);
+    let backend: &mut Backend = &mut *addr_of_mut!((*vm).backend);
+    let output: &mut BytesHandle = &mut *addr_of_mut!((*vm).output);
+    let cancel: &watch::Sender<u64> = &*addr_of!((*vm).cancel);
+    // Unwrap the workflow
+    let workflow: &Workflow = match workflow.as_ref() {
+        Some(workflow) => workflow,
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+
+    // Run the state
+    debug!("Executing snippet...");
+    let stop = interrupted(cancel.subscribe(), timeout);
+    let res: Result<(FullValue, Option<ProfileScope>), String> = match &mut *backend {
+        Backend::Instance(instance) => METRICS_RUN.measure(|| {
+            runtime.block_on(async move {
+                // Run on whichever pooled connection has room for another stream, and then go back to the VM's own
+                let (client, _stream): (DriverServiceClient, DriverLease) =
+                    acquire_stream(&instance.drv_endpoint).await.map_err(|e| format!("Failed to get driver connection: {e}"))?;
+                let own: DriverServiceClient = mem::replace(&mut instance.state.client, client);
+
+                // Dropping the run closes the stream to the driver, which then aborts the workflow
+                let res: Result<(FullValue, Option<ProfileScope>), String> = tokio::select! {
+                    res = run_instance_profiled(&instance.drv_endpoint, &mut instance.state, workflow, !profile.is_null()) => {
+                        res.map_err(|e| e.to_string())
+                    },
+                    reason = stop => Err(reason),
+                };
+                instance.state.client = own;
+                res
+            })
+        }),
+        Backend::Local(local) => {
+            METRICS_RUN.measure(|| runtime.block_on(run_local(&local.vm, workflow.clone(), &mut *output, stop))).map(|value| (value, None))
+        },
+    };
+    let (value, report): (FullValue, Option<ProfileScope>) = match res {
+        Ok(res) => res,
+        Err(e) => {
+            let err: Box<Error> = Box::new(Error { msg: format!("Failed to run workflow on {}: {}", backend.describe(), e) });
+            return Box::into_raw(err);
+        },
+    };
+
+    // Store it and we're done!
+    *prints = rust_to_cstr(output.flush_as_string().unwrap());
+    *result = Box::into_raw(Box::new(value));
+    if !profile.is_null() {
+        if report.is_none() {
+            warn!("Virtual machine running on {} did not report any profile timings", backend.describe());
+        }
+        *profile = Box::into_raw(Box::new(Profile::new(report, start.elapsed())));
+    }
+    debug!("Done (execution took {:.2}s)", start.elapsed().as_secs_f32());
+    std::ptr::null()
+}
+
+/// Defines options that tune how [`vm_process_ex()`] downloads a dataset.
+#[derive(Clone, Copy, Debug)]
+#[repr(C)]
+pub struct ProcessOptions {
+    /// The maximum number of byte ranges to download concurrently. `0` or `1` download the dataset as a single stream.
+    pub concurrency: usize,
+    /// The size (in bytes) of every byte range. `0` uses the default (8 MiB).
+    pub chunk_size:  u64,
+}
+
+/// Processes the result referred to by the [`FullValue`].
+///
+/// This is equivalent to calling [`vm_process_ex()`] without any options.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
+/// - `result`: The [`FullValue`] which we will attempt to download if needed.
+/// - `data_dir`: The directory to download the result to. This should be the generic data directory: the dataset is extracted to `<data_dir>/<name>/data` (next to a `data.yml` describing it), which is also where [`fvalue_serialize()`] says it is.
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function may panic if the input `vm` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_process(vm: *mut VirtualMachine, result: *const FullValue, data_dir: *const c_char) -> *const Error {
+    vm_process_ex(vm, result, data_dir, std::ptr::null())
+}
+
+/// Processes the result referred to by the [`FullValue`], using the given options.
+///
+/// Processing currently consists of:
+/// - Downloading the dataset if it's a [`FullValue::Data`]
+/// - Throwing a warning if it's a [`FullValue::IntermediateResult`]
+/// - Doing nothing otherwise
+///
+/// Datasets are downloaded from one of the locations advertising it, trying the others if that fails. If the registry supports it and `opts` allows it, the dataset is downloaded as multiple byte ranges in parallel; every range is checked to be cut from the same archive (by its strong `ETag`), and the download starts over as a single stream if the archive changes halfway.
+///
+/// If the same version of the dataset was already downloaded to `data_dir`, nothing is transferred. Otherwise, the archive is extracted while it is being downloaded, so it is never stored on disk as a whole; an interrupted transfer is resumed where it left off if the remote supports it.
+///
+/// Virtual machines created with [`vm_new_offline()`] or [`vm_new_dummy()`] do not download anything, since any datasets they produce already live in the local data directory.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
+/// - `result`: The [`FullValue`] which we will attempt to download if needed.
+/// - `data_dir`: The directory to download the result to. This should be the generic data directory: the dataset is extracted to `<data_dir>/<name>/data` (next to a `data.yml` describing it), which is also where [`fvalue_serialize()`] says it is.
+/// - `opts`: The [`ProcessOptions`] that determine how to download. May be [`NULL`] to use the defaults, which download as a single stream.
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function may panic if the input `vm` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_process_ex(
+    vm: *mut VirtualMachine,
+    result: *const FullValue,
+    data_dir: *const c_char,
+    opts: *const ProcessOptions,
+) -> *const Error {
+    init_logger();
+    info!("Processing result on virtual machine...");
+    let start: Instant = Instant::now();
 
-    // Take ownership of the value and then drop it to destroy
-    drop(Box::from_raw(fvalue));
-    cleanup_runtime();
-}
+    // Unwrap the VM
+    let vm: &mut VirtualMachine = match vm.as_mut() {
+        Some(vm) => vm,
+        None => {
+            panic!("Given VirtualMachine is a NULL-pointer");
+        },
+    };
+    // Unwrap the result
+    let result: &FullValue = match result.as_ref() {
+        Some(result) => result,
+        None => {
+            panic!("Given FullValue is a NULL-pointer");
+        },
+    };
+    // Read the string
+    let data_dir: &str = cstr_to_rust(data_dir);
+    // Local VMs already put their datasets in the local data directory
+    let (api_endpoint, certs_dir): (String, String) = match &vm.backend {
+        Backend::Instance(instance) => (instance.api_endpoint.clone(), instance.certs_dir.clone()),
+        Backend::Local(local) => {
+            info!("Results of the local {} VM are not downloaded; datasets are already in the local data directory", local.kind);
+            return std::ptr::null();
+        },
+    };
 
+    // Resolve the options
+    let mut dopts: DownloadOptions = DownloadOptions { stream_extract: true, ..Default::default() };
+    if let Some(opts) = opts.as_ref() {
+        dopts.concurrency = opts.concurrency.max(1);
+        if opts.chunk_size > 0 {
+            dopts.chunk_size = opts.chunk_size;
+        }
+    }
 
+    // If the value is a dataset, then download the data on top of it
+    if let FullValue::Data(d) = &result {
+        debug!("FullValue is a FullValue::Data, downloading...");
 
-/// Checks if this [`FullValue`] needs processing.
+        // Refresh the data index and get the info for this dataset
+        let info: DataInfo = {
+            let dindex: Arc<DataIndex> = match vm.refresh_dindex(&[d.as_ref()]) {
+                Ok(dindex) => dindex,
+                Err(err) => return Box::into_raw(Box::new(err)),
+            };
+
+            // Fetch the correct info
+            match dindex.get(d) {
+                Some(info) => info.clone(),
+                None => {
+                    let err: Box<Error> = Box::new(Error { msg: format!("Resulting dataset '{d}' is not at any location") });
+                    return Box::into_raw(err);
+                },
+            }
+        };
+
+        // Run the process funtion (in a directory of the dataset's own)
+        let data_dir: PathBuf = Path::new(data_dir).join(d.as_ref());
+        let res: Option<AccessKind> = match METRICS_DOWNLOAD
+            .measure(|| vm.runtime.block_on(download_data_cached(&api_endpoint, &None, &certs_dir, &data_dir, &info, &dopts)))
+        {
+            Ok(res) => res,
+            Err(e) => {
+                let err: Box<Error> = Box::new(Error { msg: format!("Failed to download resulting data from '{}': {}", api_endpoint, e) });
+                return Box::into_raw(err);
+            },
+        };
+        if let Some(AccessKind::File { path }) = res {
+            info!("Downloaded dataset to '{}'", path.display());
+        }
+    } else if matches!(result, FullValue::IntermediateResult(_)) {
+        debug!("FullValue is a FullValue::IntermediateResult, downloading...");
+
+        // Emit a warning
+        warn!("Cannot download intermediate result");
+    }
+
+    // OK, nothing to return
+    debug!("Done (processing took {:.2}s)", start.elapsed().as_secs_f32());
+    std::ptr::null()
+}
+
+/// Collects the datasets referred to by the given [`FullValue`], including any nested in arrays or instances.
 ///
-/// For now, this only occurs when it is a [`FullValue::Data`] (download it) or [`FullValue::IntermediateResult`] (throw a warning).
+/// # Arguments
+/// - `value`: The [`FullValue`] to search.
+/// - `seen`: The set of datasets encountered so far, used to deduplicate them.
+/// - `datasets`: The list to which new datasets are appended (in the order in which they're found).
+/// - `intermediate`: Set to true if we encountered any intermediate results.
+fn collect_datasets<'v>(value: &'v FullValue, seen: &mut HashSet<&'v str>, datasets: &mut Vec<&'v str>, intermediate: &mut bool) {
+    match value {
+        FullValue::Array(values) => {
+            for value in values {
+                collect_datasets(value, seen, datasets, intermediate);
+            }
+        },
+        FullValue::Instance(_, fields) => {
+            for value in fields.values() {
+                collect_datasets(value, seen, datasets, intermediate);
+            }
+        },
+        FullValue::Data(d) => {
+            if seen.insert(d.as_ref()) {
+                datasets.push(d.as_ref());
+            }
+        },
+        FullValue::IntermediateResult(_) => *intermediate = true,
+        _ => {},
+    }
+}
+
+/// Processes multiple results at once, downloading all datasets referred to by them concurrently.
+///
+/// This is equivalent to calling [`vm_process()`] on every result, except that the data index is downloaded at most once, that every dataset is downloaded only once (even if referred to by multiple results), and that datasets nested in arrays or instances are downloaded too.
 ///
 /// # Arguments
-/// - `fvalue`: The [`FullValue`] to analyse.
+/// - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
+/// - `results`: An array of `n` [`FullValue`]s which we will attempt to download if needed.
+/// - `n`: The number of results in `results`.
+/// - `data_dir`: The directory to download the results to. This should be the generic data directory: like with [`vm_process()`], every dataset is extracted to `<data_dir>/<name>/data`.
 ///
 /// # Returns
-/// True if `vm_process()` should be called on this value or false otherwise.
+/// An [`Error`]-struct that contains the error(s) occurred, or [`NULL`] otherwise. If some datasets failed to download, the others are still downloaded.
 ///
 /// # Panics
-/// This function can panic if `fvalue` pointed to [`NULL`].
+/// This function may panic if the input `vm`, `results` or any of its elements pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn fvalue_needs_processing(fvalue: *const FullValue) -> bool {
-    // Unwrap the input
-    let fvalue: &FullValue = match fvalue.as_ref() {
+pub unsafe extern "C" fn vm_process_many(
+    vm: *mut VirtualMachine,
+    results: *const *const FullValue,
+    n: usize,
+    data_dir: *const c_char,
+) -> *const Error {
+    init_logger();
+    info!("Processing {n} result(s) on virtual machine...");
+    let start: Instant = Instant::now();
+
+    // Unwrap the VM
+    let vm: &mut VirtualMachine = match vm.as_mut() {
         Some(vm) => vm,
         None => {
-            panic!("Given FullValue is a NULL-pointer");
+            panic!("Given VirtualMachine is a NULL-pointer");
         },
     };
+    // Unwrap the results
+    if results.is_null() && n > 0 {
+        panic!("Given FullValue array is a NULL-pointer");
+    }
+    let results: &[*const FullValue] = if n > 0 { std::slice::from_raw_parts(results, n) } else { &[] };
+    let results: Vec<&FullValue> = results
+        .iter()
+        .enumerate()
+        .map(|(i, result)| match result.as_ref() {
+            Some(result) => result,
+            None => {
+                panic!("Given FullValue {i} is a NULL-pointer");
+            },
+        })
+        .collect();
+    // Read the string
+    let data_dir: &str = cstr_to_rust(data_dir);
 
-    // Match it
-    matches!(fvalue, FullValue::Data(_) | FullValue::IntermediateResult(_))
+
+    // Local VMs already put their datasets in the local data directory
+    let (api_endpoint, certs_dir): (String, String) = match &vm.backend {
+        Backend::Instance(instance) => (instance.api_endpoint.clone(), instance.certs_dir.clone()),
+        Backend::Local(local) => {
+            info!("Results of the local {} VM are not downloaded; datasets are already in the local data directory", local.kind);
+            return std::ptr::null();
+        },
+    };
+    // Find all (unique) datasets to download
+    let mut seen: HashSet<&str> = HashSet::new();
+    let mut datasets: Vec<&str> = vec![];
+    let mut intermediate: bool = false;
+    for result in &results {
+        collect_datasets(result, &mut seen, &mut datasets, &mut intermediate);
+    }
+    if intermediate {
+        warn!("Cannot download intermediate result(s)");
+    }
+    if datasets.is_empty() {
+        debug!("Done (nothing to download)");
+        return std::ptr::null();
+    }
+    debug!("Downloading {} unique dataset(s)...", datasets.len());
+
+    // Refresh the data index once for all of them
+    let dindex: Arc<DataIndex> = match vm.refresh_dindex(&datasets) {
+        Ok(dindex) => dindex,
+        Err(err) => return Box::into_raw(Box::new(err)),
+    };
+
+    // Spawn a download for every dataset
+    let dopts: DownloadOptions = DownloadOptions { stream_extract: true, ..Default::default() };
+    let mut errs: Vec<String> = vec![];
+    let mut downloads: JoinSet<(String, Result<Option<AccessKind>, brane_cli::errors::DataError>)> = JoinSet::new();
+    for d in datasets {
+        let info: DataInfo = match dindex.get(d) {
+            Some(info) => info.clone(),
+            None => {
+                errs.push(format!("Resulting dataset '{d}' is not at any location"));
+                continue;
+            },
+        };
+        let (api_endpoint, certs_dir, data_dir): (String, String, PathBuf) = (api_endpoint.clone(), certs_dir.clone(), Path::new(data_dir).join(d));
+        downloads.spawn_on(
+            async move {
+                let start: Instant = Instant::now();
+                let res = download_data_cached(&api_endpoint, &None, &certs_dir, &data_dir, &info, &dopts).await;
+                METRICS_DOWNLOAD.record(start.elapsed(), res.is_ok());
+                (info.name, res)
+            },
+            vm.runtime.handle(),
+        );
+    }
+
+    // Wait for them all to complete
+    vm.runtime.block_on(async {
+        while let Some(res) = downloads.join_next().await {
+            match res {
+                Ok((_, Ok(res))) => {
+                    if let Some(AccessKind::File { path }) = res {
+                        info!("Downloaded dataset to '{}'", path.display());
+                    }
+                },
+                Ok((name, Err(e))) => errs.push(format!("Failed to download resulting dataset '{}' from '{}': {}", name, api_endpoint, e)),
+                Err(e) => errs.push(format!("Failed to join download task: {e}")),
+            }
+        }
+    });
+
+    // Report any errors that occurred
+    debug!("Done (processing took {:.2}s)", start.elapsed().as_secs_f32());
+    if !errs.is_empty() {
+        let err: Error = Error { msg: errs.join("\n") };
+        return Box::into_raw(Box::new(err));
+    }
+    std::ptr::null()
+}
+
+
+
+
+
+/***** ASYNCHRONOUS RUNS *****/
+/// Runs a workflow on a [`RunTarget`] in the background, collecting its prints and recording it in the metrics.
+///
+/// # Arguments
+/// - `target`: The [`RunTarget`] to run on.
+/// - `workflow`: The [`Workflow`] to execute.
+/// - `output`: The [`BytesHandle`] that was given to [`Backend::fork()`] for this `target`.
+/// - `cancel`: A receiver for the cancellation generation of the [`VirtualMachine`], subscribed when the run was scheduled.
+///
+/// # Returns
+/// The prints done by the workflow and its result.
+///
+/// # Errors
+/// This function errors if the workflow failed or was cancelled, or if its output was not valid UTF-8.
+async fn run_target(
+    target: RunTarget,
+    workflow: Workflow,
+    mut output: BytesHandle,
+    cancel: watch::Receiver<u64>,
+) -> Result<(String, FullValue), Error> {
+    let start: Instant = Instant::now();
+    let (what, res): (String, Result<FullValue, String>) = target.run(workflow, &mut output, interrupted(cancel, None)).await;
+    METRICS_RUN.record(start.elapsed(), res.is_ok());
+    match res {
+        Ok(value) => match output.flush_as_string() {
+            Ok(prints) => Ok((prints, value)),
+            Err(e) => Err(Error { msg: format!("Output of workflow on {what} is not valid UTF-8: {e}") }),
+        },
+        Err(e) => Err(Error { msg: format!("Failed to run workflow on {what}: {e}") }),
+    }
+}
+
+/// Defines the callback that is called when a workflow started with [`vm_run_async()`] completes.
+///
+/// # Arguments
+/// - `user_data`: The opaque pointer given to [`vm_run_async()`].
+/// - `err`: An [`Error`]-struct that describes why the run failed, or [`NULL`] if it succeeded. If non-[`NULL`], the callback owns it and has to free it using [`error_free()`].
+/// - `prints`: A newly allocated string with any stdout- or stderr prints done during workflow execution, or [`NULL`] if the run failed. Can be freed using `free()`.
+/// - `result`: A [`FullValue`] which represents the return value of the workflow, or [`NULL`] if the run failed. Has to be freed using [`fvalue_free()`].
+pub type RunCallback = unsafe extern "C" fn(user_data: *mut c_void, err: *mut Error, prints: *mut c_char, result: *mut FullValue);
+
+/// Defines a handle to a workflow that is running in the background.
+///
+/// It can be polled with [`vm_run_poll()`] and joined with [`vm_run_wait()`].
+pub struct RunHandle {
+    /// The tokio runtime handle on which the run is scheduled.
+    runtime: Arc<Runtime>,
+    /// The handle to the task doing the running. Is [`None`] once it has been joined. The task itself returns [`None`] if its result has already been given to a callback.
+    handle:  Option<JoinHandle<Option<Result<(String, FullValue), Error>>>>,
+}
+
+
+
+/// Runs the given code snippet on the backend instance in the background.
+///
+/// This function returns immediately; the workflow is executed on the library's runtime. Once it completes, the given `callback` is called (on one of the runtime's threads) with the result. If no callback is given, the result can be retrieved with [`vm_run_wait()`] instead.
+///
+/// The run can be stopped with [`vm_cancel()`], in which case it completes with an error.
+///
+/// # Safety
+/// The `callback` is called from a thread that is not the caller's. It must not free the last object keeping the runtime alive (i.e., it must not call [`runhandle_free()`] on its own handle).
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use. It may be used (or freed) again immediately after this call returns.
+/// - `workflow`: The compiled workflow to execute. It is copied, so it may be freed immediately after this call returns.
+/// - `callback`: An optional [`RunCallback`] to call when the workflow completes. If [`NULL`], the result is kept until [`vm_run_wait()`] is called.
+/// - `user_data`: Some opaque pointer that is given back to the `callback`.
+/// - `handle`: Will point to a new [`RunHandle`] that represents the background run. Will be [`NULL`] if there is an error (see below).
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+#[no_mangle]
+pub unsafe extern "C" fn vm_run_async(
+    vm: *const VirtualMachine,
+    workflow: *const Workflow,
+    callback: Option<RunCallback>,
+    user_data: *mut c_void,
+    handle: *mut *mut RunHandle,
+) -> *const Error {
+    init_logger();
+    *handle = std::ptr::null_mut();
+    info!("Scheduling workflow on virtual machine...");
+
+    // Unwrap the VM
+    let vm: &VirtualMachine = match vm.as_ref() {
+        Some(vm) => vm,
+        None => {
+            panic!("Given VirtualMachine is a NULL-pointer");
+        },
+    };
+    // Unwrap the workflow
+    let workflow: Workflow = match workflow.as_ref() {
+        Some(workflow) => workflow.clone(),
+        None => {
+            panic!("Given Workflow is a NULL-pointer");
+        },
+    };
+
+    // Prepare a state that we can move into the task
+    let output: BytesHandle = BytesHandle::with_sink(vm.output.sink.clone());
+    let target: RunTarget = vm.backend.fork(output.clone());
+    let cancel: watch::Receiver<u64> = vm.cancel.subscribe();
+    let user_data: UserData = UserData(user_data);
+
+    // Spawn the task that does the running. It keeps the runtime alive itself, since the host may free the VM and the handle before it completes
+    debug!("Spawning snippet execution...");
+    let runtime: Arc<Runtime> = vm.runtime.clone();
+    let task: JoinHandle<Option<Result<(String, FullValue), Error>>> = vm.runtime.spawn(async move {
+        let start: Instant = Instant::now();
+
+        // Run the workflow and collect the result
+        let res: Result<(String, FullValue), Error> = run_target(target, workflow, output, cancel).await;
+        debug!("Done (background execution took {:.2}s)", start.elapsed().as_secs_f32());
+
+        // Either give it to the callback or keep it for whomever waits
+        let res: Option<Result<(String, FullValue), Error>> = match callback {
+            Some(callback) => {
+                let user_data: UserData = user_data;
+                match res {
+                    // SAFETY: The host promised us the callback is valid, and we give it ownership of the allocated objects.
+                    Ok((prints, value)) => unsafe {
+                        callback(user_data.0, std::ptr::null_mut(), rust_to_cstr(prints), Box::into_raw(Box::new(value)));
+                    },
+                    Err(err) => unsafe {
+                        callback(user_data.0, Box::into_raw(Box::new(err)), std::ptr::null_mut(), std::ptr::null_mut());
+                    },
+                }
+                None
+            },
+            None => Some(res),
+        };
+
+        // If the host freed everything else in the meantime, then we are the ones that have to clean up the runtime
+        release_runtime(runtime);
+        res
+    });
+
+    // Wrap the task in a handle and done
+    *handle = Box::into_raw(Box::new(RunHandle { runtime: vm.runtime.clone(), handle: Some(task) }));
+    std::ptr::null()
+}
+
+/// Checks if the workflow represented by the given [`RunHandle`] has completed.
+///
+/// # Arguments
+/// - `handle`: The [`RunHandle`] to poll.
+///
+/// # Returns
+/// True if the run has completed (and [`vm_run_wait()`] will not block), or false otherwise.
+///
+/// # Panics
+/// This function can panic if the given `handle` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_run_poll(handle: *const RunHandle) -> bool {
+    // Unwrap the handle
+    let handle: &RunHandle = match handle.as_ref() {
+        Some(handle) => handle,
+        None => {
+            panic!("Given RunHandle is a NULL-pointer");
+        },
+    };
+
+    // Check the task, if any
+    match &handle.handle {
+        Some(task) => task.is_finished(),
+        None => true,
+    }
+}
+
+/// Waits until the workflow represented by the given [`RunHandle`] has completed.
+///
+/// If the run was started with a callback, then the results have already been given to it and `prints` and `result` will be [`NULL`].
+///
+/// This function cannot be called from one of the library's runtime threads, such as from within a callback; it returns an error instead of waiting there.
+///
+/// # Arguments
+/// - `handle`: The [`RunHandle`] to wait for.
+/// - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below) or if a callback was given.
+/// - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below) or if a callback was given.
+///
+/// # Returns
+/// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
+///
+/// # Panics
+/// This function can panic if the given `handle` is a NULL-pointer.
+#[allow(clippy::missing_safety_doc)]
+#[no_mangle]
+pub unsafe extern "C" fn vm_run_wait(handle: *mut RunHandle, prints: *mut *mut c_char, result: *mut *mut FullValue) -> *const Error {
+    init_logger();
+    *prints = std::ptr::null_mut();
+    *result = std::ptr::null_mut();
+    debug!("Waiting for background workflow to complete...");
+
+    // Unwrap the handle
+    let handle: &mut RunHandle = match handle.as_mut() {
+        Some(handle) => handle,
+        None => {
+            panic!("Given RunHandle is a NULL-pointer");
+        },
+    };
+
+    // Blocking on the runtime from one of its own threads (e.g., in a callback) would panic
+    if tokio::runtime::Handle::try_current().is_ok() {
+        let err: Error = Error { msg: "Cannot wait for a background workflow on one of the library's runtime threads (e.g., in a callback)".into() };
+        return Box::into_raw(Box::new(err));
+    }
+
+    // Take the task to join it
+    let task: JoinHandle<Option<Result<(String, FullValue), Error>>> = match handle.handle.take() {
+        Some(task) => task,
+        None => {
+            let err: Error = Error { msg: "Background workflow has already been waited for".into() };
+            return Box::into_raw(Box::new(err));
+        },
+    };
+    match handle.runtime.block_on(task) {
+        Ok(Some(Ok((sprints, value)))) => {
+            *prints = rust_to_cstr(sprints);
+            *result = Box::into_raw(Box::new(value));
+            std::ptr::null()
+        },
+        Ok(Some(Err(err))) => Box::into_raw(Box::new(err)),
+        Ok(None) => std::ptr::null(),
+        Err(e) => {
+            let err: Error = Error { msg: format!("Failed to join background workflow: {e}") };
+            Box::into_raw(Box::new(err))
+        },
+    }
+}
+
+/// Destructor for the RunHandle.
+///
+/// Note that freeing the handle does _not_ stop the run; if it was started with a callback, it will still be called when the workflow completes, even if the [`VirtualMachine`] has been freed as well.
+///
+/// # Safety
+/// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
+///
+/// # Arguments
+/// - `handle`: The [`RunHandle`] to free.
+#[no_mangle]
+pub unsafe extern "C" fn runhandle_free(handle: *mut RunHandle) {
+    init_logger();
+    trace!("Destroying RunHandle...");
+
+    // Take ownership of the handle and then drop it to destroy
+    drop(Box::from_raw(handle));
+    cleanup_runtime();
 }
 
-/// Serializes a FullValue to show as result of the workflow.
+
+
+/// Defines the callback that is called whenever one of the workflows given to [`vm_run_batch()`] completes.
 ///
 /// # Arguments
-/// - `fvalue`: the [`FullValue`] to serialize.
-/// - `data_dir`: The data directory to which we downloaded the `fvalue`, if we did so.
-/// - `result`: The buffer to serialize to. Will be freshly allocated using `malloc` for the correct size; can be freed using `free()`.
+/// - `user_data`: The opaque pointer given to [`vm_run_batch()`].
+/// - `index`: The index of the workflow that completed in the array given to [`vm_run_batch()`].
+/// - `err`: An [`Error`]-struct that describes why the run failed, or [`NULL`] if it succeeded. If non-[`NULL`], the callback owns it and has to free it using [`error_free()`].
+/// - `prints`: A newly allocated string with any stdout- or stderr prints done during workflow execution, or [`NULL`] if the run failed. Can be freed using `free()`.
+/// - `result`: A [`FullValue`] which represents the return value of the workflow, or [`NULL`] if the run failed. Has to be freed using [`fvalue_free()`].
+pub type BatchCallback = unsafe extern "C" fn(user_data: *mut c_void, index: usize, err: *mut Error, prints: *mut c_char, result: *mut FullValue);
+
+/// Runs many workflows on the backend concurrently, giving their results to a callback as they complete.
+///
+/// For instances, all workflows are submitted in the VM's session over its (shared) connection to the driver. Up to `concurrency` of them are in flight at the same time, so a sweep of many small workflows is not limited by a round-trip per workflow. Local VMs still run one workflow at a time.
+///
+/// The workflows must be independent of each other. They run concurrently in the same session, and the driver does not order them: they cannot use each other's variables, and which of their definitions the session keeps for later runs is undefined. Like any other run, the batch can be stopped with [`vm_cancel()`], in which case the remaining workflows fail.
+///
+/// # Arguments
+/// - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+/// - `workflows`: An array of the compiled workflows to execute. They are copied, so they may be freed as soon as this call returns.
+/// - `n`: The number of workflows in the `workflows` array.
+/// - `concurrency`: The maximum number of workflows that run at the same time. `0` means all of them.
+/// - `callback`: The [`BatchCallback`] that is called for every workflow that completes. It is called on the thread that called this function, in the order in which the workflows complete.
+/// - `user_data`: Some opaque pointer that is given back to the `callback`.
+///
+/// # Returns
+/// An [`Error`]-struct that says how many workflows failed, or [`NULL`] if all of them succeeded. Why they failed is given to the `callback`.
 ///
 /// # Panics
-/// This function can panic if the given `fvalue` is a NULL-pointer or if `data_dir` did not point to a valid UTF-8 string.
+/// This function may panic if the input `vm`, `workflows` (with `n > 0`), any of the workflows or the `callback` pointed to a NULL-pointer.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn fvalue_serialize(fvalue: *const FullValue, data_dir: *const c_char, result: *mut *mut c_char) {
-    *result = std::ptr::null_mut();
+pub unsafe extern "C" fn vm_run_batch(
+    vm: *const VirtualMachine,
+    workflows: *const *const Workflow,
+    n: usize,
+    concurrency: usize,
+    callback: Option<BatchCallback>,
+    user_data: *mut c_void,
+) -> *const Error {
+    init_logger();
+    info!("Executing batch of {n} workflow(s) on virtual machine...");
+    let start: Instant = Instant::now();
 
-    // Unwrap the pointers
-    let fvalue: &FullValue = match fvalue.as_ref() {
-        Some(fvalue) => fvalue,
+    // Unwrap the VM
+    let vm: &VirtualMachine = match vm.as_ref() {
+        Some(vm) => vm,
         None => {
-            panic!("Given FullValue is a NULL-pointer");
+            panic!("Given VirtualMachine is a NULL-pointer");
         },
     };
-    let data_dir: PathBuf = PathBuf::from(cstr_to_rust(data_dir));
-
-    // Serialize the result only if there is anything to serialize
-    let mut sfvalue: String = String::new();
-    if fvalue != &FullValue::Void {
-        writeln!(&mut sfvalue, "\nWorkflow returned value {}", style(format!("'{fvalue}'")).bold().cyan()).unwrap();
-
-        // Treat some values special
-        match fvalue {
-            // Print sommat additional if it's an intermediate result.
-            FullValue::IntermediateResult(_) => {
-                writeln!(&mut sfvalue, "(Intermediate results are not available locally; promote it using 'commit_result()')").unwrap();
-            },
-
-            // If it's a dataset, show where to access it
-            FullValue::Data(name) => {
-                writeln!(&mut sfvalue, "(It's available under '{}')", data_dir.join(name.as_ref()).display()).unwrap();
+    // Unwrap the workflows
+    if workflows.is_null() && n > 0 {
+        panic!("Given Workflow array is a NULL-pointer");
+    }
+    let workflows: &[*const Workflow] = if n > 0 { std::slice::from_raw_parts(workflows, n) } else { &[] };
+    let mut workflows: VecDeque<(usize, Workflow)> = workflows
+        .iter()
+        .enumerate()
+        .map(|(i, workflow)| match workflow.as_ref() {
+            Some(workflow) => (i, workflow.clone()),
+            None => {
+                panic!("Given Workflow {i} is a NULL-pointer");
             },
+        })
+        .collect();
+    // Unwrap the callback
+    let callback: BatchCallback = match callback {
+        Some(callback) => callback,
+        None => {
+            panic!("Given BatchCallback is a NULL-pointer");
+        },
+    };
+    let concurrency: usize = if concurrency == 0 { n.max(1) } else { concurrency };
+
+    // Keep up to `concurrency` workflows in flight, handing results to the host as they come in
+    let cancel: watch::Receiver<u64> = vm.cancel.subscribe();
+    let mut running: JoinSet<(usize, Result<(String, FullValue), Error>)> = JoinSet::new();
+    let mut failed: usize = 0;
+    vm.runtime.block_on(async {
+        loop {
+            while running.len() < concurrency {
+                let (i, workflow): (usize, Workflow) = match workflows.pop_front() {
+                    Some(next) => next,
+                    None => break,
+                };
+                let output: BytesHandle = BytesHandle::with_sink(vm.output.sink.clone());
+                let target: RunTarget = vm.backend.fork(output.clone());
+                let cancel: watch::Receiver<u64> = cancel.clone();
+
+                // The run itself is a separate task, so that we still know which workflow it was if it panics
+                let run: JoinHandle<Result<(String, FullValue), Error>> = vm.runtime.spawn(run_target(target, workflow, output, cancel));
+                running.spawn_on(
+                    async move {
+                        match run.await {
+                            Ok(res) => (i, res),
+                            Err(e) => (i, Err(Error { msg: format!("Failed to join batch task: {e}") })),
+                        }
+                    },
+                    vm.runtime.handle(),
+                );
+            }
 
-            // Nothing for the rest
-            _ => {},
+            // Wait for the next one to complete
+            let (i, res): (usize, Result<(String, FullValue), Error>) = match running.join_next().await {
+                Some(Ok(res)) => res,
+                Some(Err(e)) => {
+                    // Only awaiting the run failed, which can only happen if the runtime shuts down; we cannot tell which workflow it was
+                    error!("Failed to join batch task: {e}");
+                    failed += 1;
+                    continue;
+                },
+                None => break,
+            };
+            match res {
+                // SAFETY: The host promised us the callback is valid, and we give it ownership of the allocated objects.
+                Ok((prints, value)) => unsafe {
+                    callback(user_data, i, std::ptr::null_mut(), rust_to_cstr(prints), Box::into_raw(Box::new(value)));
+                },
+                Err(err) => {
+                    failed += 1;
+                    unsafe { callback(user_data, i, Box::into_raw(Box::new(err)), std::ptr::null_mut(), std::ptr::null_mut()) };
+                },
+            }
         }
-    }
-
-    // That's what we serialize to the output
-    *result = rust_to_cstr(sfvalue);
+    });
 
-    // Done!
+    // Report how it went
+    debug!("Done (batch execution took {:.2}s)", start.elapsed().as_secs_f32());
+    if failed > 0 {
+        let err: Error = Error { msg: format!("{failed} out of {n} workflow(s) failed") };
+        return Box::into_raw(Box::new(err));
+    }
+    std::ptr::null()
 }
 
 
 
 
 
-/***** VIRTUAL MACHINE *****/
-/// Defines a BRANE instance virtual machine.
+/***** VM POOL *****/
+/// Defines a pool of [`VirtualMachine`]s on the same instance that may be used from many threads at once.
 ///
-/// This can run a compiled workflow on a running instance.
-pub struct VirtualMachine {
-    /// The tokio runtime handle to use for this VM
-    runtime: Arc<Runtime>,
-    /// The endpoint to connect to for downloading registries
-    api_endpoint: String,
-    /// The endpoint to connect to when running.
-    drv_endpoint: String,
-    /// The directory of certificates to use.
-    certs_dir: String,
-    /// The state of everything we need to know about the virtual machine
-    state: InstanceVmState<BytesHandle, BytesHandle>,
+/// A [`VirtualMachine`] may only be used by one thread at a time. A pool, on the other hand, can be shared between any number of threads without locking it yourself: every call checks out one of the pool's VMs for its duration, waiting for one to be returned if all of them are in use. The VMs share the package and data index and the connections to the driver, but each has its own session. Because consecutive calls may land on different VMs, the snippets run on a pool must be stateless: a snippet cannot use the variables, functions or classes defined by an earlier one. Use a single [`VirtualMachine`] per session for REPL-like use instead.
+pub struct VmPool {
+    /// The VMs that are not checked out by any call right now.
+    idle:     Mutex<Vec<Box<VirtualMachine>>>,
+    /// Notified whenever a VM is returned to `idle`.
+    returned: Condvar,
+    /// The total number of VMs in this pool.
+    size:     usize,
+}
+
+impl VmPool {
+    /// Takes a [`VirtualMachine`] out of this pool, waiting until one is available.
+    ///
+    /// # Returns
+    /// A [`PooledVm`] that returns the VM to this pool once it is dropped.
+    fn checkout(&self) -> PooledVm<'_> {
+        let mut idle: MutexGuard<Vec<Box<VirtualMachine>>> = self.idle.lock();
+        loop {
+            if let Some(vm) = idle.pop() {
+                return PooledVm { pool: self, vm: Some(vm) };
+            }
+            self.returned.wait(&mut idle);
+        }
+    }
 }
 
+/// Defines a [`VirtualMachine`] that is checked out of a [`VmPool`], and which is returned to it when dropped (even if the call panics).
+struct PooledVm<'p> {
+    /// The pool to return the VM to.
+    pool: &'p VmPool,
+    /// The checked out VM. Is only [`None`] while it is being returned.
+    vm:   Option<Box<VirtualMachine>>,
+}
 
+impl PooledVm<'_> {
+    /// Returns a pointer to the checked out VM, for use with the `vm_*()` functions.
+    #[inline]
+    fn as_ptr(&mut self) -> *mut VirtualMachine { &mut **self.vm.as_mut().unwrap() }
+}
 
-/// Constructor for the VirtualMachine.
+impl Drop for PooledVm<'_> {
+    fn drop(&mut self) {
+        if let Some(vm) = self.vm.take() {
+            self.pool.idle.lock().push(vm);
+            self.pool.returned.notify_one();
+        }
+    }
+}
+
+
+
+/// Constructor for the VmPool.
+///
+/// Creates `size` virtual machines in the same way as [`vm_new()`], which share the given indices and all connections to the driver.
 ///
 /// # Arguments
 /// - `api_endpoint`: The Brane API endpoint to connect to to download available registries and all that.
@@ -1233,7 +6355,8 @@ pub struct VirtualMachine {
 /// - `certs_dir`: The directory where certificates for downloading datasets are stored.
 /// - `pindex`: The [`PackageIndex`] to resolve package references in the snippets with.
 /// - `dindex`: The [`DataIndex`] to resolve dataset references in the snippets with.
-/// - `virtual_machine`: Will point to the newly created [`VirtualMachine`] when done. Will be [`NULL`] if there is an error (see below).
+/// - `size`: The number of virtual machines in the pool, i.e., how many calls can run at the same time. Must be at least 1.
+/// - `pool`: Will point to the newly created [`VmPool`] when done. Will be [`NULL`] if there is an error (see below).
 ///
 /// # Returns
 /// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
@@ -1242,104 +6365,76 @@ pub struct VirtualMachine {
 /// This function can panic if the given `pindex` or `dindex` are NULL, or if the given `api_endpoint`, `drv_endpoint` or `certs_dir` do not point to a valid UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn vm_new(
+pub unsafe extern "C" fn vmpool_new(
     api_endpoint: *const c_char,
     drv_endpoint: *const c_char,
     certs_dir: *const c_char,
-    pindex: *const Arc<Mutex<PackageIndex>>,
-    dindex: *const Arc<Mutex<DataIndex>>,
-    vm: *mut *mut VirtualMachine,
+    pindex: *const Arc<ArcSwap<PackageIndex>>,
+    dindex: *const Arc<ArcSwap<DataIndex>>,
+    size: usize,
+    pool: *mut *mut VmPool,
 ) -> *const Error {
     init_logger();
-    *vm = std::ptr::null_mut();
-    info!("Constructing BraneScript virtual machine v{}...", env!("CARGO_PKG_VERSION"));
-
-    // Read the endpoints & directories
-    let api_endpoint: &str = cstr_to_rust(api_endpoint);
-    let drv_endpoint: &str = cstr_to_rust(drv_endpoint);
-    let certs_dir: &str = cstr_to_rust(certs_dir);
-
-    // Read the indices
-    let pindex: &Arc<Mutex<PackageIndex>> = match pindex.as_ref() {
-        Some(index) => index,
-        None => {
-            panic!("Given PackageIndex is a NULL-pointer");
-        },
-    };
-    let dindex: &Arc<Mutex<DataIndex>> = match dindex.as_ref() {
-        Some(index) => index,
-        None => {
-            panic!("Given DataIndex is a NULL-pointer");
-        },
-    };
-
-    // Prepare a tokio environment
-    let runtime: Arc<Runtime> = match init_runtime() {
-        Ok(runtime) => runtime,
-        Err(e) => {
-            let err: Error = Error { msg: format!("Failed to create local Tokio context: {e}") };
-            return Box::into_raw(Box::new(err));
-        },
-    };
+    *pool = std::ptr::null_mut();
+    info!("Constructing pool of {size} virtual machine(s)...");
+    if size == 0 {
+        let err: Error = Error { msg: "Cannot create a pool of zero virtual machines".into() };
+        return Box::into_raw(Box::new(err));
+    }
 
-    // Prepare the state
-    let handle: BytesHandle = BytesHandle::new();
-    let state: InstanceVmState<BytesHandle, BytesHandle> = match runtime.block_on(initialize_instance(
-        handle.clone(),
-        handle,
-        drv_endpoint,
-        pindex.clone(),
-        dindex.clone(),
-        /* TODO: Add user here as well */
-        None,
-        None,
-        ParserOptions::bscript(),
-    )) {
-        Ok(state) => state,
-        Err(e) => {
-            let err: Error = Error { msg: format!("Failed to create new InstanceVmState: {e}") };
-            return Box::into_raw(Box::new(err));
-        },
-    };
+    // Create the VMs one-by-one, cleaning up the ones we already made if any of them fails
+    let mut vms: Vec<Box<VirtualMachine>> = Vec::with_capacity(size);
+    for _ in 0..size {
+        let mut vm: *mut VirtualMachine = std::ptr::null_mut();
+        let err: *const Error = vm_new(api_endpoint, drv_endpoint, certs_dir, pindex, dindex, &mut vm);
+        if !err.is_null() {
+            for vm in vms {
+                vm_free(Box::into_raw(vm));
+            }
+            return err;
+        }
+        vms.push(Box::from_raw(vm));
+    }
 
     // OK, return the new thing
-    *vm = Box::into_raw(Box::new(VirtualMachine {
-        runtime,
-        api_endpoint: api_endpoint.into(),
-        drv_endpoint: drv_endpoint.into(),
-        certs_dir: certs_dir.into(),
-        state,
-    }));
-    debug!("Virtual machine created");
+    *pool = Box::into_raw(Box::new(VmPool { idle: Mutex::new(vms), returned: Condvar::new(), size }));
+    debug!("Virtual machine pool created");
     std::ptr::null()
 }
 
-/// Destructor for the VirtualMachine.
+/// Destructor for the VmPool.
 ///
 /// # Safety
 /// You _must_ call this destructor yourself whenever you are done with the struct to cleanup any code. _Don't_ use any C-library free!
 ///
+/// Unlike the other `vmpool_*()` functions, this function must not be called while any other thread is still using the pool.
+///
 /// # Arguments
-/// - `vm`: The [`VirtualMachine`] to free.
+/// - `pool`: The [`VmPool`] to free.
 #[no_mangle]
-pub unsafe extern "C" fn vm_free(vm: *mut VirtualMachine) {
+pub unsafe extern "C" fn vmpool_free(pool: *mut VmPool) {
     init_logger();
-    trace!("Destroying VirtualMachine...");
-
-    // See if the global context needs to be destroyed
-    cleanup_runtime();
+    trace!("Destroying VmPool...");
 
-    // Take ownership of the VM and then drop it to destroy
-    drop(Box::from_raw(vm));
-    cleanup_runtime();
+    // Take ownership of the pool, and then free its VMs like any other
+    let pool: VmPool = *Box::from_raw(pool);
+    let vms: Vec<Box<VirtualMachine>> = pool.idle.into_inner();
+    if vms.len() < pool.size {
+        warn!("Freeing virtual machine pool while {} of its {} virtual machine(s) are still in use", pool.size - vms.len(), pool.size);
+    }
+    for vm in vms {
+        vm_free(Box::into_raw(vm));
+    }
 }
 
-
-
-/// Runs the given code snippet on the backend instance.
+/// Runs the given code snippet on one of the pool's virtual machines.
+///
+/// This is the same as [`vm_run()`], except that it may be called from many threads at the same time. If all of the pool's virtual machines are in use, it blocks until one of them is returned.
+///
+/// The snippet runs in the session of whichever virtual machine is free, so it must not depend on the definitions of earlier snippets (see [`VmPool`]).
 ///
 /// # Arguments
-/// - `vm`: The [`VirtualMachine`] that we execute with. This determines which backend to use.
+/// - `pool`: The [`VmPool`] to take a virtual machine from.
 /// - `workflow`: The compiled workflow to execute.
 /// - `prints`: A newly allocated string which represents any stdout- or stderr prints done during workflow execution. Will be [`NULL`] if there is an error (see below).
 /// - `result`: A [`FullValue`] which represents the return value of the workflow. Will be [`NULL`] if there is an error (see below).
@@ -1348,142 +6443,58 @@ pub unsafe extern "C" fn vm_free(vm: *mut VirtualMachine) {
 /// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
 ///
 /// # Panics
-/// This function may panic if the input `vm` or `workflow` pointed to a NULL-pointer.
+/// This function may panic if the input `pool` or `workflow` pointed to a NULL-pointer.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn vm_run(
-    vm: *mut VirtualMachine,
+pub unsafe extern "C" fn vmpool_run(
+    pool: *const VmPool,
     workflow: *const Workflow,
     prints: *mut *mut c_char,
     result: *mut *mut FullValue,
 ) -> *const Error {
     init_logger();
-    *prints = std::ptr::null_mut();
-    *result = std::ptr::null_mut();
-    info!("Executing workflow on virtual machine...");
-    let start: Instant = Instant::now();
 
-    // Unwrap the VM
-    let vm: &mut VirtualMachine = match vm.as_mut() {
-        Some(vm) => vm,
-        None => {
-            panic!("Given VirtualMachine is a NULL-pointer");
-        },
-    };
-    // Unwrap the workflow
-    let workflow: &Workflow = match workflow.as_ref() {
-        Some(workflow) => workflow,
+    // Unwrap the pool
+    let pool: &VmPool = match pool.as_ref() {
+        Some(pool) => pool,
         None => {
-            panic!("Given Workflow is a NULL-pointer");
-        },
-    };
-
-    // Run the state
-    debug!("Executing snippet...");
-    let value: FullValue = match vm.runtime.block_on(run_instance(&vm.drv_endpoint, &mut vm.state, workflow, false)) {
-        Ok(value) => value,
-        Err(e) => {
-            let err: Box<Error> = Box::new(Error { msg: format!("Failed to run workflow on '{}': {}", vm.drv_endpoint, e) });
-            return Box::into_raw(err);
+            panic!("Given VmPool is a NULL-pointer");
         },
     };
 
-    // Store it and we're done!
-    *prints = rust_to_cstr(vm.state.stdout.flush_as_string().unwrap());
-    *result = Box::into_raw(Box::new(value));
-    debug!("Done (execution took {:.2}s)", start.elapsed().as_secs_f32());
-    std::ptr::null()
+    // Run it on whichever VM is free
+    let mut vm: PooledVm = pool.checkout();
+    vm_run(vm.as_ptr(), workflow, prints, result)
 }
 
-/// Processes the result referred to by the [`FullValue`].
+/// Processes the result referred to by the [`FullValue`] using one of the pool's virtual machines.
 ///
-/// Processing currently consists of:
-/// - Downloading the dataset if it's a [`FullValue::Data`]
-/// - Throwing a warning if it's a [`FullValue::IntermediateResult`]
-/// - Doing nothing otherwise
+/// This is the same as [`vm_process()`], except that it may be called from many threads at the same time. If all of the pool's virtual machines are in use, it blocks until one of them is returned.
 ///
 /// # Arguments
-/// - `vm`: The [`VirtualMachine`] that we download with. This determines which backend to use.
+/// - `pool`: The [`VmPool`] to take a virtual machine from.
 /// - `result`: The [`FullValue`] which we will attempt to download if needed.
-/// - `data_dir`: The directory to download the result to. This should be the generic data directory, as a new directory for this dataset will be created within.
+/// - `data_dir`: The directory to download the result to. This should be the generic data directory: the dataset is extracted to `<data_dir>/<name>/data` (next to a `data.yml` describing it), which is also where [`fvalue_serialize()`] says it is.
 ///
 /// # Returns
 /// An [`Error`]-struct that contains the error occurred, or [`NULL`] otherwise.
 ///
 /// # Panics
-/// This function may panic if the input `vm` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
+/// This function may panic if the input `pool` or `result` pointed to a NULL-pointer, or if `data_dir` did not point to a valid UTF-8 string.
 #[allow(clippy::missing_safety_doc)]
 #[no_mangle]
-pub unsafe extern "C" fn vm_process(vm: *mut VirtualMachine, result: *const FullValue, data_dir: *const c_char) -> *const Error {
+pub unsafe extern "C" fn vmpool_process(pool: *const VmPool, result: *const FullValue, data_dir: *const c_char) -> *const Error {
     init_logger();
-    info!("Processing result on virtual machine...");
-    let start: Instant = Instant::now();
 
-    // Unwrap the VM
-    let vm: &mut VirtualMachine = match vm.as_mut() {
-        Some(vm) => vm,
-        None => {
-            panic!("Given VirtualMachine is a NULL-pointer");
-        },
-    };
-    // Unwrap the result
-    let result: &FullValue = match result.as_ref() {
-        Some(result) => result,
+    // Unwrap the pool
+    let pool: &VmPool = match pool.as_ref() {
+        Some(pool) => pool,
         None => {
-            panic!("Given FullValue is a NULL-pointer");
+            panic!("Given VmPool is a NULL-pointer");
         },
     };
-    // Read the string
-    let data_dir: &str = cstr_to_rust(data_dir);
-
-    // If the value is a dataset, then download the data on top of it
-    if let FullValue::Data(d) = &result {
-        debug!("FullValue is a FullValue::Data, downloading...");
 
-        // Refresh the data index and get the access list for this dataset
-        let access: HashMap<String, AccessKind> = {
-            // Get a mutable lock to do so
-            let mut dindex: MutexGuard<DataIndex> = vm.state.dindex.lock();
-
-            // Simply load it again
-            let data_endpoint: String = format!("{}/data/info", vm.api_endpoint);
-            *dindex = match vm.runtime.block_on(get_data_index(data_endpoint)) {
-                Ok(index) => index,
-                Err(e) => {
-                    let err: Box<Error> = Box::new(Error { msg: format!("Failed to refresh data index: {e}") });
-                    return Box::into_raw(err);
-                },
-            };
-
-            // Fetch the correct map
-            match dindex.get(d) {
-                Some(info) => info.access.clone(),
-                None => {
-                    let err: Box<Error> = Box::new(Error { msg: format!("Resulting dataset '{d}' is not at any location") });
-                    return Box::into_raw(err);
-                },
-            }
-        };
-
-        // Run the process funtion
-        let res: Option<AccessKind> = match vm.runtime.block_on(download_data(&vm.api_endpoint, &None, &vm.certs_dir, data_dir, d, &access)) {
-            Ok(res) => res,
-            Err(e) => {
-                let err: Box<Error> = Box::new(Error { msg: format!("Failed to download resulting data from '{}': {}", vm.api_endpoint, e) });
-                return Box::into_raw(err);
-            },
-        };
-        if let Some(AccessKind::File { path }) = res {
-            info!("Downloaded dataset to '{}'", path.display());
-        }
-    } else if matches!(result, FullValue::IntermediateResult(_)) {
-        debug!("FullValue is a FullValue::IntermediateResult, downloading...");
-
-        // Emit a warning
-        warn!("Cannot download intermediate result");
-    }
-
-    // OK, nothing to return
-    debug!("Done (processing took {:.2}s)", start.elapsed().as_secs_f32());
-    std::ptr::null()
+    // Process it with whichever VM is free
+    let mut vm: PooledVm = pool.checkout();
+    vm_process(vm.as_ptr(), result, data_dir)
 }
@@ -4,7 +4,7 @@
 //  Created:
 //    12 Sep 2022, 17:39:06
 //  Last edited:
-//    26 Jul 2023, 09:36:57
+//    14 Oct 2026, 20:39:42
 //  Auto updated?
 //    Yes
 //
@@ -15,6 +15,7 @@
 use std::borrow::Cow;
 use std::collections::HashMap;
 use std::fs;
+use std::io::SeekFrom;
 use std::path::{Path, PathBuf};
 use std::time::Duration;
 
@@ -29,61 +30,419 @@ use hyper::body::Bytes;
 use indicatif::HumanDuration;
 use prettytable::format::FormatBuilder;
 use prettytable::Table;
-use rand::prelude::IteratorRandom;
+use rand::seq::SliceRandom;
+use reqwest::header::{CONTENT_RANGE, ETAG, IF_RANGE, RANGE};
 use reqwest::tls::{Certificate, Identity};
-use reqwest::{Client, ClientBuilder, Proxy, Response};
+use reqwest::{Client, ClientBuilder, Proxy, Response, StatusCode};
+use serde::{Deserialize, Serialize};
+use sha2::{Digest as _, Sha256};
 use specifications::data::{AccessKind, AssetInfo, DataIndex, DataInfo};
-use tempfile::TempDir;
 use tokio::fs as tfs;
-use tokio::io::AsyncWriteExt;
-use tokio_stream::StreamExt;
+use tokio::io::{AsyncReadExt as _, AsyncSeekExt as _, AsyncWriteExt};
+use tokio_stream::{Stream, StreamExt};
+use tokio_util::io::StreamReader;
 
 use crate::errors::DataError;
 use crate::instance::InstanceInfo;
 use crate::utils::{ensure_dataset_dir, ensure_datasets_dir, get_dataset_dir};
 
 
-/***** LIBRARY *****/
-/// Attempts to download the given dataset from the instance.
+/***** TESTS *****/
+#[cfg(test)]
+mod tests {
+    use std::sync::atomic::{AtomicUsize, Ordering};
+    use std::sync::Arc;
+
+    use tokio::io::AsyncReadExt as _;
+    use tokio::net::TcpListener;
+
+    use super::*;
+
+
+    /// The size of the archive served by [`serve()`].
+    const SIZE: usize = 64;
+
+    /// Describes how the server spawned by [`serve()`] behaves.
+    #[derive(Default)]
+    struct Archive {
+        /// Whether to identify the archive with a strong ETag.
+        etag:    bool,
+        /// The version of the archive that is currently served. Every version has different contents.
+        version: AtomicUsize,
+        /// If non-zero, the connection of the next response breaks after this many bytes of its body.
+        cut:     AtomicUsize,
+        /// Whether the archive changes when a connection breaks.
+        fickle:  bool,
+    }
+    impl Archive {
+        /// Returns the contents of the archive's current version.
+        fn contents(&self) -> Vec<u8> {
+            let version: usize = self.version.load(Ordering::SeqCst);
+            (0..SIZE).map(|i| (i + 31 * version) as u8).collect()
+        }
+
+        /// Returns the ETag of the archive's current version.
+        fn etag(&self) -> String { format!("\"v{}\"", self.version.load(Ordering::SeqCst)) }
+    }
+
+    /// Spawns a minimal HTTP server that serves the given [`Archive`], and that honours `Range` (and `If-Range`) like a registry with stable archives would.
+    ///
+    /// # Arguments
+    /// - `archive`: The [`Archive`] to serve.
+    ///
+    /// # Returns
+    /// The address of the archive.
+    async fn serve(archive: Arc<Archive>) -> String {
+        let listener: TcpListener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let address: String = format!("http://{}/archive", listener.local_addr().unwrap());
+        tokio::spawn(async move {
+            loop {
+                let (mut conn, _) = listener.accept().await.unwrap();
+                let archive: Arc<Archive> = archive.clone();
+                tokio::spawn(async move {
+                    // Read the request head (our requests never have a body)
+                    let mut head: Vec<u8> = vec![];
+                    let mut buf: [u8; 1024] = [0; 1024];
+                    while !head.windows(4).any(|w| w == b"\r\n\r\n") {
+                        let n: usize = conn.read(&mut buf).await.unwrap();
+                        if n == 0 {
+                            return;
+                        }
+                        head.extend_from_slice(&buf[..n]);
+                    }
+                    let head: String = String::from_utf8_lossy(&head).into_owned();
+                    let header = |name: &str| {
+                        head.lines().find_map(|line| line.split_once(':').filter(|(key, _)| key.eq_ignore_ascii_case(name)).map(|(_, v)| v.trim()))
+                    };
+
+                    // Only send a range if it is (as far as we can tell) still the same archive
+                    let (contents, etag): (Vec<u8>, String) = (archive.contents(), archive.etag());
+                    let fresh: bool = header("If-Range").map(|tag| archive.etag && tag == etag).unwrap_or(true);
+                    let range: Option<(usize, usize)> = header("Range").filter(|_| fresh).and_then(|range| {
+                        let (start, end): (&str, &str) = range.strip_prefix("bytes=")?.split_once('-')?;
+                        Some((start.parse().ok()?, if end.is_empty() { SIZE - 1 } else { end.parse::<usize>().ok()?.min(SIZE - 1) }))
+                    });
+                    let mut res: String = match range {
+                        Some((start, end)) => format!(
+                            "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes {start}-{end}/{SIZE}\r\nContent-Length: {}\r\n",
+                            end - start + 1
+                        ),
+                        None => format!("HTTP/1.1 200 OK\r\nContent-Length: {SIZE}\r\n"),
+                    };
+                    if archive.etag {
+                        res.push_str(&format!("ETag: {etag}\r\n"));
+                    }
+                    res.push_str("Connection: close\r\n\r\n");
+                    let (start, mut end): (usize, usize) = range.unwrap_or((0, SIZE - 1));
+                    let cut: usize = archive.cut.swap(0, Ordering::SeqCst);
+                    if cut > 0 {
+                        end = start + cut - 1;
+                        if archive.fickle {
+                            archive.version.fetch_add(1, Ordering::SeqCst);
+                        }
+                    }
+                    conn.write_all(res.as_bytes()).await.unwrap();
+                    conn.write_all(&contents[start..=end]).await.unwrap();
+                });
+            }
+        });
+        address
+    }
+
+    /// Downloads an entire archive with [`body_stream()`].
+    ///
+    /// # Arguments
+    /// - `archive`: The [`Archive`] to download.
+    ///
+    /// # Returns
+    /// The downloaded bytes, or the error that the stream ended with.
+    async fn download_stream(archive: Arc<Archive>) -> Result<Vec<u8>, DataError> {
+        let address: String = serve(archive).await;
+        let client: Client = Client::new();
+        let (res, start, total, etag): (Response, u64, Option<u64>, Option<String>) =
+            open_download(&client, &address, 0, None, &DownloadOptions::default()).await?;
+        assert_eq!((start, total), (0, None));
+
+        let mut stream = Box::pin(body_stream(&client, &address, res, start, None, etag.as_deref(), 3));
+        let mut body: Vec<u8> = vec![];
+        while let Some(chunk) = stream.next().await {
+            body.extend_from_slice(&chunk?);
+        }
+        Ok(body)
+    }
+
+
+
+    #[tokio::test]
+    async fn test_ranges_same_archive() {
+        let archive: Arc<Archive> = Arc::new(Archive { etag: true, ..Default::default() });
+        let address: String = serve(archive.clone()).await;
+        let client: Client = Client::new();
+        let opts: DownloadOptions = DownloadOptions { concurrency: 2, chunk_size: 16, ..Default::default() };
+
+        // The first range tells us the size and version of the archive
+        let (res, start, total, etag): (Response, u64, Option<u64>, Option<String>) = open_download(&client, &address, 0, None, &opts).await.unwrap();
+        assert_eq!((res.status(), start, total), (StatusCode::PARTIAL_CONTENT, 0, Some(SIZE as u64)));
+        let etag: String = etag.unwrap();
+        assert_eq!(res.bytes().await.unwrap(), archive.contents()[..16]);
+        assert_eq!(download_range(&client, &address, &etag, 16, 31).await.unwrap(), archive.contents()[16..32]);
+
+        // Once it changes, the other ranges do not fit anymore
+        archive.version.fetch_add(1, Ordering::SeqCst);
+        assert!(matches!(download_range(&client, &address, &etag, 32, 47).await, Err(DataError::ArchiveChangedError { .. })));
+        assert!(matches!(download_range_retrying(&client, &address, &etag, 32, 47, 3).await, Err(DataError::ArchiveChangedError { .. })));
+    }
+
+    #[tokio::test]
+    async fn test_ranges_without_etag() {
+        let archive: Arc<Archive> = Arc::new(Archive { etag: false, ..Default::default() });
+        let address: String = serve(archive.clone()).await;
+        let client: Client = Client::new();
+        let opts: DownloadOptions = DownloadOptions { concurrency: 2, chunk_size: 16, ..Default::default() };
+
+        // Without a validator, we cannot combine ranges, so we get the entire archive at once
+        let (res, start, total, etag): (Response, u64, Option<u64>, Option<String>) = open_download(&client, &address, 0, None, &opts).await.unwrap();
+        assert_eq!((res.status(), start, total, etag), (StatusCode::OK, 0, None, None));
+        assert_eq!(res.bytes().await.unwrap(), archive.contents());
+    }
+
+    #[tokio::test]
+    async fn test_resume_same_archive() {
+        // A broken download continues where it left off
+        let archive: Arc<Archive> = Arc::new(Archive { etag: true, cut: AtomicUsize::new(20), ..Default::default() });
+        assert_eq!(download_stream(archive.clone()).await.unwrap(), archive.contents());
+
+        // As does a later one, if the archive did not change in the meantime
+        let address: String = serve(archive.clone()).await;
+        let client: Client = Client::new();
+        let etag: String = archive.etag();
+        let (res, start, _, _): (Response, u64, Option<u64>, Option<String>) =
+            open_download(&client, &address, 20, Some(&etag), &DownloadOptions::default()).await.unwrap();
+        assert_eq!((res.status(), start), (StatusCode::PARTIAL_CONTENT, 20));
+        assert_eq!(res.bytes().await.unwrap(), archive.contents()[20..]);
+    }
+
+    #[tokio::test]
+    async fn test_resume_changed_archive() {
+        // A broken download cannot continue with another archive
+        let archive: Arc<Archive> = Arc::new(Archive { etag: true, cut: AtomicUsize::new(20), fickle: true, ..Default::default() });
+        assert!(matches!(download_stream(archive).await, Err(DataError::ArchiveChangedError { .. })));
+
+        // Nor with one it cannot identify
+        let archive: Arc<Archive> = Arc::new(Archive { etag: false, cut: AtomicUsize::new(20), ..Default::default() });
+        assert!(matches!(download_stream(archive).await, Err(DataError::DownloadStreamError { .. })));
+
+        // A later download starts over if the archive has changed in the meantime
+        let archive: Arc<Archive> = Arc::new(Archive { etag: true, ..Default::default() });
+        let address: String = serve(archive.clone()).await;
+        let client: Client = Client::new();
+        let etag: String = archive.etag();
+        archive.version.fetch_add(1, Ordering::SeqCst);
+        let (res, start, _, new_etag): (Response, u64, Option<u64>, Option<String>) =
+            open_download(&client, &address, 20, Some(&etag), &DownloadOptions::default()).await.unwrap();
+        assert_eq!((res.status(), start, new_etag), (StatusCode::OK, 0, Some(archive.etag())));
+        assert_eq!(res.bytes().await.unwrap(), archive.contents());
+    }
+}
+
+
+/***** HELPER FUNCTIONS *****/
+/// Parses the first byte and the total size of a resource from a `Content-Range` header (e.g., `bytes 0-1023/4096`).
+///
+/// # Arguments
+/// - `raw`: The value of the header.
 ///
-/// For now, this function uses a random selection since it assumes there will usually only be one location that advertises having it. However, this is super bad practise and will lead to undefined results if there are multiple.
+/// # Returns
+/// The first byte in the response and the total size of the resource, or [`None`] if the header was malformed or did not specify the size (i.e., `*`).
+fn parse_content_range(raw: &str) -> Option<(u64, u64)> {
+    let raw: &str = raw.trim().strip_prefix("bytes ")?;
+    let (range, total): (&str, &str) = raw.split_once('/')?;
+    let (start, _): (&str, &str) = range.split_once('-')?;
+    Some((start.trim().parse().ok()?, total.trim().parse().ok()?))
+}
+
+/// Reads the Content-Range header of a partial response.
 ///
 /// # Arguments
-/// - `api_endpoint`: The remote `brane-api` endpoint that we use to download the possible registries.
-/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
-/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
-/// - `data_dir`: The directory to download the dataset to.
-/// - `name`: The name of the dataset to download.
-/// - `access`: The locations where it is available.
+/// - `res`: The [`Response`] to read the header of.
+/// - `address`: The address that sent the response (used for debugging).
 ///
 /// # Returns
-/// The AccessKind with how to download the dataset if it was downloaded successfully, or `None` if it wasn't available.
+/// The first byte in the response and the total size of the resource.
 ///
 /// # Errors
-/// This function errors if we failed to download the dataset somehow.
-pub async fn download_data(
-    api_endpoint: impl AsRef<str>,
-    proxy_addr: &Option<String>,
-    certs_dir: impl AsRef<Path>,
-    data_dir: impl AsRef<Path>,
-    name: impl AsRef<str>,
-    access: &HashMap<String, AccessKind>,
-) -> Result<Option<AccessKind>, DataError> {
-    let api_endpoint: &str = api_endpoint.as_ref();
-    let certs_dir: &Path = certs_dir.as_ref();
-    let data_dir: &Path = data_dir.as_ref();
-    let name: &str = name.as_ref();
+/// This function errors if the header was missing or malformed.
+fn content_range(res: &Response, address: &str) -> Result<(u64, u64), DataError> {
+    let raw: Option<&str> = res.headers().get(CONTENT_RANGE).and_then(|raw| raw.to_str().ok());
+    match raw.and_then(parse_content_range) {
+        Some(range) => Ok(range),
+        None => Err(DataError::ContentRangeError { address: address.into(), raw: raw.map(String::from) }),
+    }
+}
 
+/// Reads the strong `ETag` of a response, if it has one.
+///
+/// Only a strong validator promises that the remote serves exactly the same bytes as long as it does not change, so weak ones (`W/"..."`) are ignored.
+///
+/// # Arguments
+/// - `res`: The [`Response`] to read the header of.
+///
+/// # Returns
+/// The raw value of the header, or [`None`] if it was missing, weak or not valid ASCII.
+fn strong_etag(res: &Response) -> Option<String> {
+    let raw: &str = res.headers().get(ETAG)?.to_str().ok()?;
+    if raw.starts_with("W/") { None } else { Some(raw.into()) }
+}
 
+/// Computes the SHA-256 hash of the given file.
+///
+/// # Arguments
+/// - `path`: The path of the file to hash.
+///
+/// # Returns
+/// The hash, as a hexadecimal string.
+///
+/// # Errors
+/// This function errors if we failed to read the file.
+async fn hash_file(path: &Path) -> Result<String, DataError> {
+    let mut handle: tfs::File = match tfs::File::open(path).await {
+        Ok(handle) => handle,
+        Err(err) => {
+            return Err(DataError::FileReadError { what: "downloaded archive", path: path.into(), err });
+        },
+    };
+    let mut hasher: Sha256 = Sha256::new();
+    let mut buf: Vec<u8> = vec![0; 64 * 1024];
+    loop {
+        let n: usize = match handle.read(&mut buf).await {
+            Ok(n) => n,
+            Err(err) => {
+                return Err(DataError::FileReadError { what: "downloaded archive", path: path.into(), err });
+            },
+        };
+        if n == 0 {
+            break;
+        }
+        hasher.update(&buf[..n]);
+    }
+    Ok(hex::encode(hasher.finalize()))
+}
 
-    /* Step 1: Get target registry address */
-    // Choose a random location to attempt to download the asset from.
-    if access.is_empty() {
-        return Ok(None);
+/// Removes the given (extracted) data directory if it exists.
+///
+/// # Arguments
+/// - `what`: What the directory is (used for debugging).
+/// - `path`: The path of the directory to remove.
+///
+/// # Errors
+/// This function errors if the path exists but is not a directory, or if we failed to remove it.
+async fn remove_data_dir(what: &'static str, path: &Path) -> Result<(), DataError> {
+    if path.exists() {
+        if !path.is_dir() {
+            return Err(DataError::DirNotADirError { what, path: path.into() });
+        }
+        if let Err(err) = tfs::remove_dir_all(path).await {
+            return Err(DataError::DirRemoveError { what, path: path.into(), err });
+        }
+    }
+    Ok(())
+}
+
+/// Reads the [`DownloadMarker`] in the given dataset directory.
+///
+/// # Arguments
+/// - `path`: The path of the marker file.
+///
+/// # Returns
+/// The marker, or an empty one if it did not exist or could not be read.
+fn read_marker(path: &Path) -> DownloadMarker {
+    match fs::read_to_string(path) {
+        Ok(raw) => serde_json::from_str(&raw).unwrap_or_else(|err| {
+            warn!("Failed to parse download marker '{}': {} (ignoring)", path.display(), err);
+            DownloadMarker::default()
+        }),
+        Err(_) => DownloadMarker::default(),
+    }
+}
+
+/// Writes the given [`DownloadMarker`] to the given dataset directory.
+///
+/// Failing to do so only means we cannot skip or resume the next download, so errors are only logged.
+///
+/// # Arguments
+/// - `path`: The path of the marker file.
+/// - `marker`: The marker to write.
+fn write_marker(path: &Path, marker: &DownloadMarker) {
+    let raw: String = serde_json::to_string(marker).unwrap();
+    if let Err(err) = fs::write(path, raw) {
+        warn!("Failed to write download marker '{}': {}", path.display(), err);
+    }
+}
+
+/// Downloads a single byte range of a remote file.
+///
+/// The range is only accepted if it belongs to the same version of the file as the rest of the download, as identified by its strong `ETag`.
+///
+/// # Arguments
+/// - `client`: The [`Client`] to download with.
+/// - `address`: The address of the file to download.
+/// - `etag`: The strong `ETag` of the version of the file that we are downloading.
+/// - `start`: The first byte to download.
+/// - `end`: The last byte to download (inclusive).
+///
+/// # Returns
+/// The downloaded bytes, which are guaranteed to be exactly as many as requested.
+///
+/// # Errors
+/// This function errors if the request failed, if the file has changed since we started downloading it, or if the remote did not send back exactly the requested range.
+async fn download_range(client: &Client, address: &str, etag: &str, start: u64, end: u64) -> Result<Bytes, DataError> {
+    let res: Response = match client.get(address).header(RANGE, format!("bytes={start}-{end}")).header(IF_RANGE, etag).send().await {
+        Ok(res) => res,
+        Err(err) => {
+            return Err(DataError::RequestError { what: "ranged download", address: address.into(), err });
+        },
+    };
+    // The remote answers with the entire (new) file if it does not match the ETag anymore
+    if res.status() == StatusCode::OK || (res.status() == StatusCode::PARTIAL_CONTENT && strong_etag(&res).as_deref() != Some(etag)) {
+        return Err(DataError::ArchiveChangedError { address: address.into() });
+    }
+    if res.status() != StatusCode::PARTIAL_CONTENT {
+        return Err(DataError::RequestFailure { address: address.into(), code: res.status(), message: res.text().await.ok() });
+    }
+    let chunk: Bytes = match res.bytes().await {
+        Ok(chunk) => chunk,
+        Err(err) => {
+            return Err(DataError::DownloadStreamError { address: address.into(), err });
+        },
+    };
+    if chunk.len() as u64 != end - start + 1 {
+        return Err(DataError::RangeLengthError { address: address.into(), start, end, got: chunk.len() });
     }
-    let mut rng = rand::thread_rng();
-    let location: &str = access.keys().choose(&mut rng).unwrap();
+    Ok(chunk)
+}
 
+/// Resolves the registry of the given location and builds a [`Client`] to download the given dataset from it.
+///
+/// # Arguments
+/// - `api_endpoint`: The remote `brane-api` endpoint that we use to resolve the location's registry.
+/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
+/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
+/// - `location`: The location to download the dataset from.
+/// - `name`: The name of the dataset to download.
+///
+/// # Returns
+/// The [`Client`] to download with, and the address of the dataset's archive.
+///
+/// # Errors
+/// This function errors if we failed to resolve the registry or to load the certificates for it.
+async fn connect(
+    api_endpoint: &str,
+    proxy_addr: &Option<String>,
+    certs_dir: &Path,
+    location: &str,
+    name: &str,
+) -> Result<(Client, String), DataError> {
+    /* Step 1: Get target registry address */
     // Send a GET-request to resolve that location to a delegate
     let registry_addr: String = format!("{api_endpoint}/infra/registries/{location}");
     let res: Response = match reqwest::get(&registry_addr).await {
@@ -148,32 +507,7 @@ pub async fn download_data(
 
 
 
-    /* Step 3: Prepare the filesystem */
-    debug!("Preparing filesystem...");
-
-    // Make sure the temporary tarfile directory exists
-    let tar_dir: TempDir = match TempDir::new() {
-        Ok(tar_dir) => tar_dir,
-        Err(err) => {
-            return Err(DataError::TempDirError { err });
-        },
-    };
-    let tar_path: PathBuf = tar_dir.path().join(format!("data_{name}.tar.gz"));
-
-    // Make sure the old data path doesn't exist anymore
-    let data_path: PathBuf = data_dir.join("data");
-    if data_path.exists() {
-        if !data_path.is_dir() {
-            return Err(DataError::DirNotADirError { what: "target data", path: data_path });
-        }
-        if let Err(err) = tfs::remove_dir_all(&data_path).await {
-            return Err(DataError::DirRemoveError { what: "target data", path: data_path, err });
-        }
-    }
-
-
-
-    /* Step 4: Build the client. */
+    /* Step 3: Build the client. */
     let download_addr: String = format!("{registry_addr}/data/download/{name}");
     debug!("Sending download request to '{}'...", download_addr);
     let mut client: ClientBuilder =
@@ -191,56 +525,656 @@ pub async fn download_data(
         },
     };
 
-    // Send a reqwest
-    let res = match client.get(&download_addr).send().await {
+    // Done
+    Ok((client, download_addr))
+}
+
+/// Sends the first request for the archive of a dataset.
+///
+/// If the given [`DownloadOptions`] allow it, then only the first range is requested to see if the remote supports ranged downloads.
+///
+/// # Arguments
+/// - `client`: The [`Client`] to download with.
+/// - `address`: The address of the archive to download.
+/// - `offset`: The number of bytes we already have from an earlier download. If non-zero, the rest is always requested as a single stream.
+/// - `validator`: The strong `ETag` of the archive that the bytes we already have were cut from. Only if the remote still serves the same archive, it resumes at `offset`; otherwise, it sends the entire archive.
+/// - `opts`: The [`DownloadOptions`] that determine how to download.
+///
+/// The remaining ranges are only downloaded in parallel if the remote identifies the archive with a strong `ETag`, so that every range can be checked to belong to the same archive. Otherwise, the archive is requested again as a single stream.
+///
+/// # Returns
+/// The response, the first byte in it, the total size of the archive if the remaining ranges should be downloaded in parallel, and the strong `ETag` of the archive (if the remote sent any).
+///
+/// # Errors
+/// This function errors if the request failed or if the remote did not resume at `offset` while claiming it did.
+async fn open_download(
+    client: &Client,
+    address: &str,
+    offset: u64,
+    validator: Option<&str>,
+    opts: &DownloadOptions,
+) -> Result<(Response, u64, Option<u64>, Option<String>), DataError> {
+    // Send a reqwest; if we're allowed to go parallel, then only ask for the first range to see if the remote supports it
+    let ranged: bool = opts.concurrency > 1 && opts.chunk_size > 0 && offset == 0;
+    let mut req = client.get(address);
+    if ranged {
+        req = req.header(RANGE, format!("bytes=0-{}", opts.chunk_size - 1));
+    } else if let Some(validator) = validator.filter(|_| offset > 0) {
+        debug!("Attempting to resume download of '{}' after {} bytes", address, offset);
+        req = req.header(RANGE, format!("bytes={offset}-")).header(IF_RANGE, validator);
+    }
+    let res = match req.send().await {
         Ok(res) => res,
         Err(err) => {
-            return Err(DataError::RequestError { what: "download", address: download_addr, err });
+            return Err(DataError::RequestError { what: "download", address: address.into(), err });
         },
     };
     if !res.status().is_success() {
-        return Err(DataError::RequestFailure { address: download_addr, code: res.status(), message: res.text().await.ok() });
+        return Err(DataError::RequestFailure { address: address.into(), code: res.status(), message: res.text().await.ok() });
+    }
+
+    // If the remote honoured the range, find out how large the entire file is (and whether it resumes where we asked)
+    if res.status() == StatusCode::PARTIAL_CONTENT {
+        let (start, total): (u64, u64) = content_range(&res, address)?;
+        if start != offset {
+            return Err(DataError::ContentRangeError {
+                address: address.into(),
+                raw:     res.headers().get(CONTENT_RANGE).and_then(|raw| raw.to_str().ok()).map(String::from),
+            });
+        }
+        let etag: Option<String> = strong_etag(&res);
+        if offset > 0 && etag.as_deref() != validator {
+            // The remote ignored the If-Range
+            return Err(DataError::ArchiveChangedError { address: address.into() });
+        }
+        if ranged && etag.is_none() {
+            // We cannot tell if the other ranges are cut from the same archive, so get all of it at once instead
+            debug!("Remote does not identify the archive with a strong ETag; falling back to a single stream");
+            let res: Response = match client.get(address).send().await {
+                Ok(res) => res,
+                Err(err) => {
+                    return Err(DataError::RequestError { what: "download", address: address.into(), err });
+                },
+            };
+            if !res.status().is_success() {
+                return Err(DataError::RequestFailure { address: address.into(), code: res.status(), message: res.text().await.ok() });
+            }
+            return Ok((res, 0, None, None));
+        }
+        Ok((res, start, if ranged { Some(total) } else { None }, etag))
+    } else {
+        if ranged {
+            debug!("Remote does not support ranged downloads; falling back to a single stream");
+        } else if offset > 0 {
+            debug!("Remote does not support resuming downloads or the archive has changed; starting over");
+        }
+        let etag: Option<String> = strong_etag(&res);
+        Ok((res, 0, None, etag))
+    }
+}
+
+/// Turns the body of a download into a stream of chunks, resuming it where it left off if the connection breaks.
+///
+/// Resuming is only possible if the remote identified the archive with a strong `ETag`, so that we can be sure the rest is cut from the same archive.
+///
+/// # Arguments
+/// - `client`: The [`Client`] to resume with.
+/// - `address`: The address of the archive that is downloaded.
+/// - `res`: The [`Response`] carrying the body.
+/// - `start`: The first byte in the body.
+/// - `end`: The last byte (inclusive) that `res` was asked for, or [`None`] if it was asked for everything.
+/// - `etag`: The strong `ETag` of the archive, if the remote sent any.
+/// - `retries`: The number of times to resume before giving up.
+///
+/// # Returns
+/// A stream that yields the body's chunks in order. It fails with a [`DataError::ArchiveChangedError`] if the archive changed before we could resume.
+fn body_stream<'a>(
+    client: &'a Client,
+    address: &'a str,
+    res: Response,
+    start: u64,
+    end: Option<u64>,
+    etag: Option<&'a str>,
+    retries: usize,
+) -> impl 'a + Stream<Item = Result<Bytes, DataError>> {
+    futures::stream::unfold((Some(res.bytes_stream()), start, 0), move |(stream, mut written, mut resumes)| async move {
+        let mut stream = stream?;
+        loop {
+            let err: reqwest::Error = match stream.next().await {
+                Some(Ok(chunk)) => {
+                    written += chunk.len() as u64;
+                    return Some((Ok(chunk), (Some(stream), written, resumes)));
+                },
+                Some(Err(err)) => err,
+                None => return None,
+            };
+
+            // The stream broke; see if we can continue where we left off
+            let etag: &str = match etag {
+                Some(etag) if resumes < retries => etag,
+                _ => return Some((Err(DataError::DownloadStreamError { address: address.into(), err }), (None, written, resumes))),
+            };
+            resumes += 1;
+            warn!("Download of '{}' interrupted after {} bytes: {} (resuming, attempt {}/{})", address, written, err, resumes, retries);
+            let range: String = match end {
+                Some(end) => format!("bytes={written}-{end}"),
+                None => format!("bytes={written}-"),
+            };
+            let res: Response = match client.get(address).header(RANGE, range).header(IF_RANGE, etag).send().await {
+                Ok(res) => res,
+                Err(err) => {
+                    return Some((Err(DataError::RequestError { what: "resumed download", address: address.into(), err }), (None, written, resumes)));
+                },
+            };
+            if res.status() == StatusCode::OK || (res.status() == StatusCode::PARTIAL_CONTENT && strong_etag(&res).as_deref() != Some(etag)) {
+                return Some((Err(DataError::ArchiveChangedError { address: address.into() }), (None, written, resumes)));
+            }
+            if res.status() != StatusCode::PARTIAL_CONTENT || !matches!(content_range(&res, address), Ok((start, _)) if start == written) {
+                debug!("Remote cannot resume the download (replied with {})", res.status());
+                return Some((Err(DataError::DownloadStreamError { address: address.into(), err }), (None, written, resumes)));
+            }
+            stream = res.bytes_stream();
+        }
+    })
+}
+
+/// Downloads the given range of a file, retrying it if that fails.
+///
+/// # Arguments
+/// - `client`: The [`Client`] to download with.
+/// - `address`: The address of the file to download.
+/// - `etag`: The strong `ETag` of the version of the file that we are downloading.
+/// - `start`: The first byte to download.
+/// - `end`: The last byte to download (inclusive).
+/// - `retries`: The number of times to retry before giving up.
+///
+/// # Returns
+/// The first byte and the downloaded bytes, which are guaranteed to be exactly as many as requested.
+///
+/// # Errors
+/// This function errors if the last attempt failed, or immediately if the file has changed (see [`download_range()`]).
+async fn download_range_retrying(
+    client: &Client,
+    address: &str,
+    etag: &str,
+    start: u64,
+    end: u64,
+    retries: usize,
+) -> Result<(u64, Bytes), DataError> {
+    let mut tries: usize = 0;
+    loop {
+        match download_range(client, address, etag, start, end).await {
+            Ok(chunk) => return Ok((start, chunk)),
+            Err(err) if tries < retries && !matches!(err, DataError::ArchiveChangedError { .. }) => {
+                tries += 1;
+                warn!("Failed to download range {}-{} of '{}': {} (retrying, attempt {}/{})", start, end, address, err, tries, retries);
+            },
+            Err(err) => return Err(err),
+        }
     }
+}
 
+/// Computes the byte ranges that remain after the first one.
+///
+/// # Arguments
+/// - `total`: The total size of the file.
+/// - `chunk_size`: The size of every range.
+///
+/// # Returns
+/// A list of `(start, end)` pairs, where `end` is inclusive.
+fn remaining_ranges(total: u64, chunk_size: u64) -> Vec<(u64, u64)> {
+    (chunk_size..total).step_by(chunk_size as usize).map(|start| (start, (start + chunk_size).min(total) - 1)).collect()
+}
 
+/// Downloads the archive of the given dataset from a single location.
+///
+/// # Arguments
+/// - `api_endpoint`: The remote `brane-api` endpoint that we use to resolve the location's registry.
+/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
+/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
+/// - `location`: The location to download the dataset from.
+/// - `name`: The name of the dataset to download.
+/// - `tar_path`: The path of the file to download the archive to. Will be overwritten if it exists, unless `resume` is given.
+/// - `resume`: If given, then `tar_path` contains the start of the archive with this strong `ETag` from an earlier download from the same location, and we only download the rest (if the remote supports it and still serves the same archive).
+/// - `resumable`: Called with the strong `ETag` of the archive as soon as we know a later call may resume this download. Never called if the remote does not send one, or if the archive is downloaded as parallel ranges.
+/// - `opts`: The [`DownloadOptions`] that determine how to download.
+///
+/// # Errors
+/// This function errors if we failed to download the archive somehow.
+#[allow(clippy::too_many_arguments)]
+async fn download_archive(
+    api_endpoint: &str,
+    proxy_addr: &Option<String>,
+    certs_dir: &Path,
+    location: &str,
+    name: &str,
+    tar_path: &Path,
+    resume: Option<&str>,
+    resumable: impl FnOnce(&str),
+    opts: &DownloadOptions,
+) -> Result<(), DataError> {
+    let (client, download_addr): (Client, String) = connect(api_endpoint, proxy_addr, certs_dir, location, name).await?;
+
+    // See how much we already have, if anything, and send the first request
+    let offset: u64 = if resume.is_some() { tfs::metadata(tar_path).await.map(|md| md.len()).unwrap_or(0) } else { 0 };
+    let (res, start, total, etag): (Response, u64, Option<u64>, Option<String>) =
+        open_download(&client, &download_addr, offset, resume, opts).await?;
+    if let (Some(etag), None) = (&etag, total) {
+        resumable(etag);
+    }
 
-    /* Step 5: Download the raw file in parts */
+
+
+    /* Step 4: Download the raw file in parts */
     debug!("Downloading file to '{}'...", tar_path.display());
-    {
-        let mut handle: tfs::File = match tfs::File::create(&tar_path).await {
+    let mut handle: tfs::File = if start > 0 {
+        match tfs::OpenOptions::new().append(true).open(&tar_path).await {
             Ok(handle) => handle,
             Err(err) => {
-                return Err(DataError::TarCreateError { path: tar_path, err });
+                return Err(DataError::TarCreateError { path: tar_path.into(), err });
             },
-        };
-        let mut stream = res.bytes_stream();
-        while let Some(chunk) = stream.next().await {
-            // Unwrap the chunk
-            let mut chunk: Bytes = match chunk {
-                Ok(chunk) => chunk,
-                Err(err) => {
-                    return Err(DataError::DownloadStreamError { address: download_addr, err });
-                },
-            };
+        }
+    } else {
+        match tfs::File::create(&tar_path).await {
+            Ok(handle) => handle,
+            Err(err) => {
+                return Err(DataError::TarCreateError { path: tar_path.into(), err });
+            },
+        }
+    };
+    let end: Option<u64> = total.map(|_| opts.chunk_size - 1);
+    let mut stream = Box::pin(body_stream(&client, &download_addr, res, start, end, etag.as_deref(), opts.retries));
+    while let Some(chunk) = stream.next().await {
+        let mut chunk: Bytes = chunk?;
+        if let Err(err) = handle.write_all_buf(&mut chunk).await {
+            return Err(DataError::TarWriteError { path: tar_path.into(), err });
+        }
+    }
 
-            // Write it to the file
+    // Download the remaining ranges in parallel, if any
+    if let Some(total) = total {
+        let ranges: Vec<(u64, u64)> = remaining_ranges(total, opts.chunk_size);
+        debug!("Downloading {} remaining ranges of {} bytes with concurrency {}...", ranges.len(), opts.chunk_size, opts.concurrency);
+        if let Err(err) = handle.set_len(total).await {
+            return Err(DataError::TarWriteError { path: tar_path.into(), err });
+        }
+
+        // Fetch them as they come, and write them where they belong
+        let client: &Client = &client;
+        let download_addr: &str = &download_addr;
+        let etag: &str = etag.as_deref().unwrap_or_default();
+        let mut chunks = futures::StreamExt::buffer_unordered(
+            futures::stream::iter(ranges).map(|(start, end)| download_range_retrying(client, download_addr, etag, start, end, opts.retries)),
+            opts.concurrency,
+        );
+        while let Some(chunk) = chunks.next().await {
+            let (start, mut chunk): (u64, Bytes) = chunk?;
+            if let Err(err) = handle.seek(SeekFrom::Start(start)).await {
+                return Err(DataError::TarWriteError { path: tar_path.into(), err });
+            }
             if let Err(err) = handle.write_all_buf(&mut chunk).await {
-                return Err(DataError::TarWriteError { path: tar_path, err });
+                return Err(DataError::TarWriteError { path: tar_path.into(), err });
             }
         }
     }
+    if let Err(err) = handle.flush().await {
+        return Err(DataError::TarWriteError { path: tar_path.into(), err });
+    }
 
+    // Done
+    Ok(())
+}
 
-
-    /* Step 6: Extract the tar. */
-    debug!("Unpacking '{}' to '{}'...", tar_path.display(), data_path.display());
-    if let Err(err) = brane_shr::fs::unarchive_async(tar_path, &data_path).await {
+/// Downloads the archive of the given dataset from a single location and extracts it while it is being downloaded.
+///
+/// Nothing but the extracted files are written to disk. If the remaining ranges are downloaded in parallel, they are still extracted in order, so at most `opts.concurrency` ranges are kept in memory.
+///
+/// # Arguments
+/// - `api_endpoint`: The remote `brane-api` endpoint that we use to resolve the location's registry.
+/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
+/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
+/// - `location`: The location to download the dataset from.
+/// - `name`: The name of the dataset to download.
+/// - `target`: The directory to extract the archive to. Must not exist yet.
+/// - `opts`: The [`DownloadOptions`] that determine how to download.
+///
+/// # Returns
+/// The SHA-256 hash of the downloaded archive, as a hexadecimal string.
+///
+/// # Errors
+/// This function errors if we failed to download or extract the archive somehow.
+async fn download_extract(
+    api_endpoint: &str,
+    proxy_addr: &Option<String>,
+    certs_dir: &Path,
+    location: &str,
+    name: &str,
+    target: &Path,
+    opts: &DownloadOptions,
+) -> Result<String, DataError> {
+    let (client, download_addr): (Client, String) = connect(api_endpoint, proxy_addr, certs_dir, location, name).await?;
+    let (res, start, total, etag): (Response, u64, Option<u64>, Option<String>) = open_download(&client, &download_addr, 0, None, opts).await?;
+
+    // Chain the first response with the remaining ranges (if any), in order
+    let end: Option<u64> = total.map(|_| opts.chunk_size - 1);
+    let first = body_stream(&client, &download_addr, res, start, end, etag.as_deref(), opts.retries);
+    let ranges: Vec<(u64, u64)> = total.map(|total| remaining_ranges(total, opts.chunk_size)).unwrap_or_default();
+    let etag: &str = etag.as_deref().unwrap_or_default();
+    let rest = futures::StreamExt::buffered(
+        futures::stream::iter(ranges).map(|(start, end)| download_range_retrying(&client, &download_addr, etag, start, end, opts.retries)),
+        opts.concurrency,
+    )
+    .map(|chunk| chunk.map(|(_, chunk)| chunk));
+
+    // Hash the chunks as they pass by, and feed them to the extractor
+    let mut hasher: Sha256 = Sha256::new();
+    let body = first.chain(rest).map(|chunk| match chunk {
+        Ok(chunk) => {
+            hasher.update(&chunk);
+            Ok(chunk)
+        },
+        Err(err) => Err(std::io::Error::new(std::io::ErrorKind::Other, err.to_string())),
+    });
+    let mut reader = StreamReader::new(Box::pin(body));
+    debug!("Downloading and unpacking '{}' to '{}'...", download_addr, target.display());
+    if let Err(err) = brane_shr::fs::unarchive_reader_async(&mut reader, &download_addr, target).await {
         return Err(DataError::TarExtractError { err });
     }
+    // Consume anything after the end of the archive, so the hash covers the entire download
+    if let Err(err) = tokio::io::copy(&mut reader, &mut tokio::io::sink()).await {
+        warn!("Failed to download the remainder of '{}' after its archive ended: {}", download_addr, err);
+    }
+    drop(reader);
+
+    // Done
+    Ok(hex::encode(hasher.finalize()))
+}
+
+
+
+
+
+/***** LIBRARY *****/
+/// Defines options that tune how [`download_data_with()`] transfers a dataset.
+#[derive(Clone, Copy, Debug)]
+pub struct DownloadOptions {
+    /// The maximum number of byte ranges that are downloaded concurrently. If `1`, the dataset is always downloaded as a single stream.
+    pub concurrency: usize,
+    /// The size (in bytes) of every byte range.
+    pub chunk_size:  u64,
+    /// The number of times an interrupted transfer is resumed (or a failed range is retried) before giving up on a location.
+    pub retries:     usize,
+    /// If true, the archive is extracted while it is being downloaded instead of being stored on disk first. Such downloads cannot be resumed by a later call.
+    pub stream_extract: bool,
+}
+impl Default for DownloadOptions {
+    #[inline]
+    fn default() -> Self { Self { concurrency: 1, chunk_size: 8 * 1024 * 1024, retries: 3, stream_extract: false } }
+}
+
+/// Remembers what has been downloaded into a dataset directory, so that later downloads may be skipped or resumed.
+///
+/// It is stored as `.download.json` next to the dataset's `data` directory.
+#[derive(Clone, Debug, Default, Deserialize, Serialize)]
+struct DownloadMarker {
+    /// Identifies the version of the dataset that is currently extracted in the directory, if any.
+    fingerprint: Option<String>,
+    /// The SHA-256 hash of the archive that was extracted, if any.
+    sha256:      Option<String>,
+    /// The fingerprint of the dataset, the location it was being downloaded from and the strong `ETag` of the archive if a previous download was interrupted.
+    partial:     Option<(String, String, String)>,
+}
+
+
+
+/// Attempts to download the given dataset from the instance.
+///
+/// This is equivalent to calling [`download_data_with()`] using the default [`DownloadOptions`].
+///
+/// # Arguments
+/// - `api_endpoint`: The remote `brane-api` endpoint that we use to download the possible registries.
+/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
+/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
+/// - `data_dir`: The directory to download the dataset to.
+/// - `name`: The name of the dataset to download.
+/// - `access`: The locations where it is available.
+///
+/// # Returns
+/// The AccessKind with how to download the dataset if it was downloaded successfully, or `None` if it wasn't available.
+///
+/// # Errors
+/// This function errors if we failed to download the dataset somehow.
+#[inline]
+pub async fn download_data(
+    api_endpoint: impl AsRef<str>,
+    proxy_addr: &Option<String>,
+    certs_dir: impl AsRef<Path>,
+    data_dir: impl AsRef<Path>,
+    name: impl AsRef<str>,
+    access: &HashMap<String, AccessKind>,
+) -> Result<Option<AccessKind>, DataError> {
+    download_data_with(api_endpoint, proxy_addr, certs_dir, data_dir, name, access, &DownloadOptions::default()).await
+}
+
+/// Attempts to download the given dataset from the instance.
+///
+/// The locations that advertise the dataset are tried in random order; if downloading from one fails, the next one is tried. Because every registry builds its own archive of the dataset, ranges are never combined across locations.
+///
+/// If the given [`DownloadOptions`] allow it and the registry supports ranged requests, the dataset is downloaded as multiple byte ranges in parallel. Otherwise, it is downloaded as a single stream. Ranges are only combined if the registry identifies its archive with a strong `ETag` and every range matches it; if the archive changes halfway, the download from that location starts over once as a single stream.
+///
+/// # Arguments
+/// - `api_endpoint`: The remote `brane-api` endpoint that we use to download the possible registries.
+/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
+/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
+/// - `data_dir`: The directory to download the dataset to.
+/// - `name`: The name of the dataset to download.
+/// - `access`: The locations where it is available.
+/// - `opts`: The [`DownloadOptions`] that determine how to download.
+///
+/// # Returns
+/// The AccessKind with how to download the dataset if it was downloaded successfully, or `None` if it wasn't available.
+///
+/// # Errors
+/// This function errors if we failed to download the dataset from any of the locations.
+pub async fn download_data_with(
+    api_endpoint: impl AsRef<str>,
+    proxy_addr: &Option<String>,
+    certs_dir: impl AsRef<Path>,
+    data_dir: impl AsRef<Path>,
+    name: impl AsRef<str>,
+    access: &HashMap<String, AccessKind>,
+    opts: &DownloadOptions,
+) -> Result<Option<AccessKind>, DataError> {
+    download_dataset(api_endpoint.as_ref(), proxy_addr, certs_dir.as_ref(), data_dir.as_ref(), name.as_ref(), access, None, opts).await
+}
+
+/// Attempts to download the given dataset from the instance, unless the same version is already present in the given directory.
+///
+/// Which version of the dataset is in `data_dir` is remembered by its creation time as advertised in the given [`DataInfo`]. If that hasn't changed since the last download, then no transfer happens at all. Otherwise, the dataset is downloaded as with [`download_data_with()`], except that:
+/// - a download that was interrupted in an earlier call is resumed where it left off (if the same location is still tried first, supports it and still serves the same archive, as identified by its strong `ETag`); and
+/// - the archive is only extracted if its contents differ from what was extracted before.
+///
+/// # Arguments
+/// - `api_endpoint`: The remote `brane-api` endpoint that we use to download the possible registries.
+/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
+/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
+/// - `data_dir`: The directory to download the dataset to.
+/// - `info`: The [`DataInfo`] of the dataset to download, as found in the remote index.
+/// - `opts`: The [`DownloadOptions`] that determine how to download.
+///
+/// # Returns
+/// The AccessKind with how to download the dataset if it was downloaded successfully (or already present), or `None` if it wasn't available.
+///
+/// # Errors
+/// This function errors if we failed to download the dataset from any of the locations.
+pub async fn download_data_cached(
+    api_endpoint: impl AsRef<str>,
+    proxy_addr: &Option<String>,
+    certs_dir: impl AsRef<Path>,
+    data_dir: impl AsRef<Path>,
+    info: &DataInfo,
+    opts: &DownloadOptions,
+) -> Result<Option<AccessKind>, DataError> {
+    let fingerprint: String = format!("{}@{}", info.name, info.created.to_rfc3339());
+    let (api_endpoint, certs_dir, data_dir): (&str, &Path, &Path) = (api_endpoint.as_ref(), certs_dir.as_ref(), data_dir.as_ref());
+    download_dataset(api_endpoint, proxy_addr, certs_dir, data_dir, &info.name, &info.access, Some(fingerprint), opts).await
+}
+
+/// Implements both [`download_data_with()`] and [`download_data_cached()`].
+///
+/// # Arguments
+/// - `api_endpoint`: The remote `brane-api` endpoint that we use to download the possible registries.
+/// - `proxy_addr`: If given, the any data transfers will be proxied through this address.
+/// - `certs_dir`: The directory where certificates are stored. Expected to contain nested directories that store the certs by domain ID.
+/// - `data_dir`: The directory to download the dataset to.
+/// - `name`: The name of the dataset to download.
+/// - `access`: The locations where it is available.
+/// - `fingerprint`: If given, identifies the version of the dataset to download, and enables skipping and resuming downloads.
+/// - `opts`: The [`DownloadOptions`] that determine how to download.
+///
+/// # Returns
+/// The AccessKind with how to download the dataset if it was downloaded successfully, or `None` if it wasn't available.
+///
+/// # Errors
+/// This function errors if we failed to download the dataset from any of the locations.
+#[allow(clippy::too_many_arguments)]
+async fn download_dataset(
+    api_endpoint: &str,
+    proxy_addr: &Option<String>,
+    certs_dir: &Path,
+    data_dir: &Path,
+    name: &str,
+    access: &HashMap<String, AccessKind>,
+    fingerprint: Option<String>,
+    opts: &DownloadOptions,
+) -> Result<Option<AccessKind>, DataError> {
+    /* Step 1: Decide on the order of locations */
+    if access.is_empty() {
+        return Ok(None);
+    }
+    let data_path: PathBuf = data_dir.join("data");
+    let marker_path: PathBuf = data_dir.join(".download.json");
+    let mut marker: DownloadMarker = if fingerprint.is_some() { read_marker(&marker_path) } else { DownloadMarker::default() };
+    if fingerprint.is_some() && marker.fingerprint == fingerprint && data_path.is_dir() {
+        debug!("Dataset '{}' is already present and unchanged in '{}'; skipping download", name, data_dir.display());
+        return Ok(Some(AccessKind::File { path: data_path }));
+    }
+    let resume_from: Option<(String, String)> = match (&fingerprint, &marker.partial) {
+        (Some(fingerprint), Some((partial, location, etag))) if !opts.stream_extract && partial == fingerprint && access.contains_key(location) => {
+            Some((location.clone(), etag.clone()))
+        },
+        _ => None,
+    };
+    let locations: Vec<&str> = {
+        let mut locations: Vec<&str> = access.keys().map(String::as_str).collect();
+        locations.shuffle(&mut rand::thread_rng());
+        // Try the location we were downloading from first, so we may continue where we left off
+        if let Some((resume_from, _)) = &resume_from {
+            locations.retain(|location| location != resume_from);
+            locations.insert(0, resume_from.as_str());
+        }
+        locations
+    };
+
+
+
+    /* Step 2: Prepare the filesystem */
+    debug!("Preparing filesystem...");
+
+    // Download the archive next to the dataset itself, so that it survives if we are interrupted
+    if let Err(err) = tfs::create_dir_all(data_dir).await {
+        return Err(DataError::DirCreateError { what: "dataset", path: data_dir.into(), err });
+    }
+    let tar_path: PathBuf = data_dir.join(".data.tar.gz.part");
+    // If extracting while downloading, we extract next to the old data and only swap them once it's complete
+    let staging_path: PathBuf = data_dir.join(".data.part");
+
+
+
+    /* Step 3: Download the archive from the first location that works */
+    let mut sha256: Option<String> = None;
+    // If the archive changes while we download it in parts, we start over once as a single stream
+    let single: DownloadOptions = DownloadOptions { concurrency: 1, ..*opts };
+    for (i, location) in locations.iter().enumerate() {
+        let mut res: Result<Option<String>, DataError> = Ok(None);
+        for (attempt, opts) in [opts, &single].into_iter().enumerate() {
+            res = if opts.stream_extract {
+                // Whatever an earlier attempt extracted is useless, as we cannot resume an extraction
+                remove_data_dir("staged data", &staging_path).await?;
+                download_extract(api_endpoint, proxy_addr, certs_dir, location, name, &staging_path, opts).await.map(Some)
+            } else {
+                // Remember where we're downloading from (and what), so a later call may resume it
+                let resume: Option<&str> = resume_from.as_ref().filter(|_| i == 0 && attempt == 0).map(|(_, etag)| etag.as_str());
+                if fingerprint.is_some() && resume.is_none() && marker.partial.is_some() {
+                    // Whatever we had is about to be overwritten
+                    marker.partial = None;
+                    write_marker(&marker_path, &marker);
+                }
+                let resumable = |etag: &str| {
+                    if let Some(fingerprint) = &fingerprint {
+                        marker.partial = Some((fingerprint.clone(), (*location).into(), etag.into()));
+                        write_marker(&marker_path, &marker);
+                    }
+                };
+                download_archive(api_endpoint, proxy_addr, certs_dir, location, name, &tar_path, resume, resumable, opts).await.map(|_| None)
+            };
+            match &res {
+                Err(err @ DataError::ArchiveChangedError { .. }) if attempt == 0 => {
+                    warn!("{} (downloading dataset '{}' from location '{}' again)", err, name, location);
+                },
+                _ => break,
+            }
+        }
+        match res {
+            Ok(hash) => {
+                sha256 = hash;
+                break;
+            },
+            Err(err) if i + 1 < locations.len() => {
+                warn!("Failed to download dataset '{}' from location '{}': {} (trying next location)", name, location, err);
+            },
+            Err(err) => return Err(err),
+        }
+    }
+    marker.partial = None;
+
+
+
+    /* Step 4: Extract the tar (if it's not the one we already have). */
+    if opts.stream_extract {
+        // Already extracted; swap it with the old data
+        remove_data_dir("target data", &data_path).await?;
+        if let Err(err) = tfs::rename(&staging_path, &data_path).await {
+            return Err(DataError::DirMoveError { what: "staged data", source: staging_path, target: data_path, err });
+        }
+    } else {
+        if fingerprint.is_some() {
+            sha256 = Some(hash_file(&tar_path).await?);
+        }
+        if sha256.is_some() && marker.sha256 == sha256 && data_path.is_dir() {
+            debug!("Downloaded archive is identical to the one extracted in '{}'; skipping extraction", data_path.display());
+        } else {
+            // Make sure the old data path doesn't exist anymore
+            remove_data_dir("target data", &data_path).await?;
+
+            debug!("Unpacking '{}' to '{}'...", tar_path.display(), data_path.display());
+            if let Err(err) = brane_shr::fs::unarchive_async(&tar_path, &data_path).await {
+                return Err(DataError::TarExtractError { err });
+            }
+        }
+        if let Err(err) = tfs::remove_file(&tar_path).await {
+            warn!("Failed to remove downloaded archive '{}': {}", tar_path.display(), err);
+        }
+    }
+    if fingerprint.is_some() {
+        marker.fingerprint = fingerprint;
+        marker.sha256 = sha256;
+        write_marker(&marker_path, &marker);
+    }
 
 
 
-    /* Step 7: In the case of brane-cli, also write a DataInfo. */
+    /* Step 5: In the case of brane-cli, also write a DataInfo. */
     let access: AccessKind = AccessKind::File { path: data_path };
     {
         let info_path: PathBuf = data_dir.join("data.yml");
@@ -264,7 +1198,7 @@ pub async fn download_data(
 
 
 
-    /* Step 7: Done */
+    /* Step 6: Done */
     Ok(Some(access))
 }
 
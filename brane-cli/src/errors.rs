@@ -4,7 +4,7 @@
 //  Created:
 //    17 Feb 2022, 10:27:28
 //  Last edited:
-//    07 Mar 2024, 14:16:08
+//    14 Oct 2026, 20:30:47
 //  Auto updated?
 //    Yes
 //
@@ -704,6 +704,8 @@ pub enum DataError {
     DirRemoveError { what: &'static str, path: PathBuf, err: std::io::Error },
     /// A directory could not be created.
     DirCreateError { what: &'static str, path: PathBuf, err: std::io::Error },
+    /// A directory could not be moved.
+    DirMoveError { what: &'static str, source: PathBuf, target: PathBuf, err: std::io::Error },
     // /// The given certificate file was empty.
     // EmptyCertFile{ path: PathBuf },
     // /// Failed to parse the given key/cert pair as an IdentityFile.
@@ -720,6 +722,12 @@ pub enum DataError {
     ClientCreateError { err: reqwest::Error },
     /// Failed to reach the next chunk of data.
     DownloadStreamError { address: String, err: reqwest::Error },
+    /// The remote sent partial content without a (valid) Content-Range header.
+    ContentRangeError { address: String, raw: Option<String> },
+    /// The remote sent a different number of bytes than the range we asked for.
+    RangeLengthError { address: String, start: u64, end: u64, got: usize },
+    /// The remote file changed while we were downloading it in parts.
+    ArchiveChangedError { address: String },
     /// Failed to create the file to which we write the download stream.
     TarCreateError { path: PathBuf, err: std::io::Error },
     // /// Failed to (re-)open the file to which we've written the download stream.
@@ -803,6 +811,9 @@ impl Display for DataError {
             DirNotADirError { what, path } => write!(f, "{} directory '{}' is not a directory", what, path.display()),
             DirRemoveError { what, path, .. } => write!(f, "Failed to remove {} directory '{}'", what, path.display()),
             DirCreateError { what, path, .. } => write!(f, "Failed to create {} directory '{}'", what, path.display()),
+            DirMoveError { what, source, target, .. } => {
+                write!(f, "Failed to move {} directory '{}' to '{}'", what, source.display(), target.display())
+            },
             // EmptyCertFile{ path }                            => write!(f, "No certificates found in certificate file '{}'", path.display()),
             // IdentityFileError{ certfile, keyfile, .. }      => write!(f, "Failed to parse '{}' and '{}' as a single Identity", certfile.display(), keyfile.display()),
             // RootError{ cafile, .. }                         => write!(f, "Failed to parse '{}' as a root certificate", cafile.display()),
@@ -811,6 +822,16 @@ impl Display for DataError {
             ProxyCreateError { address, .. } => write!(f, "Failed to create new proxy to '{address}'"),
             ClientCreateError { .. } => write!(f, "Failed to create new client"),
             DownloadStreamError { address, .. } => write!(f, "Failed to get next chunk in download stream from '{address}'"),
+            ContentRangeError { address, raw } => write!(
+                f,
+                "Remote '{}' sent partial content with {}",
+                address,
+                if let Some(raw) = raw { format!("invalid Content-Range header '{raw}'") } else { "no Content-Range header".into() }
+            ),
+            RangeLengthError { address, start, end, got } => {
+                write!(f, "Remote '{address}' sent {got} bytes for range {start}-{end} (expected {} bytes)", end - start + 1)
+            },
+            ArchiveChangedError { address } => write!(f, "Remote '{address}' changed the archive while it was being downloaded"),
             TarCreateError { path, .. } => write!(f, "Failed to create tarball file '{}'", path.display()),
             // TarOpenError{ path, .. }                => write!(f, "Failed to re-open tarball file '{}'", path.display()),
             TarWriteError { path, .. } => write!(f, "Failed to write to tarball file '{}'", path.display()),
@@ -870,6 +891,7 @@ impl Error for DataError {
             DirNotADirError { .. } => None,
             DirRemoveError { err, .. } => Some(err),
             DirCreateError { err, .. } => Some(err),
+            DirMoveError { err, .. } => Some(err),
             // EmptyCertFile{ .. } => None,
             // IdentityFileError{ err, .. } => Some(err),
             // RootError{ err, .. } => Some(err),
@@ -878,6 +900,9 @@ impl Error for DataError {
             ProxyCreateError { err, .. } => Some(err),
             ClientCreateError { .. } => None,
             DownloadStreamError { err, .. } => Some(err),
+            ContentRangeError { .. } => None,
+            RangeLengthError { .. } => None,
+            ArchiveChangedError { .. } => None,
             TarCreateError { err, .. } => Some(err),
             // TarOpenError{ err, .. } => Some(err),
             TarWriteError { err, .. } => Some(err),
@@ -1394,10 +1419,14 @@ pub enum RunError {
     CompileError { what: String, errs: Vec<brane_ast::Error> },
     /// Failed to serialize the compiled workflow.
     WorkflowSerializeError { err: serde_json::Error },
+    /// Failed to serialize the compiled workflow as MessagePack.
+    WorkflowEncodeError { err: rmp_serde::encode::Error },
     /// Requesting a command failed
     CommandRequestError { address: String, err: tonic::Status },
     /// Failed to parse the value returned by the remote driver.
     ValueParseError { address: String, raw: String, err: serde_json::Error },
+    /// Failed to decode the MessagePack value returned by the remote driver.
+    ValueDecodeError { address: String, err: rmp_serde::decode::Error },
     /// The workflow was denied by some checker.
     ExecDenied { err: Box<dyn Error> },
     /// Failed to run the workflow
@@ -1446,10 +1475,12 @@ impl Display for RunError {
 
             CompileError { .. } => write!(f, "Compilation of workflow failed (see output above)"),
             WorkflowSerializeError { .. } => write!(f, "Failed to serialize the compiled workflow"),
+            WorkflowEncodeError { .. } => write!(f, "Failed to encode the compiled workflow as MessagePack"),
             CommandRequestError { address, .. } => {
                 write!(f, "Could not run command on remote Brane instance '{address}': request failed: remote returned status")
             },
             ValueParseError { address, raw, .. } => write!(f, "Could not parse '{raw}' sent by remote '{address}' as a value"),
+            ValueDecodeError { address, .. } => write!(f, "Could not decode MessagePack value sent by remote '{address}'"),
             ExecDenied { .. } => write!(f, "Workflow was denied"),
             ExecError { .. } => write!(f, "Failed to run workflow"),
 
@@ -1496,8 +1527,10 @@ impl Error for RunError {
 
             CompileError { .. } => None,
             WorkflowSerializeError { err } => Some(err),
+            WorkflowEncodeError { err } => Some(err),
             CommandRequestError { err, .. } => Some(err),
             ValueParseError { err, .. } => Some(err),
+            ValueDecodeError { err, .. } => Some(err),
             ExecDenied { err } => Some(&**err),
             ExecError { err } => Some(&**err),
 
@@ -4,7 +4,7 @@
 //  Created:
 //    12 Sep 2022, 16:42:57
 //  Last edited:
-//    07 Mar 2024, 14:14:56
+//    14 Oct 2026, 18:29:39
 //  Auto updated?
 //    Yes
 //
@@ -19,6 +19,7 @@ use std::path::{Path, PathBuf};
 use std::str::FromStr;
 use std::sync::Arc;
 
+use arc_swap::ArcSwap;
 use brane_ast::state::CompileState;
 use brane_ast::{compile_snippet, CompileResult, ParserOptions, Workflow};
 use brane_dsl::Language;
@@ -28,10 +29,10 @@ use brane_tsk::docker::DockerOptions;
 use brane_tsk::errors::StringError;
 use brane_tsk::spec::{AppId, LOCALHOST};
 use console::style;
-use parking_lot::{Mutex, MutexGuard};
 use specifications::data::{AccessKind, DataIndex, DataInfo};
-use specifications::driving::{CreateSessionRequest, DriverServiceClient, ExecuteRequest};
+use specifications::driving::{CreateSessionReply, CreateSessionRequest, DriverServiceClient, ExecuteRequest};
 use specifications::package::PackageIndex;
+use specifications::profiling::ProfileScope;
 use tempfile::{tempdir, TempDir};
 use tonic::Code;
 
@@ -156,8 +157,8 @@ pub async fn initialize_instance<O: Write, E: Write>(
     stdout_writer: O,
     stderr_writer: E,
     drv_endpoint: impl AsRef<str>,
-    pindex: Arc<Mutex<PackageIndex>>,
-    dindex: Arc<Mutex<DataIndex>>,
+    pindex: Arc<ArcSwap<PackageIndex>>,
+    dindex: Arc<ArcSwap<DataIndex>>,
     user: Option<String>,
     attach: Option<AppId>,
     options: ParserOptions,
@@ -166,14 +167,53 @@ pub async fn initialize_instance<O: Write, E: Write>(
 
     // Connect to the server with gRPC
     debug!("Connecting to driver '{}'...", drv_endpoint);
-    let mut client: DriverServiceClient = match DriverServiceClient::connect(drv_endpoint.to_string()).await {
+    let client: DriverServiceClient = match DriverServiceClient::connect(drv_endpoint.to_string()).await {
         Ok(client) => client,
         Err(err) => {
             return Err(Error::ClientConnectError { address: drv_endpoint.into(), err });
         },
     };
 
-    // Either use the given Session UUID or create a new one (with matching session)
+    // Use that to initialize the instance
+    initialize_instance_with_client(stdout_writer, stderr_writer, drv_endpoint, client, pindex, dindex, user, attach, options).await
+}
+
+/// Initializes the state for an instance VM on top of an existing connection to the driver.
+///
+/// This allows connections to be re-used across VMs (the client may be a clone of one used elsewhere, sharing the underlying channel).
+///
+/// # Arguments
+/// - `stdout_writer`: Some [`Write`]-handle that we use to write stdout to.
+/// - `stderr_writer`: Some [`Write`]-handle that we use to write stderr to.
+/// - `drv_endpoint`: The `brane-drv` endpoint that the `client` is connected to. Only used for debugging and errors.
+/// - `client`: The [`DriverServiceClient`] that is connected to the remote driver.
+/// - `pindex`: The [`PackageIndex`] that contains the remote's available packages.
+/// - `dindex`: The [`DataIndex`] that contains the remote's available datasets.
+/// - `user`: Some (tentative) identifier of the user who might receive the end result.
+/// - `attach`: If given, we will try to attach to a session with that ID. Otherwise, we start a new session.
+/// - `options`: The ParserOptions that describe how to parse the given source.
+///
+/// # Returns
+/// A new [`InstanceVmState`] that represents the initialized VM.
+///
+/// # Errors
+/// This function may error if we failed to create a new session on the remote driver.
+#[allow(clippy::too_many_arguments)]
+pub async fn initialize_instance_with_client<O: Write, E: Write>(
+    stdout_writer: O,
+    stderr_writer: E,
+    drv_endpoint: impl AsRef<str>,
+    mut client: DriverServiceClient,
+    pindex: Arc<ArcSwap<PackageIndex>>,
+    dindex: Arc<ArcSwap<DataIndex>>,
+    user: Option<String>,
+    attach: Option<AppId>,
+    options: ParserOptions,
+) -> Result<InstanceVmState<O, E>, Error> {
+    let drv_endpoint: &str = drv_endpoint.as_ref();
+
+    // Either use the given Session UUID or create a new one (with matching session). We only know the driver's capabilities in the latter case.
+    let mut binary: bool = false;
     let session: AppId = if let Some(attach) = attach {
         debug!("Using existing session '{}'", attach);
         attach
@@ -188,12 +228,13 @@ pub async fn initialize_instance<O: Write, E: Write>(
         };
 
         // Return the UUID of this session
-        let raw: String = reply.into_inner().uuid;
-        debug!("Using new session '{}'", raw);
-        match AppId::from_str(&raw) {
+        let reply: CreateSessionReply = reply.into_inner();
+        binary = reply.binary.unwrap_or(false);
+        debug!("Using new session '{}' (driver {} MessagePack workflows)", reply.uuid, if binary { "accepts" } else { "does not accept" });
+        match AppId::from_str(&reply.uuid) {
             Ok(session) => session,
             Err(err) => {
-                return Err(Error::AppIdError { address: drv_endpoint.into(), raw, err: Box::new(err) });
+                return Err(Error::AppIdError { address: drv_endpoint.into(), raw: reply.uuid, err: Box::new(err) });
             },
         }
     };
@@ -213,6 +254,10 @@ pub async fn initialize_instance<O: Write, E: Write>(
 
         session,
         client,
+        binary,
+
+        cache_plan:  false,
+        plan_cached: false,
     })
 }
 
@@ -237,19 +282,69 @@ pub async fn run_instance<O: Write, E: Write>(
     workflow: &Workflow,
     profile: bool,
 ) -> Result<FullValue, Error> {
+    let (res, report): (FullValue, Option<ProfileScope>) = run_instance_profiled(drv_endpoint, state, workflow, profile).await?;
+
+    // Show profile times
+    if let Some(report) = report {
+        if let Err(err) = writeln!(&mut state.stdout, "\n{}", report.display_report()) {
+            return Err(Error::WriteError { err });
+        }
+    }
+    Ok(res)
+}
+
+/// Runs the given compiled workflow on the remote instance, returning the profile timings reported by the remote instead of printing them.
+///
+/// # Arguments
+/// - `drv_endpoint`: The `brane-drv` endpoint that we will connect to to run stuff (used for debugging only).
+/// - `state`: The InstanceVmState that we use to connect to the driver.
+/// - `workflow`: The already compiled [`Workflow`] to execute.
+/// - `profile`: If given, asks the remote to report its profile timings.
+///
+/// # Returns
+/// A [`FullValue`] carrying the result of the snippet (or [`FullValue::Void`]), and the [`ProfileScope`] with the remote's timings if `profile` was given and the remote reported them.
+///
+/// # Errors
+/// This function may error if anything in the whole shebang crashed. This can be things client-side, but also remote-side.
+pub async fn run_instance_profiled<O: Write, E: Write>(
+    drv_endpoint: impl AsRef<str>,
+    state: &mut InstanceVmState<O, E>,
+    workflow: &Workflow,
+    profile: bool,
+) -> Result<(FullValue, Option<ProfileScope>), Error> {
     let drv_endpoint: &str = drv_endpoint.as_ref();
 
-    // Serialize the workflow
-    let sworkflow: String = match serde_json::to_string(&workflow) {
-        Ok(sworkflow) => sworkflow,
-        Err(err) => {
-            return Err(Error::WorkflowSerializeError { err });
-        },
+    // Serialize the workflow, using the compact encoding if the driver supports it
+    let request: ExecuteRequest = if state.binary {
+        let bworkflow: Vec<u8> = match rmp_serde::to_vec_named(workflow) {
+            Ok(bworkflow) => bworkflow,
+            Err(err) => {
+                return Err(Error::WorkflowEncodeError { err });
+            },
+        };
+        ExecuteRequest {
+            uuid:       state.session.to_string(),
+            input:      String::new(),
+            input_bin:  Some(bworkflow),
+            profile:    Some(profile),
+            cache_plan: Some(state.cache_plan),
+        }
+    } else {
+        let sworkflow: String = match serde_json::to_string(&workflow) {
+            Ok(sworkflow) => sworkflow,
+            Err(err) => {
+                return Err(Error::WorkflowSerializeError { err });
+            },
+        };
+        ExecuteRequest {
+            uuid:       state.session.to_string(),
+            input:      sworkflow,
+            input_bin:  None,
+            profile:    Some(profile),
+            cache_plan: Some(state.cache_plan),
+        }
     };
 
-    // Prepare the request to execute this command
-    let request = ExecuteRequest { uuid: state.session.to_string(), input: sworkflow };
-
     // Run it
     let response = match state.client.execute(request).await {
         Ok(response) => response,
@@ -260,14 +355,27 @@ pub async fn run_instance<O: Write, E: Write>(
     let mut stream = response.into_inner();
 
     // Switch on the type of message that the remote returned
+    state.plan_cached = false;
     let mut res: FullValue = FullValue::Void;
+    let mut report: Option<ProfileScope> = None;
     loop {
         // Match on the message
         match stream.message().await {
             // The message itself went alright
             Ok(Some(reply)) => {
-                // Show profile times
-                if profile { /* TODO */ }
+                // Collect profile times
+                if let Some(sprofile) = reply.profile {
+                    // Failing to parse these is not worth failing the workflow over
+                    match serde_json::from_str(&sprofile) {
+                        Ok(scope) => report = Some(scope),
+                        Err(err) => warn!("Failed to parse profile timings reported by '{drv_endpoint}': {err}"),
+                    }
+                }
+
+                // Remember whether the remote re-used a plan
+                if let Some(plan_cached) = reply.plan_cached {
+                    state.plan_cached = plan_cached;
+                }
 
                 // The remote send us some debug message
                 if let Some(debug) = reply.debug {
@@ -305,6 +413,17 @@ pub async fn run_instance<O: Write, E: Write>(
                     // Set the result, packed
                     res = value;
                 }
+                if let Some(value) = reply.value_bin {
+                    debug!("Remote returned new value ({} bytes of MessagePack)", value.len());
+
+                    // Decode it
+                    res = match rmp_serde::from_slice(&value) {
+                        Ok(value) => value,
+                        Err(err) => {
+                            return Err(Error::ValueDecodeError { address: drv_endpoint.into(), err });
+                        },
+                    };
+                }
 
                 // The remote is done with this
                 if reply.close {
@@ -324,7 +443,7 @@ pub async fn run_instance<O: Write, E: Write>(
     }
 
     // Done
-    Ok(res)
+    Ok((res, report))
 }
 
 /// Post-processes the result of a workflow.
@@ -390,7 +509,8 @@ pub async fn process_instance(
                     Some(access) => access.clone(),
                     None => {
                         // Attempt to download it instead
-                        match data::download_data(api_endpoint, proxy_addr, certs_dir, data_dir, &name, &info.access).await {
+                        let opts: data::DownloadOptions = data::DownloadOptions::default();
+                        match data::download_data_cached(api_endpoint, proxy_addr, certs_dir, data_dir, info, &opts).await {
                             Ok(Some(access)) => access,
                             Ok(None) => {
                                 return Err(Error::UnavailableDataset { name: name.into(), locs: info.access.keys().cloned().collect() });
@@ -467,10 +587,10 @@ pub struct InstanceVmState<O, E> {
     /// A stderr to write outgoing stdout messages on.
     pub stderr: E,
 
-    /// The package index for this session.
-    pub pindex: Arc<Mutex<PackageIndex>>,
-    /// The data index for this session.
-    pub dindex: Arc<Mutex<DataIndex>>,
+    /// The package index for this session. Readers take a snapshot of it; updating it swaps in a new one.
+    pub pindex: Arc<ArcSwap<PackageIndex>>,
+    /// The data index for this session. Readers take a snapshot of it; updating it swaps in a new one.
+    pub dindex: Arc<ArcSwap<DataIndex>>,
     /// A username of the person doing everything rn.
     pub user:   Option<String>,
 
@@ -485,6 +605,13 @@ pub struct InstanceVmState<O, E> {
     pub session: AppId,
     /// The client which we use to communicate to the VM.
     pub client:  DriverServiceClient,
+    /// Whether the driver accepts workflows encoded as MessagePack instead of JSON.
+    pub binary:  bool,
+
+    /// Whether to allow the driver to re-use earlier plans of the same workflow in this session instead of planning again.
+    pub cache_plan:  bool,
+    /// Whether the driver re-used an earlier plan for the last workflow run with this state.
+    pub plan_cached: bool,
 }
 
 
@@ -662,15 +789,15 @@ pub async fn initialize_instance_vm(
     // We fetch a local copy of the indices for compiling
     debug!("Fetching global package & data indices from '{}'...", api_endpoint);
     let package_addr: String = format!("{api_endpoint}/graphql");
-    let pindex: Arc<Mutex<PackageIndex>> = match brane_tsk::api::get_package_index(&package_addr).await {
-        Ok(pindex) => Arc::new(Mutex::new(pindex)),
+    let pindex: Arc<ArcSwap<PackageIndex>> = match brane_tsk::api::get_package_index(&package_addr).await {
+        Ok(pindex) => Arc::new(ArcSwap::from_pointee(pindex)),
         Err(err) => {
             return Err(Error::RemotePackageIndexError { address: package_addr, err });
         },
     };
     let data_addr: String = format!("{api_endpoint}/data/info");
-    let dindex: Arc<Mutex<DataIndex>> = match brane_tsk::api::get_data_index(&data_addr).await {
-        Ok(dindex) => Arc::new(Mutex::new(dindex)),
+    let dindex: Arc<ArcSwap<DataIndex>> = match brane_tsk::api::get_data_index(&data_addr).await {
+        Ok(dindex) => Arc::new(ArcSwap::from_pointee(dindex)),
         Err(err) => {
             return Err(Error::RemoteDataIndexError { address: data_addr, err });
         },
@@ -776,9 +903,9 @@ pub async fn run_instance_vm(
 ) -> Result<FullValue, Error> {
     // Compile the workflow
     let workflow: Workflow = {
-        // Acquire the locks
-        let pindex: MutexGuard<PackageIndex> = state.pindex.lock();
-        let dindex: MutexGuard<DataIndex> = state.dindex.lock();
+        // Take a snapshot of the indices
+        let pindex: Arc<PackageIndex> = state.pindex.load_full();
+        let dindex: Arc<DataIndex> = state.dindex.load_full();
         compile(&mut state.state, &mut state.source, &pindex, &dindex, state.user.as_deref(), &state.options, what, snippet)?
     };
 
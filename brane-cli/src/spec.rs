@@ -4,7 +4,7 @@
 //  Created:
 //    28 Nov 2022, 15:56:23
 //  Last edited:
-//    07 Nov 2023, 16:29:39
+//    14 Oct 2026, 21:18:14
 //  Auto updated?
 //    Yes
 //
@@ -161,6 +161,8 @@ pub struct GlobalState {
     pub dindex:  Arc<DataIndex>,
     /// A list of results we planned in the previous timestep.
     pub results: Arc<Mutex<HashMap<String, String>>>,
+    /// If given, anything that workflows print is appended to this buffer instead of written to stdout.
+    pub stdout:  Option<Arc<Mutex<String>>>,
 }
 impl CustomGlobalState for GlobalState {}
 
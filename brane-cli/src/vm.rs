@@ -4,7 +4,7 @@
 //  Created:
 //    24 Oct 2022, 15:34:05
 //  Last edited:
-//    31 Jan 2024, 14:23:06
+//    14 Oct 2026, 15:37:30
 //  Auto updated?
 //    Yes
 //
@@ -35,7 +35,7 @@ use brane_tsk::spec::{Planner as _, LOCALHOST};
 use brane_tsk::tools::decode_base64;
 use chrono::Utc;
 use log::{debug, info};
-use parking_lot::Mutex;
+use parking_lot::{Mutex, MutexGuard};
 use specifications::container::{Image, VolumeBind};
 use specifications::data::{AccessKind, DataIndex, DataInfo, DataName, PreprocessKind};
 use specifications::package::{PackageIndex, PackageInfo};
@@ -179,7 +179,7 @@ impl VmPlugin for OfflinePlugin {
     }
 
     async fn stdout(
-        _global: &Arc<RwLock<Self::GlobalState>>,
+        global: &Arc<RwLock<Self::GlobalState>>,
         _local: &Self::LocalState,
         text: &str,
         newline: bool,
@@ -187,7 +187,17 @@ impl VmPlugin for OfflinePlugin {
     ) -> Result<(), Self::StdoutError> {
         info!("Writing '{}' to stdout (newline: {}) in an offline environment...", text, if newline { "yes" } else { "no" });
 
-        // Simply write
+        // Write to the buffer if we're asked to capture it
+        if let Some(buffer) = &global.read().unwrap().stdout {
+            let mut buffer: MutexGuard<String> = buffer.lock();
+            buffer.push_str(text);
+            if newline {
+                buffer.push('\n');
+            }
+            return Ok(());
+        }
+
+        // Otherwise, simply write
         if !newline {
             print!("{text}");
         } else {
@@ -320,6 +330,9 @@ impl VmPlugin for OfflinePlugin {
 
 /***** LIBRARY *****/
 /// Defines a VM that has no online interaction and does everything locally.
+///
+/// Clones share the global state of the VM, but have their own copy of the variables defined by earlier runs.
+#[derive(Clone)]
 pub struct OfflineVm {
     /// The runtime state for the VM
     state: RunState<GlobalState>,
@@ -361,10 +374,18 @@ impl OfflineVm {
                 pindex: package_index,
                 dindex: data_index,
                 results: Arc::new(Mutex::new(HashMap::new())),
+                stdout: None,
             }),
         }
     }
 
+    /// Makes the OfflineVm write anything that workflows print to the given buffer instead of to stdout.
+    ///
+    /// # Arguments
+    /// - `buffer`: The buffer to append to, or [`None`] to write to stdout again.
+    #[inline]
+    pub fn capture_stdout(&self, buffer: Option<Arc<Mutex<String>>>) { self.state.global.write().unwrap().stdout = buffer; }
+
     /// Runs the given workflow on this VM.
     ///
     /// There is a bit of ownership awkwardness going on, but that's due to the need for the struct to outlive threads.
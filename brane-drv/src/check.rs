@@ -4,7 +4,7 @@
 //  Created:
 //    06 Feb 2024, 11:46:14
 //  Last edited:
-//    08 Feb 2024, 14:39:13
+//    14 Oct 2026, 20:03:13
 //  Auto updated?
 //    Yes
 //
@@ -59,6 +59,9 @@ pub enum Error {
     /// Failed to serialize the [`Workflow`].
     WorkflowSerialize { id: String, err: serde_json::Error },
 
+    /// Failed to wait for a request to the given checker to complete.
+    RequestJoin { checker: String, err: tokio::task::JoinError },
+
     /// Failed to build a request to the given registry.
     RegistryRequest { domain: String, addr: Address, err: reqwest::Error },
     /// Failed to send a request to the given registry.
@@ -90,6 +93,8 @@ impl Display for Error {
             UnplannedNode { id, node } => write!(f, "Node {node} in workflow '{id}' is unplanned"),
             WorkflowSerialize { id, .. } => write!(f, "Failed to serialize workflow '{id}' to JSON"),
 
+            RequestJoin { checker, .. } => write!(f, "Failed to wait for request to checker '{checker}'"),
+
             RegistryRequest { domain, addr, .. } => write!(f, "Failed to build a request to registry of '{domain}' at '{addr}'"),
             RegistryRequestSend { domain, addr, .. } => write!(f, "Failed to send a request to registry of '{domain}' at '{addr}'"),
             RegistryResponseDownload { domain, addr, .. } => write!(f, "Failed to download response of registry of '{domain}' at '{addr}'"),
@@ -122,6 +127,8 @@ impl error::Error for Error {
             UnplannedNode { .. } => None,
             WorkflowSerialize { err, .. } => Some(err),
 
+            RequestJoin { err, .. } => Some(err),
+
             RegistryRequest { err, .. } => Some(err),
             RegistryRequestSend { err, .. } => Some(err),
             RegistryResponseDownload { err, .. } => Some(err),
@@ -502,5 +509,27 @@ pub fn spawn_requests(infra: &InfraFile, workflow: &Workflow) -> Result<Vec<(Str
     }
 
     // Done
-    Ok(vec![])
+    Ok(handles)
+}
+
+/// Waits for the requests spawned by [`spawn_requests()`] to complete, stopping at the first checker that denies the workflow.
+///
+/// # Arguments
+/// - `handles`: The handles returned by [`spawn_requests()`].
+///
+/// # Returns
+/// An Option that, if [`Some(...)`], denotes the named checker denied it for the given reasons. If [`None`], then all checkers allowed it.
+///
+/// # Errors
+/// This function errors if any of the requests failed.
+pub async fn join_requests(handles: Vec<(String, JoinHandle<RequestOutput>)>) -> RequestOutput {
+    for (checker, handle) in handles {
+        match handle.await {
+            Ok(Ok(None)) => continue,
+            Ok(Ok(Some(who))) => return Ok(Some(who)),
+            Ok(Err(err)) => return Err(err),
+            Err(err) => return Err(Error::RequestJoin { checker, err }),
+        }
+    }
+    Ok(None)
 }
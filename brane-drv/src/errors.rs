@@ -4,7 +4,7 @@
 //  Created:
 //    01 Feb 2022, 16:13:53
 //  Last edited:
-//    08 Feb 2024, 16:49:47
+//    14 Oct 2026, 20:03:13
 //  Auto updated?
 //    Yes
 //
@@ -23,6 +23,8 @@ use std::path::PathBuf;
 pub enum RemoteVmError {
     /// Failed to plan a workflow.
     PlanError { err: brane_tsk::errors::PlanError },
+    /// Failed to ask the checkers about a workflow with a re-used plan.
+    CachedPlanCheck { id: String, err: crate::check::Error },
     /// Failed to run a workflow.
     ExecError { err: brane_exe::Error },
 
@@ -39,6 +41,7 @@ impl Display for RemoteVmError {
         use RemoteVmError::*;
         match self {
             PlanError { .. } => write!(f, "Failed to plan workflow"),
+            CachedPlanCheck { id, .. } => write!(f, "Failed to check workflow '{id}' with cached plan"),
             ExecError { .. } => write!(f, "Failed to execute workflow"),
 
             IllegalNodeConfig { path, got } => {
@@ -55,6 +58,7 @@ impl Error for RemoteVmError {
         use RemoteVmError::*;
         match self {
             PlanError { err } => Some(err),
+            CachedPlanCheck { err, .. } => Some(err),
             ExecError { err } => Some(err),
 
             IllegalNodeConfig { .. } => None,
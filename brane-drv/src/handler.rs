@@ -4,7 +4,7 @@
 //  Created:
 //    12 Sep 2022, 16:18:11
 //  Last edited:
-//    07 Mar 2024, 14:20:06
+//    14 Oct 2026, 18:29:39
 //  Auto updated?
 //    Yes
 //
@@ -152,7 +152,7 @@ impl DriverService for DriverHandler {
 
         // Now return the ID to the user for future reference
         debug!("Created new session '{}'", app_id);
-        let reply = CreateSessionReply { uuid: app_id.into() };
+        let reply = CreateSessionReply { uuid: app_id.into(), binary: Some(true) };
         Ok(Response::new(reply))
     }
 
@@ -328,27 +328,46 @@ impl DriverService for DriverHandler {
 
             // We assume that the input is an already compiled workflow; so no need to fire up any parsers/compilers
 
-            // We only have to use JSON magic
+            // We only have to use JSON (or MessagePack) magic
             let par = report.time("Workflow parsing");
-            debug!("Parsing workflow of {} characters", request.input.len());
-            let workflow: Workflow = match serde_json::from_str(&request.input) {
-                Ok(workflow) => workflow,
-                Err(err) => {
-                    debug!(
-                        "Workflow:\n{}\n{}\n{}\n\n",
-                        (0..80).map(|_| '-').collect::<String>(),
-                        request.input,
-                        (0..80).map(|_| '-').collect::<String>()
-                    );
-                    fatal_err!(tx, Status::invalid_argument, err);
-                },
+            let binary: bool = request.input_bin.is_some();
+            let profile: bool = request.profile.unwrap_or(false);
+            let cache_plan: bool = request.cache_plan.unwrap_or(false);
+            let workflow: Workflow = if let Some(input) = &request.input_bin {
+                debug!("Parsing workflow of {} bytes (MessagePack)", input.len());
+                match rmp_serde::from_slice(input) {
+                    Ok(workflow) => workflow,
+                    Err(err) => {
+                        fatal_err!(tx, Status::invalid_argument, err);
+                    },
+                }
+            } else {
+                debug!("Parsing workflow of {} characters", request.input.len());
+                match serde_json::from_str(&request.input) {
+                    Ok(workflow) => workflow,
+                    Err(err) => {
+                        debug!(
+                            "Workflow:\n{}\n{}\n{}\n\n",
+                            (0..80).map(|_| '-').collect::<String>(),
+                            request.input,
+                            (0..80).map(|_| '-').collect::<String>()
+                        );
+                        fatal_err!(tx, Status::invalid_argument, err);
+                    },
+                }
             };
             par.stop();
 
-            // We now have a runnable plan ( ͡° ͜ʖ ͡°), so run it
+            // We now have a runnable plan ( ͡° ͜ʖ ͡°), so run it - unless the client goes away (cancelled or timed out) before it completes
             debug!("Executing workflow of {} edges", workflow.graph.len());
-            let (vm, res): (InstanceVm, Result<FullValue, RemoteVmError>) =
-                report.nest_fut("VM execution", |scope| vm.exec(tx.clone(), app_id.clone(), workflow, scope)).await;
+            let (vm, res): (InstanceVm, Result<(FullValue, bool), RemoteVmError>) = tokio::select! {
+                res = report.nest_fut("VM execution", |scope| vm.exec(tx.clone(), app_id.clone(), workflow, cache_plan, scope)) => res,
+                _ = tx.closed() => {
+                    // Dropping the execution future also drops the connections to the workers, which tears down their streams
+                    info!("Client of session '{app_id}' closed its stream; aborted workflow execution");
+                    return;
+                },
+            };
 
             // Insert the VM again
             debug!("Saving state session state");
@@ -356,21 +375,42 @@ impl DriverService for DriverHandler {
 
             // Switch on the actual result and send that back to the user
             match res {
-                Ok(res) => {
-                    debug!("Completed execution.");
-                    let _ret = report.time("Returning value");
-
-                    // Serialize the value
-                    let sres: String = match serde_json::to_string(&res) {
-                        Ok(sres) => sres,
-                        Err(err) => {
-                            fatal_err!(tx, Status::internal, err);
-                        },
+                Ok((res, plan_cached)) => {
+                    debug!("Completed execution{}.", if plan_cached { " (with cached plan)" } else { "" });
+                    let ret = report.time("Returning value");
+
+                    // Serialize the value, in the same encoding as the client used
+                    let (sres, bres): (Option<String>, Option<Vec<u8>>) = if binary {
+                        match rmp_serde::to_vec_named(&res) {
+                            Ok(bres) => (None, Some(bres)),
+                            Err(err) => {
+                                fatal_err!(tx, Status::internal, err);
+                            },
+                        }
+                    } else {
+                        match serde_json::to_string(&res) {
+                            Ok(sres) => (Some(sres), None),
+                            Err(err) => {
+                                fatal_err!(tx, Status::internal, err);
+                            },
+                        }
                     };
 
-                    // Create the reply text
+                    ret.stop();
+
+                    // Create the reply text (with the timings so far, if asked)
                     let msg = String::from("Driver completed execution.");
-                    let reply = ExecuteReply { close: true, debug: Some(msg.clone()), stderr: None, stdout: None, value: Some(sres) };
+                    let sprofile: Option<String> = if profile { serde_json::to_string(report.scope()).ok() } else { None };
+                    let reply = ExecuteReply {
+                        close: true,
+                        debug: Some(msg.clone()),
+                        stderr: None,
+                        stdout: None,
+                        value: sres,
+                        value_bin: bres,
+                        profile: sprofile,
+                        plan_cached: Some(plan_cached),
+                    };
 
                     // Send it
                     if let Err(err) = tx.send(Ok(reply)).await {
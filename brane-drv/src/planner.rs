@@ -4,7 +4,7 @@
 //  Created:
 //    25 Oct 2022, 11:35:00
 //  Last edited:
-//    08 Feb 2024, 17:27:11
+//    14 Oct 2026, 20:03:13
 //  Auto updated?
 //    Yes
 //
@@ -14,6 +14,12 @@
 
 
 /***** LIBRARY *****/
+use std::collections::hash_map::DefaultHasher;
+use std::collections::HashMap;
+use std::hash::{Hash as _, Hasher as _};
+use std::sync::{Mutex, OnceLock};
+use std::time::{Duration, Instant, SystemTime};
+
 use brane_ast::Workflow;
 use brane_tsk::errors::PlanError;
 use brane_tsk::spec::{AppId, TaskId};
@@ -25,6 +31,187 @@ use specifications::planning::{PlanningDeniedReply, PlanningReply, PlanningReque
 use specifications::profiling::ProfileScopeHandle;
 
 
+/***** TESTS *****/
+#[cfg(test)]
+mod tests {
+    use brane_ast::SymTable;
+
+    use super::*;
+
+
+    /// Returns a new, empty workflow with the given ID.
+    fn workflow(id: &str) -> Workflow { Workflow::new(id.into(), SymTable::new(), vec![], HashMap::new()) }
+
+    #[test]
+    fn test_plan_key() {
+        let (key1, swf1): (PlanKey, Vec<u8>) = PlanKey::new("app", "plr", None, &workflow("a")).unwrap();
+        let (key2, swf2): (PlanKey, Vec<u8>) = PlanKey::new("app", "plr", None, &workflow("b")).unwrap();
+        // The ID of a workflow is not part of the key, since it is different for every submission
+        assert_eq!(key1, key2);
+        assert_eq!(swf1, swf2);
+        // But the session, planner and infrastructure are
+        assert_ne!(key1, PlanKey::new("other", "plr", None, &workflow("a")).unwrap().0);
+        assert_ne!(key1, PlanKey::new("app", "other", None, &workflow("a")).unwrap().0);
+        assert_ne!(key1, PlanKey::new("app", "plr", Some(SystemTime::UNIX_EPOCH), &workflow("a")).unwrap().0);
+    }
+
+    #[test]
+    fn test_plan_cache_hit() {
+        let mut cache: PlanCache = PlanCache::default();
+        let (key, swf): (PlanKey, Vec<u8>) = PlanKey::new("app", "plr", None, &workflow("a")).unwrap();
+        assert!(cache.get(&key, &swf, "b").is_none());
+
+        // A hit is given the ID of the new submission
+        cache.insert(key.clone(), swf.clone(), workflow("a"));
+        assert_eq!(cache.get(&key, &swf, "b").map(|plan| plan.id), Some("b".into()));
+
+        // A colliding hash with another workflow is not a hit
+        assert!(cache.get(&key, b"other", "b").is_none());
+    }
+
+    #[test]
+    fn test_plan_cache_expiry() {
+        let mut cache: PlanCache = PlanCache::default();
+        let (key, swf): (PlanKey, Vec<u8>) = PlanKey::new("app", "plr", None, &workflow("a")).unwrap();
+        cache.insert(key.clone(), swf.clone(), workflow("a"));
+
+        // Pretend the plan was made too long ago
+        let created: Instant = match Instant::now().checked_sub(PLAN_CACHE_TTL + Duration::from_secs(1)) {
+            Some(created) => created,
+            None => return,
+        };
+        cache.plans.get_mut(&key).unwrap().created = created;
+        assert!(cache.get(&key, &swf, "b").is_none());
+
+        // Expired plans are removed when a new one is added
+        let (key2, swf2): (PlanKey, Vec<u8>) = PlanKey::new("app2", "plr", None, &workflow("a")).unwrap();
+        cache.insert(key2, swf2, workflow("a"));
+        assert_eq!(cache.plans.len(), 1);
+    }
+
+    #[test]
+    fn test_plan_cache_size() {
+        let mut cache: PlanCache = PlanCache::default();
+        for i in 0..PLAN_CACHE_SIZE + 8 {
+            let (key, swf): (PlanKey, Vec<u8>) = PlanKey::new(&i.to_string(), "plr", None, &workflow("a")).unwrap();
+            cache.insert(key, swf, workflow("a"));
+        }
+        assert_eq!(cache.plans.len(), PLAN_CACHE_SIZE);
+    }
+}
+
+
+
+
+
+/***** CONSTANTS *****/
+/// How long a cached plan may be reused before the workflow is planned again.
+const PLAN_CACHE_TTL: Duration = Duration::from_secs(300);
+/// The maximum number of plans kept in the plan cache.
+const PLAN_CACHE_SIZE: usize = 64;
+
+
+
+
+
+/***** HELPERS *****/
+/// Identifies a plan in the plan cache.
+#[derive(Clone, Debug, Eq, Hash, PartialEq)]
+struct PlanKey {
+    /// The session for which the workflow was planned.
+    app_id: String,
+    /// The address of the planner that made the plan.
+    plr:    String,
+    /// The version of the infrastructure the plan was made for.
+    infra:  Option<SystemTime>,
+    /// The hash of the serialized workflow.
+    hash:   u64,
+}
+
+impl PlanKey {
+    /// Constructor for the PlanKey that identifies the given workflow by everything but its ID, which differs for every submission.
+    ///
+    /// # Arguments
+    /// - `app_id`: The session for which the workflow is planned.
+    /// - `plr`: The address of the planner that plans it.
+    /// - `infra`: The version of the infrastructure file (i.e., its modification time), if known.
+    /// - `workflow`: The Workflow to identify.
+    ///
+    /// # Returns
+    /// A new PlanKey, together with the serialized workflow it was computed from.
+    ///
+    /// # Errors
+    /// This function errors if we failed to serialize the workflow.
+    fn new(app_id: &str, plr: &str, infra: Option<SystemTime>, workflow: &Workflow) -> Result<(Self, Vec<u8>), serde_json::Error> {
+        let swf: Vec<u8> = serde_json::to_vec(&Workflow { id: String::new(), ..workflow.clone() })?;
+        let mut hasher = DefaultHasher::new();
+        swf.hash(&mut hasher);
+        Ok((Self { app_id: app_id.into(), plr: plr.into(), infra, hash: hasher.finish() }, swf))
+    }
+}
+
+/// A plan stored in the plan cache.
+struct CachedPlan {
+    /// The serialized workflow that was planned, to rule out hash collisions.
+    workflow: Vec<u8>,
+    /// The planned workflow.
+    plan:     Workflow,
+    /// The moment the plan was made.
+    created:  Instant,
+}
+
+/// Keeps a bounded number of recent plans around (see [`InstancePlanner::plan_cached()`]).
+#[derive(Default)]
+struct PlanCache {
+    /// The cached plans.
+    plans: HashMap<PlanKey, CachedPlan>,
+}
+
+impl PlanCache {
+    /// Returns the cached plan for the given workflow, if there is one and it is not expired.
+    ///
+    /// # Arguments
+    /// - `key`: The [`PlanKey`] of the workflow.
+    /// - `swf`: The serialized workflow, as returned by [`PlanKey::new()`].
+    /// - `id`: The ID of the workflow, which is given to the returned plan.
+    ///
+    /// # Returns
+    /// A copy of the cached plan, or [`None`] if there is none.
+    fn get(&self, key: &PlanKey, swf: &[u8], id: &str) -> Option<Workflow> {
+        let cached: &CachedPlan = self.plans.get(key)?;
+        if cached.workflow != swf || cached.created.elapsed() >= PLAN_CACHE_TTL {
+            return None;
+        }
+        Some(Workflow { id: id.into(), ..cached.plan.clone() })
+    }
+
+    /// Adds a new plan to the cache, removing expired plans and, if it is still full, the oldest one.
+    ///
+    /// # Arguments
+    /// - `key`: The [`PlanKey`] of the workflow.
+    /// - `swf`: The serialized workflow, as returned by [`PlanKey::new()`].
+    /// - `plan`: The planned workflow.
+    fn insert(&mut self, key: PlanKey, swf: Vec<u8>, plan: Workflow) {
+        self.plans.retain(|_, cached| cached.created.elapsed() < PLAN_CACHE_TTL);
+        if self.plans.len() >= PLAN_CACHE_SIZE {
+            if let Some(oldest) = self.plans.iter().min_by_key(|(_, cached)| cached.created).map(|(key, _)| key.clone()) {
+                self.plans.remove(&oldest);
+            }
+        }
+        self.plans.insert(key, CachedPlan { workflow: swf, plan, created: Instant::now() });
+    }
+}
+
+/// Returns the plans cached by [`InstancePlanner::plan_cached()`].
+fn plan_cache() -> &'static Mutex<PlanCache> {
+    static PLAN_CACHE: OnceLock<Mutex<PlanCache>> = OnceLock::new();
+    PLAN_CACHE.get_or_init(|| Mutex::new(PlanCache::default()))
+}
+
+
+
+
+
 /***** LIBRARY *****/
 /// The planner is in charge of assigning locations to tasks in a workflow. This one defers planning to the `brane-plr` service.
 pub struct InstancePlanner;
@@ -119,4 +306,43 @@ impl InstancePlanner {
         // Done
         Ok(plan)
     }
+
+    /// Plans the given workflow, re-using an earlier plan of the same workflow if there is one.
+    ///
+    /// Plans are only shared within the same session, and only while the planner and the infrastructure stay the same. Note that a re-used plan has not been seen by the checkers for this submission; callers have to ask them again before running it (see [`join_requests()`](crate::check::join_requests())).
+    ///
+    /// # Arguments
+    /// - `plr`: The address of the remote planner to connect to.
+    /// - `app_id`: The session ID for this workflow.
+    /// - `workflow`: The Workflow to plan.
+    /// - `infra`: The version of the infrastructure file (i.e., its modification time), if known.
+    /// - `prof`: The ProfileScope that can be used to provide additional information about the timings of the planning (driver-side).
+    ///
+    /// # Returns
+    /// The same workflow as given, but now with all tasks and data transfers planned, and whether that plan came from the cache.
+    pub async fn plan_cached(
+        plr: &Address,
+        app_id: AppId,
+        workflow: Workflow,
+        infra: Option<SystemTime>,
+        prof: ProfileScopeHandle<'_>,
+    ) -> Result<(Workflow, bool), PlanError> {
+        // See if we already planned it
+        let lookup = prof.time("plan cache lookup");
+        let (key, swf): (PlanKey, Vec<u8>) = match PlanKey::new(&app_id.to_string(), &plr.to_string(), infra, &workflow) {
+            Ok(key) => key,
+            Err(err) => return Err(PlanError::WorkflowSerialize { id: workflow.id, err }),
+        };
+        let cached: Option<Workflow> = plan_cache().lock().unwrap().get(&key, &swf, &workflow.id);
+        lookup.stop();
+        if let Some(plan) = cached {
+            debug!("Re-using cached plan for workflow '{}'", plan.id);
+            return Ok((plan, true));
+        }
+
+        // Otherwise, plan it and remember the result
+        let plan: Workflow = Self::plan(plr, app_id, workflow, prof).await?;
+        plan_cache().lock().unwrap().insert(key, swf, plan.clone());
+        Ok((plan, false))
+    }
 }
@@ -4,7 +4,7 @@
 //  Created:
 //    27 Oct 2022, 10:14:26
 //  Last edited:
-//    07 Mar 2024, 14:18:12
+//    14 Oct 2026, 20:03:13
 //  Auto updated?
 //    Yes
 //
@@ -15,8 +15,10 @@
 //!   complicating the `stdout()` function.
 //
 
+use std::fs;
 use std::path::{Path, PathBuf};
 use std::sync::{Arc, RwLock, RwLockReadGuard, RwLockWriteGuard};
+use std::time::SystemTime;
 
 use async_trait::async_trait;
 use brane_ast::func_id::FunctionId;
@@ -29,7 +31,7 @@ use brane_exe::pc::ProgramCounter;
 use brane_exe::spec::{TaskInfo, VmPlugin};
 use brane_exe::{Error as VmError, FullValue, RunState, Vm};
 use brane_prx::client::ProxyClient;
-use brane_tsk::errors::{CommitError, ExecuteError, PreprocessError, StdoutError, StringError};
+use brane_tsk::errors::{CommitError, ExecuteError, PlanError, PreprocessError, StdoutError, StringError};
 use brane_tsk::spec::{AppId, JobStatus};
 use enum_debug::EnumDebug as _;
 use log::{debug, info, warn};
@@ -40,9 +42,11 @@ use specifications::profiling::ProfileScopeHandle;
 use specifications::working::TransferRegistryTar;
 use specifications::{driving as driving_grpc, working as working_grpc};
 use tokio::sync::mpsc::Sender;
+use tokio::task::JoinHandle;
 use tonic::{Response, Status, Streaming};
 
 pub use crate::errors::RemoteVmError as Error;
+use crate::check::{self, RequestOutput};
 use crate::planner::InstancePlanner;
 use crate::spec::{GlobalState, LocalState};
 
@@ -412,12 +416,15 @@ impl VmPlugin for InstancePlugin {
         // Write stdout to the tx
         if let Err(err) = tx
             .send(Ok(driving_grpc::ExecuteReply {
-                stdout: Some(format!("{}{}", text, if newline { "\n" } else { "" })),
-                stderr: None,
-                debug:  None,
-                value:  None,
-
-                close: false,
+                stdout:    Some(format!("{}{}", text, if newline { "\n" } else { "" })),
+                stderr:    None,
+                debug:     None,
+                value:     None,
+                value_bin: None,
+                profile:   None,
+
+                plan_cached: None,
+                close:       false,
             }))
             .await
         {
@@ -542,19 +549,21 @@ impl InstanceVm {
     /// - `tx`: The transmission channel to send feedback to the client on.
     /// - `id`: The identifier of the workflow this session is part of.
     /// - `workflow`: The Workflow to execute.
+    /// - `cache_plan`: If true, re-uses an earlier plan of the same workflow in this session if there is one (see [`InstancePlanner::plan_cached()`]).
     /// - `prof`: The ProfileScope that can be used to provide additional information about the timings of the VM.
     ///
     /// # Returns
-    /// The result of the workflow, if any. It also returns `self` again for subsequent runs.
+    /// The result of the workflow, if any, and whether its plan was re-used. It also returns `self` again for subsequent runs.
     pub async fn exec(
         self,
         tx: Sender<Result<driving_grpc::ExecuteReply, Status>>,
         id: AppId,
         workflow: Workflow,
+        cache_plan: bool,
         prof: ProfileScopeHandle<'_>,
-    ) -> (Self, Result<FullValue, Error>) {
+    ) -> (Self, Result<(FullValue, bool), Error>) {
         // Step 0: Load files
-        let plr_addr: Address = {
+        let (plr_addr, infra_version): (Address, Option<SystemTime>) = {
             let mut global = self.state.global.write().unwrap();
 
             debug!("Loading node config file '{}'...", global.node_config_path.display());
@@ -588,20 +597,54 @@ impl InstanceVm {
             global.infra = Some(infra);
 
             // Done
-            central_cfg.services.plr.address
+            let infra_version: Option<SystemTime> = fs::metadata(&central_cfg.paths.infra).and_then(|md| md.modified()).ok();
+            (central_cfg.services.plr.address, infra_version)
         };
 
 
 
         // Step 1: Plan
         debug!("Planning workflow on Kafka planner...");
-        let plan: Workflow = match prof.nest_fut("planning (brane-drv)", |scope| InstancePlanner::plan(&plr_addr, id, workflow, scope)).await {
-            Ok(plan) => plan,
+        let planned: Result<(Workflow, bool), PlanError> = prof
+            .nest_fut("planning (brane-drv)", |scope| async move {
+                if cache_plan {
+                    InstancePlanner::plan_cached(&plr_addr, id, workflow, infra_version, scope).await
+                } else {
+                    InstancePlanner::plan(&plr_addr, id, workflow, scope).await.map(|plan| (plan, false))
+                }
+            })
+            .await;
+        let (plan, plan_cached): (Workflow, bool) = match planned {
+            Ok(planned) => planned,
             Err(err) => {
                 return (self, Err(Error::PlanError { err }));
             },
         };
 
+        // The checkers only see workflows while they are planned, so ask them again if we skipped that
+        if plan_cached {
+            debug!("Asking checkers about workflow '{}' with cached plan...", plan.id);
+            let timer = prof.time("checking cached plan");
+            let handles: Result<Vec<(String, JoinHandle<RequestOutput>)>, check::Error> = {
+                let global: RwLockReadGuard<GlobalState> = self.state.global.read().unwrap();
+                check::spawn_requests(global.infra.as_ref().expect("Missing `infra` in GlobalState; did you forget to load it?"), &plan)
+            };
+            let verdict: RequestOutput = match handles {
+                Ok(handles) => check::join_requests(handles).await,
+                Err(err) => Err(err),
+            };
+            timer.stop();
+            match verdict {
+                Ok(None) => {},
+                Ok(Some((domain, reasons))) => {
+                    return (self, Err(Error::PlanError { err: PlanError::CheckerDenied { domain, reasons } }));
+                },
+                Err(err) => {
+                    return (self, Err(Error::CachedPlanCheck { id: plan.id, err }));
+                },
+            }
+        }
+
         // Also update the TX & workflow in the internal state
         {
             let mut state: RwLockWriteGuard<GlobalState> = self.state.global.write().unwrap();
@@ -636,7 +679,7 @@ impl InstanceVm {
         };
 
         // Done, return
-        (this, Ok(value))
+        (this, Ok((value, plan_cached)))
     }
 }
 
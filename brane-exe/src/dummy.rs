@@ -4,7 +4,7 @@
 //  Created:
 //    13 Sep 2022, 16:43:11
 //  Last edited:
-//    31 Jan 2024, 11:36:37
+//    14 Oct 2026, 15:37:30
 //  Auto updated?
 //    Yes
 //
@@ -329,6 +329,9 @@ impl DummyPlanner {
 
 
 /// Defines a Dummy VM that may be used to test.
+///
+/// Clones share the global state of the VM, but have their own copy of the variables defined by earlier runs.
+#[derive(Clone)]
 pub struct DummyVm {
     /// The internal state of the VM in between runs.
     state: RunState<DummyState>,
@@ -360,6 +363,25 @@ impl DummyVm {
     /// # Returns
     /// The result of the workflow, if any. It also returns `self` again for subsequent runs.
     pub async fn exec(self, workflow: Workflow) -> (Self, Result<FullValue, Error>) {
+        let (this, res): (Self, Result<FullValue, Error>) = self.exec_buffered(workflow).await;
+
+        // Because this is a dummy VM, also flush the text buffer
+        if res.is_ok() {
+            this.flush_stdout();
+        }
+        (this, res)
+    }
+
+    /// Runs the given workflow on this VM, but keeps anything it prints in the VM's buffer instead of writing it to stdout.
+    ///
+    /// Use [`DummyVm::take_stdout()`] to retrieve it.
+    ///
+    /// # Arguments
+    /// - `workflow`: The Workflow to execute.
+    ///
+    /// # Returns
+    /// The result of the workflow, if any. It also returns `self` again for subsequent runs.
+    pub async fn exec_buffered(self, workflow: Workflow) -> (Self, Result<FullValue, Error>) {
         let plan: Workflow = {
             let mut state: RwLockWriteGuard<DummyState> = self.state.global.write().unwrap();
 
@@ -395,8 +417,7 @@ impl DummyVm {
             },
         };
 
-        // Done, return - but because this is a dummy VM, also flush the text buffer
-        this.flush_stdout();
+        // Done, return
         (this, Ok(value))
     }
 
@@ -404,12 +425,18 @@ impl DummyVm {
     ///
     /// # Returns
     /// Nothing, but does print to stdout.
-    pub fn flush_stdout(&self) {
+    #[inline]
+    pub fn flush_stdout(&self) { print!("{}", self.take_stdout()); }
+
+    /// Takes the buffered text, clearing it.
+    ///
+    /// # Returns
+    /// Everything printed by workflows since the last flush.
+    pub fn take_stdout(&self) -> String {
         // Fetch the global state if there is one
         let state: RwLockWriteGuard<DummyState> = self.state.global.write().unwrap();
         let mut text: MutexGuard<String> = state.text.lock().unwrap();
-        print!("{text}");
-        *text = String::new();
+        std::mem::take(&mut *text)
     }
 }
 
@@ -4,7 +4,7 @@
 //  Created:
 //    20 Sep 2022, 13:44:07
 //  Last edited:
-//    16 Jan 2024, 15:13:18
+//    14 Oct 2026, 18:09:25
 //  Auto updated?
 //    Yes
 //
@@ -312,6 +312,33 @@ mod tests {
         // Void
         assert_eq!(serde_json::from_str::<FullValue>("null").unwrap_or_else(|err| panic!("{}", err)), FullValue::Void);
     }
+
+    #[test]
+    fn test_fullvalue_accessors() {
+        // Test if the accessors only return the value of the matching variant
+        assert_eq!(FullValue::Boolean(true).as_bool(), Some(true));
+        assert_eq!(FullValue::Integer(42).as_int(), Some(42));
+        assert_eq!(FullValue::Integer(42).as_real(), None);
+        assert_eq!(FullValue::Real(4.2).as_real(), Some(4.2));
+        assert_eq!(FullValue::String("Hello there!".into()).as_str(), Some("Hello there!"));
+        assert_eq!(FullValue::Data("testset".into()).as_str(), None);
+        assert_eq!(FullValue::Data("testset".into()).as_data(), Some("testset"));
+        assert_eq!(FullValue::IntermediateResult("result_foo".into()).as_result(), Some("result_foo"));
+        assert_eq!(FullValue::Void.as_bool(), None);
+
+        // Arrays
+        let array: FullValue = FullValue::Array(vec![FullValue::Integer(1), FullValue::Integer(2)]);
+        assert_eq!(array.as_array(), Some(&[FullValue::Integer(1), FullValue::Integer(2)][..]));
+        assert_eq!(FullValue::Void.as_array(), None);
+
+        // Instances
+        let instance: FullValue =
+            FullValue::Instance("Test".into(), HashMap::from([("a".into(), FullValue::Integer(42)), ("b".into(), FullValue::Boolean(false))]));
+        let (name, fields): (&str, &HashMap<String, FullValue>) = instance.as_instance().unwrap_or_else(|| panic!("Instance is not an instance"));
+        assert_eq!(name, "Test");
+        assert_eq!(fields.get("a"), Some(&FullValue::Integer(42)));
+        assert_eq!(fields.get("c"), None);
+    }
 }
 
 
@@ -993,6 +1020,64 @@ impl FullValue {
         }
     }
 
+    /// Returns the FullValue as a boolean without consuming it.
+    ///
+    /// # Returns
+    /// The internal boolean value if this was a boolean, or else `None`.
+    #[inline]
+    pub fn as_bool(&self) -> Option<bool> { if let Self::Boolean(value) = self { Some(*value) } else { None } }
+
+    /// Returns the FullValue as an integer without consuming it.
+    ///
+    /// # Returns
+    /// The internal integer value if this was an integer, or else `None`.
+    #[inline]
+    pub fn as_int(&self) -> Option<i64> { if let Self::Integer(value) = self { Some(*value) } else { None } }
+
+    /// Returns the FullValue as a real without consuming it.
+    ///
+    /// # Returns
+    /// The internal real value if this was a real, or else `None`.
+    #[inline]
+    pub fn as_real(&self) -> Option<f64> { if let Self::Real(value) = self { Some(*value) } else { None } }
+
+    /// Returns a view of the FullValue as a string.
+    ///
+    /// # Returns
+    /// The internal string value if this was a string, or else `None`.
+    #[inline]
+    pub fn as_str(&self) -> Option<&str> { if let Self::String(value) = self { Some(value.as_str()) } else { None } }
+
+    /// Returns a view of the FullValue as a data (identifier).
+    ///
+    /// # Returns
+    /// The internal dataset's identifier if this was a data, or else `None`.
+    #[inline]
+    pub fn as_data(&self) -> Option<&str> { if let Self::Data(value) = self { Some(value.as_ref()) } else { None } }
+
+    /// Returns a view of the FullValue as an intermediate result (identifier).
+    ///
+    /// # Returns
+    /// The internal result's identifier if this was an intermediate result, or else `None`.
+    #[inline]
+    pub fn as_result(&self) -> Option<&str> { if let Self::IntermediateResult(value) = self { Some(value.as_ref()) } else { None } }
+
+    /// Returns a view of the FullValue as an array.
+    ///
+    /// # Returns
+    /// The internal elements if this was an array, or else `None`.
+    #[inline]
+    pub fn as_array(&self) -> Option<&[Self]> { if let Self::Array(values) = self { Some(values.as_slice()) } else { None } }
+
+    /// Returns a view of the FullValue as an instance.
+    ///
+    /// # Returns
+    /// The name of the instance's class and its fields if this was an instance, or else `None`.
+    #[inline]
+    pub fn as_instance(&self) -> Option<(&str, &HashMap<String, Self>)> {
+        if let Self::Instance(name, values) = self { Some((name.as_str(), values)) } else { None }
+    }
+
     /// Returns the DataType of this Value. Note that the following properties may be assumed:
     /// - The datatype is never Void (since it is a value)
     /// - Because it is runtime, it _always_ has a non-Any type (i.e., it's always resolved).
@@ -4,7 +4,7 @@
 //  Created:
 //    31 Oct 2022, 11:21:14
 //  Last edited:
-//    01 May 2024, 10:39:39
+//    14 Oct 2026, 21:05:34
 //  Auto updated?
 //    Yes
 //
@@ -1187,11 +1187,20 @@ async fn execute_task_local(
         error!("{}", err.trace());
     }
 
-    // ...and wait for it to complete
-    let (code, stdout, stderr): (i32, String, String) = match exec.time_fut("join overhead", docker::join(dinfo, name, keep_container)).await {
-        Ok(name) => name,
-        Err(err) => {
-            return Err(JobStatus::CompletionFailed(format!("Failed to join container: {err}")));
+    // ...and wait for it to complete, unless the client goes away (e.g., because the workflow was cancelled) before it does
+    let (code, stdout, stderr): (i32, String, String) = tokio::select! {
+        res = exec.time_fut("join overhead", docker::join(&dinfo, &name, keep_container)) => match res {
+            Ok(res) => res,
+            Err(err) => {
+                return Err(JobStatus::CompletionFailed(format!("Failed to join container: {err}")));
+            },
+        },
+        _ = tx.closed() => {
+            info!("Client closed its stream while task '{}' was running; stopping container '{}'", tinfo.name, name);
+            if let Err(err) = docker::stop(&dinfo, &name).await {
+                error!("Failed to stop container '{}': {}", name, err);
+            }
+            return Err(JobStatus::Stopped);
         },
     };
     total.stop();
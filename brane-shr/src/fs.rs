@@ -4,7 +4,7 @@
 //  Created:
 //    09 Nov 2022, 11:12:06
 //  Last edited:
-//    13 Dec 2023, 08:19:48
+//    14 Oct 2026, 21:13:00
 //  Auto updated?
 //    Yes
 //
@@ -1563,14 +1563,6 @@ pub async fn unarchive_async(tarball: impl AsRef<Path>, target: impl AsRef<Path>
     let target: &Path = target.as_ref();
     debug!("Extracting '{}' to '{}'...", tarball.display(), target.display());
 
-    // Whine if the target already exists
-    if target.exists() {
-        return Err(Error::PathExistsError { what: "target", path: target.into() });
-    }
-    if let Err(err) = tfs::create_dir(target).await {
-        return Err(Error::DirCreateError { what: "target", path: target.into(), err });
-    }
-
     // Open the source tarfile
     let handle: tfs::File = match tfs::File::open(tarball).await {
         Ok(handle) => handle,
@@ -1579,8 +1571,39 @@ pub async fn unarchive_async(tarball: impl AsRef<Path>, target: impl AsRef<Path>
         },
     };
 
-    // Create the decoder & tarfile around this file
-    let dec: GzipDecoder<_> = GzipDecoder::new(tio::BufReader::new(handle));
+    // Extract it
+    unarchive_reader_async(tio::BufReader::new(handle), tarball, target).await
+}
+
+/// Unarchives a `.tar.gz` file that is read from the given reader to the given location.
+///
+/// Entries are extracted as soon as they are read, so this can be used to extract an archive while it is still being downloaded.
+///
+/// # Arguments
+/// - `reader`: The reader that produces the raw (compressed) tarball.
+/// - `tarball`: A path that describes where `reader` reads from. Only used for debugging.
+/// - `target`: The target directory to write to. Note that we will throw all sorts of nasty errors if it already exists somehow.
+///
+/// # Errors
+/// This function errors if we failed to read or write anything or if some directories do or do not exist.
+pub async fn unarchive_reader_async(
+    reader: impl tio::AsyncBufRead + Unpin,
+    tarball: impl AsRef<Path>,
+    target: impl AsRef<Path>,
+) -> Result<(), Error> {
+    let tarball: &Path = tarball.as_ref();
+    let target: &Path = target.as_ref();
+
+    // Whine if the target already exists
+    if target.exists() {
+        return Err(Error::PathExistsError { what: "target", path: target.into() });
+    }
+    if let Err(err) = tfs::create_dir(target).await {
+        return Err(Error::DirCreateError { what: "target", path: target.into(), err });
+    }
+
+    // Create the decoder & tarfile around this reader
+    let dec: GzipDecoder<_> = GzipDecoder::new(reader);
     let mut tar: Archive<GzipDecoder<_>> = Archive::new(dec);
     let mut entries: Entries<GzipDecoder<_>> = match tar.entries() {
         Ok(entries) => entries,
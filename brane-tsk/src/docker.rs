@@ -4,7 +4,7 @@
 //  Created:
 //    19 Sep 2022, 14:57:17
 //  Last edited:
-//    08 Feb 2024, 15:15:18
+//    14 Oct 2026, 21:05:34
 //  Auto updated?
 //    Yes
 //
@@ -29,7 +29,7 @@ use enum_debug::EnumDebug;
 use futures_util::stream::TryStreamExt as _;
 use futures_util::StreamExt as _;
 use hyper::body::Body;
-use log::debug;
+use log::{debug, warn};
 use serde::de::{Deserializer, Visitor};
 use serde::ser::Serializer;
 use serde::{Deserialize, Serialize};
@@ -68,6 +68,40 @@ struct DockerImageManifest {
     config: String,
 }
 
+/// Removes a container when it is dropped before it is disarmed.
+///
+/// This makes sure that a container does not keep running when the future waiting for it is dropped, e.g., because the workflow it is part of was cancelled.
+struct ContainerGuard {
+    /// The connection to the Docker daemon that runs the container.
+    docker: Docker,
+    /// The name of the container to remove, or [`None`] if the guard has been disarmed.
+    name:   Option<String>,
+}
+impl ContainerGuard {
+    /// Disarms the guard, i.e., leaves the container alone when it is dropped.
+    #[inline]
+    fn disarm(mut self) { self.name = None; }
+}
+impl Drop for ContainerGuard {
+    fn drop(&mut self) {
+        if let Some(name) = self.name.take() {
+            // We can't wait in a destructor, so schedule the removal instead
+            let docker: Docker = self.docker.clone();
+            match tokio::runtime::Handle::try_current() {
+                Ok(handle) => {
+                    debug!("Stopping container '{}' that is no longer waited for...", name);
+                    handle.spawn(async move {
+                        if let Err(err) = remove_container(&docker, &name).await {
+                            warn!("Failed to stop abandoned container '{}': {}", name, err);
+                        }
+                    });
+                },
+                Err(_) => warn!("Cannot stop abandoned container '{}' outside of a tokio runtime", name),
+            }
+        }
+    }
+}
+
 
 
 
@@ -1227,8 +1261,29 @@ pub async fn run_and_wait(opts: impl AsRef<DockerOptions>, exec: ExecuteInfo, ke
     // Start container, return immediately (propagating any errors that occurred)
     let name: String = create_and_start_container(&docker, &exec).await?;
 
-    // And now wait for it
-    join_container(&docker, &name, keep_container).await
+    // And now wait for it (stopping it if we are dropped before it completes)
+    let guard: ContainerGuard = ContainerGuard { docker: docker.clone(), name: Some(name.clone()) };
+    let res: Result<(i32, String, String), Error> = join_container(&docker, &name, keep_container).await;
+    guard.disarm();
+    res
+}
+
+/// Stops the container with the given name, i.e., kills it if it is still running and removes it.
+///
+/// # Arguments
+/// - `opts`: The DockerOptions that contains information on how we can connect to the local daemon.
+/// - `name`: The name of the container to stop.
+///
+/// # Errors
+/// This function errors if we failed to connect to the Docker engine or to remove the container.
+pub async fn stop(opts: impl AsRef<DockerOptions>, name: impl AsRef<str>) -> Result<(), Error> {
+    let name: &str = name.as_ref();
+
+    // Connect to docker
+    let docker: Docker = connect_local(opts)?;
+
+    // Removing it forcefully kills it first
+    remove_container(&docker, name).await
 }
 
 /// Tries to return the (IP-)address of the container with the given name.
@@ -4,7 +4,7 @@
 //  Created:
 //    06 Jan 2023, 14:43:35
 //  Last edited:
-//    08 Feb 2024, 17:01:30
+//    14 Oct 2026, 20:03:13
 //  Auto updated?
 //    Yes
 //
@@ -64,7 +64,10 @@ pub struct CreateSessionRequest {}
 pub struct CreateSessionReply {
     /// The resulting UUID of the session.
     #[prost(tag = "1", required, string)]
-    pub uuid: String,
+    pub uuid:   String,
+    /// Whether the driver also accepts workflows encoded as MessagePack (see [`ExecuteRequest::input_bin`]). Older drivers never set this.
+    #[prost(tag = "2", optional, bool)]
+    pub binary: Option<bool>,
 }
 
 
@@ -102,10 +105,19 @@ pub struct CheckReply {
 pub struct ExecuteRequest {
     /// The session in which to execute the workflow.
     #[prost(tag = "1", required, string)]
-    pub uuid:  String,
-    /// The input to the request, i.e., the workflow.
+    pub uuid:       String,
+    /// The input to the request, i.e., the workflow (encoded as JSON). Left empty if `input_bin` is given.
     #[prost(tag = "2", required, string)]
-    pub input: String,
+    pub input:      String,
+    /// The input to the request, but encoded as MessagePack instead. Only send this if the driver said it supports it upon session creation.
+    #[prost(tag = "3", optional, bytes = "vec")]
+    pub input_bin:  Option<Vec<u8>>,
+    /// If true, asks the driver to send its profile timings along with the result.
+    #[prost(tag = "4", optional, bool)]
+    pub profile:    Option<bool>,
+    /// If true, allows the driver to re-use an earlier plan of the same workflow in this session instead of planning it again. The checkers are asked about the workflow either way.
+    #[prost(tag = "5", optional, bool)]
+    pub cache_plan: Option<bool>,
 }
 
 /// The reply sent by the driver when a workflow has been executed.
@@ -117,16 +129,26 @@ pub struct ExecuteReply {
 
     /// If given, then the driver has some debug information to show to the user.
     #[prost(tag = "2", optional, string)]
-    pub debug:  Option<String>,
+    pub debug:     Option<String>,
     /// If given, then the driver has stdout to write to the user.
     #[prost(tag = "3", optional, string)]
-    pub stdout: Option<String>,
+    pub stdout:    Option<String>,
     /// If given, then the driver has stderr to write to the user.
     #[prost(tag = "4", optional, string)]
-    pub stderr: Option<String>,
+    pub stderr:    Option<String>,
     /// If given, then the workflow has returned a value to use (FullValue encoded as JSON).
     #[prost(tag = "5", optional, string)]
-    pub value:  Option<String>,
+    pub value:     Option<String>,
+    /// If given, then the workflow has returned a value to use (FullValue encoded as MessagePack). Only sent if the workflow was submitted as MessagePack too.
+    #[prost(tag = "6", optional, bytes = "vec")]
+    pub value_bin: Option<Vec<u8>>,
+
+    /// If any, contains profile results of the driver (a ProfileScope encoded as JSON). Only sent along with the result, and only if the request asked for it.
+    #[prost(tag = "7", optional, string)]
+    pub profile:     Option<String>,
+    /// If given, whether the workflow was run with a plan re-used from an earlier run. Only sent along with the result.
+    #[prost(tag = "8", optional, bool)]
+    pub plan_cached: Option<bool>,
 }
 
 
@@ -4,7 +4,7 @@
 //  Created:
 //    01 Feb 2023, 09:54:51
 //  Last edited:
-//    06 Feb 2024, 12:53:50
+//    14 Oct 2026, 13:20:34
 //  Auto updated?
 //    Yes
 //
@@ -255,6 +255,19 @@ impl From<&mut Duration> for Timing {
 
 
 
+/// Defines a single entry in a flattened ProfileScope (see [`ProfileScope::flatten()`]).
+#[derive(Clone, Debug)]
+pub struct ProfileEntry {
+    /// The number of scopes this entry is nested in (not counting the flattened scope itself).
+    pub depth:  usize,
+    /// The name of the timing or scope.
+    pub name:   String,
+    /// The time taken, or [`None`] if this entry is a nested scope (whose time is typically found in its `total`-timing).
+    pub timing: Option<Timing>,
+}
+
+
+
 /// Defines the TimerGuard, which takes a Timing as long as it is in scope.
 #[derive(Debug)]
 pub struct TimerGuard<'s> {
@@ -620,6 +633,44 @@ impl ProfileScope {
         }
     }
 
+    /// Returns the name of this scope.
+    #[inline]
+    pub fn name(&self) -> &str { &self.name }
+
+    /// Flattens this scope into a list of its timings and nested scopes, in the order in which they were added (depth-first).
+    ///
+    /// # Returns
+    /// A list of [`ProfileEntry`]s, where nested scopes are followed by their own entries.
+    pub fn flatten(&self) -> Vec<ProfileEntry> {
+        let mut entries: Vec<ProfileEntry> = vec![];
+        self.flatten_into(0, &mut entries);
+        entries
+    }
+
+    /// Flattens this scope into the given list of entries.
+    ///
+    /// # Arguments
+    /// - `depth`: The depth of this scope's entries.
+    /// - `entries`: The list to append the entries to.
+    fn flatten_into(&self, depth: usize, entries: &mut Vec<ProfileEntry>) {
+        for t in self.timings.lock().iter() {
+            match t {
+                ProfileTiming::Timing(name, timing) => entries.push(ProfileEntry { depth, name: name.clone(), timing: Some(*timing.lock()) }),
+                ProfileTiming::Scope(scope) => {
+                    entries.push(ProfileEntry { depth, name: scope.name.clone(), timing: None });
+                    scope.flatten_into(depth + 1, entries);
+                },
+            }
+        }
+    }
+
+    /// Returns a formatter that displays this scope as a complete report, with a header.
+    ///
+    /// # Returns
+    /// A new ProfileReportFormatter.
+    #[inline]
+    pub fn display_report(&self) -> ProfileReportFormatter { ProfileReportFormatter { scope: self } }
+
     /// Returns a formatter that neatly displays the results of this scope.
     ///
     /// Note that this does _not_ end with a newline, so typically you want to call `writeln!()`/`println!()` on this.